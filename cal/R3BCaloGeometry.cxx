@@ -11,23 +11,30 @@
 #include "R3BCaloGeometry.h"
 
 R3BCaloGeometry* R3BCaloGeometry::inst = NULL;
+std::map<int, R3BCaloGeometry*> R3BCaloGeometry::fgInstances;
 
 R3BCaloGeometry* R3BCaloGeometry::Instance(int version)
 {
-  if(!inst)
-    inst = new R3BCaloGeometry(version);
-  else if(inst->fGeometryVersion != version)
+  // One instance (and angle table) per geometry version
+  std::map<int, R3BCaloGeometry*>::iterator it = fgInstances.find(version);
+  if(it != fgInstances.end())
+  {
+    inst = it->second;
+    return inst;
+  }
+
+  if(inst)
   {
     LOG(ERROR) << "R3BCaloGeometry::Instance(): Existing instance with different geometry version than requested. "
               << "Undefined beheaviour possible!" << FairLogger::endl;
-
-    inst = new R3BCaloGeometry(version);
   }
 
+  inst = new R3BCaloGeometry(version);
+  fgInstances[version] = inst;
   return inst;
 }
 
-R3BCaloGeometry::R3BCaloGeometry(int version)  : fGeometryVersion(version)
+R3BCaloGeometry::R3BCaloGeometry(int version)  : fGeometryVersion(version), fTableValid(false)
 {
   LOG(DEBUG) << "Creating new R3BCaloGeometry for version " << version << FairLogger::endl;
 
@@ -82,6 +89,89 @@ R3BCaloGeometry::R3BCaloGeometry(int version)  : fGeometryVersion(version)
 void R3BCaloGeometry::GetAngles(Int_t iD, Double_t* polar, 
 				 Double_t* azimuthal, Double_t* rho)
 {
+  if(!fTableValid)
+    BuildAngleTable();
+
+  if(iD < 0 || iD >= (Int_t)fHasAngles.size() || !fHasAngles[iD])
+  {
+    LOG(ERROR) << "R3BCaloGeometry: Invalid crystal ID " << iD << " for geometry version "
+               << fGeometryVersion << FairLogger::endl;
+    return;
+  }
+
+  *polar=fPolar[iD];
+  *azimuthal=fAzimuthal[iD];
+  *rho=fRho[iD];
+}
+
+void R3BCaloGeometry::BuildAngleTable()
+{
+  fHasAngles.clear();
+  fPolar.clear();
+  fAzimuthal.clear();
+  fRho.clear();
+  fTableValid = true;
+
+  if(fGeometryVersion != 16 && fGeometryVersion != 17 && fGeometryVersion != 0x438b)
+  {
+    LOG(ERROR) << "R3BCaloGeometry: Geometry version not available in R3BCaloGeometry::GetAngles(). " << FairLogger::endl;
+    return;
+  }
+  if(!gGeoManager)
+  {
+    LOG(ERROR) << "R3BCaloGeometry: No geometry, cannot compute crystal angles" << FairLogger::endl;
+    return;
+  }
+
+  Int_t nCrystals = 0;
+  Double_t polar, azimuthal, rho;
+
+  // Add one crystal if it is present in the geometry
+  auto addCrystal = [&](Int_t iD) -> bool
+  {
+    const char *path = GetCrystalVolumePath(iD);
+    if(!path || !gGeoManager->CheckPath(path))
+      return false;
+    if(!ComputeAngles(iD, &polar, &azimuthal, &rho))
+      return false;
+
+    if(iD >= (Int_t)fHasAngles.size())
+    {
+      fHasAngles.resize(iD + 1, 0);
+      fPolar.resize(iD + 1, 0.);
+      fAzimuthal.resize(iD + 1, 0.);
+      fRho.resize(iD + 1, 0.);
+    }
+    fHasAngles[iD] = 1;
+    fPolar[iD] = polar;
+    fAzimuthal[iD] = azimuthal;
+    fRho[iD] = rho;
+    nCrystals++;
+    return true;
+  };
+
+  // Barrel: IDs 1 to 1952
+  for(Int_t iD = 1; iD <= 1952; iD++)
+    addCrystal(iD);
+
+  // Endcap: ID = 3000 + 24 * (alveolus copy) + (crystal type - 1),
+  // up to the first alveolus copy without any crystal
+  for(Int_t copy = 0; copy < 1000; copy++)
+  {
+    bool found = false;
+    for(Int_t type = 0; type < 24; type++)
+      found |= addCrystal(3000 + copy*24 + type);
+    if(!found)
+      break;
+  }
+
+  LOG(INFO) << "R3BCaloGeometry: Angles of " << nCrystals << " crystals for geometry version "
+            << fGeometryVersion << FairLogger::endl;
+}
+
+bool R3BCaloGeometry::ComputeAngles(Int_t iD, Double_t* polar, 
+				 Double_t* azimuthal, Double_t* rho)
+{
 
   Double_t local[3]={0,0,0};
   Double_t master[3];
@@ -182,7 +272,7 @@ void R3BCaloGeometry::GetAngles(Int_t iD, Double_t* polar,
       else { 
 	LOG(ERROR) << "R3BCaloHitFinder: Invalid crystal path: " << nameVolume
 		   << FairLogger::endl;
-	return; 
+	return false; 
       }
       gGeoManager->LocalToMaster(local, master);
 
@@ -205,12 +295,12 @@ void R3BCaloGeometry::GetAngles(Int_t iD, Double_t* polar,
   {
     const char *nameVolume = GetCrystalVolumePath(iD);
     if(!nameVolume)
-      return;
+      return false;
 
     if(!gGeoManager->cd(nameVolume))
     {
       LOG(ERROR) << "R3BCaloGeometry: Invalid volume path: " << nameVolume << FairLogger::endl;
-      return;
+      return false;
     }
 
     // TGeoManager::LocalToMaster does the whole magic:
@@ -222,7 +312,7 @@ void R3BCaloGeometry::GetAngles(Int_t iD, Double_t* polar,
  else
  {
    LOG(ERROR) << "R3BCaloGeometry: Geometry version not available in R3BCaloGeometry::GetAngles(). " << FairLogger::endl;
-   return;
+   return false;
  }
   
   
@@ -231,6 +321,7 @@ void R3BCaloGeometry::GetAngles(Int_t iD, Double_t* polar,
   *polar=masterV.Theta();
   *azimuthal=masterV.Phi();
   *rho=masterV.Mag();
+  return true;
 }
 
 const char * R3BCaloGeometry::GetCrystalVolumePath(int iD)
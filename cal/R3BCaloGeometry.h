@@ -3,26 +3,48 @@
 
 #include <TObject.h>
 
+#include <map>
+#include <vector>
+
 class TVector3;
 
 class R3BCaloGeometry : public TObject
 {
 protected:
     static R3BCaloGeometry *inst;
+    static std::map<int, R3BCaloGeometry*> fgInstances;
     R3BCaloGeometry(int version);
 
     int fGeometryVersion;
 
+    // Crystal angles by crystal id, filled from the geometry on first use
+    bool fTableValid;                  //!
+    std::vector<unsigned char> fHasAngles; //! 1 if the crystal exists
+    std::vector<Double_t> fPolar;      //!
+    std::vector<Double_t> fAzimuthal;  //!
+    std::vector<Double_t> fRho;        //!
+
+    /** Navigate to the crystal and compute its angles, false if not found **/
+    bool ComputeAngles(Int_t iD, Double_t *polar, Double_t *azimuthal, Double_t* rho);
+
+    /** Fill the angle table for all crystals of the geometry version **/
+    void BuildAngleTable();
+
 public:
+  /** Polar and azimuthal angle and distance of the crystal center.
+   ** Looked up in a table built once from the geometry. **/
   void GetAngles(Int_t iD, Double_t *polar, Double_t *azimuthal, Double_t* rho);
 
+  /** Rebuild the angle table on next use, e.g. after moving volumes **/
+  void ResetAngleTable() { fTableValid = false; }
+
   const char *GetCrystalVolumePath(int iD);
 
   double GetDistanceThroughCrystals(TVector3 &startVertex, TVector3 &direction);
 
   static R3BCaloGeometry *Instance(int version);
 
-  ClassDef(R3BCaloGeometry, 3);
+  ClassDef(R3BCaloGeometry, 4);
 };
 
 #endif
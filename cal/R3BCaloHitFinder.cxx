@@ -25,6 +25,8 @@
 #include "R3BCaloCrystalHit.h"
 #include "R3BCaloCrystalHitSim.h"
 
+#include <algorithm>
+
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -45,6 +47,7 @@ R3BCaloHitFinder::R3BCaloHitFinder() : FairTask("R3B CALIFA Hit Finder ")
   fCrystalHitCA=0;
   fCaloHitCA=0;
   nEvents=0;
+  fRhoMin=0.;
 }
 
 
@@ -142,18 +145,9 @@ void R3BCaloHitFinder::Exec(Option_t* opt)
   Double_t Ns=0.;           // caloHits Ns
   Double_t polarAngle=0.;     // caloHits reconstructed polar angle
   Double_t azimuthalAngle=0.;   // caloHits reconstructed azimuthal angle
-  Double_t rhoAngle=0.;   // caloHits reconstructed rho
-  Double_t angle1,angle2;
   Double_t eInc=0.;       // total incident energy (only for simulation)
 
-  bool* usedCrystalHits=NULL; //array to control the CrystalHits
   Int_t crystalsInHit=0;  //used crystals in each CaloHit
-  Double_t testPolar=0 ;
-  Double_t testAzimuthal=0 ;
-  Double_t testRho =0 ;
-  bool takeCrystalInCluster;
-
-  R3BCaloCrystalHit**    crystalHit = NULL;
 
   Int_t crystalHits;        // Nb of CrystalHits in current event
   crystalHits = fCrystalHitCA->GetEntries();
@@ -161,164 +155,210 @@ void R3BCaloHitFinder::Exec(Option_t* opt)
   if (crystalHits == 0)
      return;
 
-  crystalHit = new R3BCaloCrystalHit*[crystalHits];
-  usedCrystalHits = new bool[crystalHits];
+  // Per event buffers, their capacity is kept between events
+  fHits.resize(crystalHits);
+  fUsed.assign(crystalHits, 1);
+  fEnergy.resize(crystalHits);
+  fPolar.resize(crystalHits);
+  fAzimuthal.resize(crystalHits);
+  fRho.resize(crystalHits);
+  fDirection.resize(crystalHits);
+  fByEnergy.clear();
+  fByPolar.clear();
+  fRhoMin = -1.;
+
   for (Int_t i=0; i<crystalHits; i++) {
-    crystalHit[i] = (R3BCaloCrystalHit*) fCrystalHitCA->At(i);
+    fHits[i] = (R3BCaloCrystalHit*) fCrystalHitCA->At(i);
     if(kSimulation)
     {
        // Apply resolution smearing for simulation
-       crystalHit[i]->SetEnergy(ExpResSmearing(crystalHit[i]->GetEnergy()));
-       crystalHit[i]->SetNf(CompSmearing(crystalHit[i]->GetNf()));
-       crystalHit[i]->SetNs(CompSmearing(crystalHit[i]->GetNs()));
+       fHits[i]->SetEnergy(ExpResSmearing(fHits[i]->GetEnergy()));
+       fHits[i]->SetNf(CompSmearing(fHits[i]->GetNf()));
+       fHits[i]->SetNs(CompSmearing(fHits[i]->GetNs()));
     }
-    usedCrystalHits[i] = 0;
-  }
 
-  //For the moment a simple analysis... more to come
-  Int_t crystalWithHigherEnergy = 0;
-  Int_t unusedCrystals = crystalHits;
+    //removing those crystals with energy below the threshold
+    fEnergy[i] = fHits[i]->GetEnergy();
+    if (fEnergy[i]<fThreshold)
+      continue;
+    fUsed[i] = 0;
+
+    // Angles are needed once per crystal hit, not once per pair
+    fPolar[i] = fAzimuthal[i] = fRho[i] = 0.;
+    GetAngles(fHits[i]->GetCrystalId(), &fPolar[i], &fAzimuthal[i], &fRho[i]);
+    fDirection[i].SetXYZ(1,0,0);
+    fDirection[i].SetTheta(fPolar[i]);
+    fDirection[i].SetPhi(fAzimuthal[i]);
+
+    fByEnergy.push_back(i);
+    fByPolar.push_back(i);
+    if (fRhoMin < 0. || fRho[i] < fRhoMin) fRhoMin = fRho[i];
+  }
 
-  //removing those crystals with energy below the threshold
-    for (Int_t i=0; i<crystalHits; i++) {
-      if (crystalHit[i]->GetEnergy()<fThreshold) {
-        usedCrystalHits[i] = 1;
-        unusedCrystals--;
+  // Seeds are taken by decreasing energy. Equal energies keep the input
+  // order, as with the former linear search for the maximum.
+  std::stable_sort(fByEnergy.begin(), fByEnergy.end(),
+                   [this](Int_t a, Int_t b) { return fEnergy[a] > fEnergy[b]; });
+
+  // Index of the hits by polar angle, a cluster can only contain hits
+  // from a band around the polar angle of its seed
+  std::sort(fByPolar.begin(), fByPolar.end(),
+            [this](Int_t a, Int_t b) { return fPolar[a] < fPolar[b]; });
+  fSortedPolar.resize(fByPolar.size());
+  for (size_t j=0; j<fByPolar.size(); j++)
+    fSortedPolar[j] = fPolar[fByPolar[j]];
+
+  for (size_t k=0; k<fByEnergy.size(); k++) {
+    Int_t seed = fByEnergy[k];
+    if (fUsed[seed])
+      continue;
+
+    fUsed[seed] = 1;
+    crystalsInHit = 1;
+
+    // Energy and angles come from the crystal with the higher energy
+    hitTime = fHits[seed]->GetTime();
+    energy = fHits[seed]->GetEnergy();
+    Nf = fHits[seed]->GetNf();
+    Ns = fHits[seed]->GetNs();
+    polarAngle = fPolar[seed];
+    azimuthalAngle = fAzimuthal[seed];
+
+    // Finding closest hits and adding their energy. Candidates are
+    // summed in input order, so the sums do not depend on the index.
+    Double_t window = GetPolarWindow(seed);
+    if (window >= 0.) {
+      std::vector<Double_t>::iterator lo =
+        std::lower_bound(fSortedPolar.begin(), fSortedPolar.end(), polarAngle - window);
+      std::vector<Double_t>::iterator hi =
+        std::upper_bound(lo, fSortedPolar.end(), polarAngle + window);
+
+      fCandidates.clear();
+      for (std::vector<Double_t>::iterator it = lo; it != hi; ++it) {
+        Int_t i = fByPolar[it - fSortedPolar.begin()];
+        if (!fUsed[i])
+          fCandidates.push_back(i);
       }
-    }
+      std::sort(fCandidates.begin(), fCandidates.end());
 
-//  int n_clusters = 0;
+      for (size_t c=0; c<fCandidates.size(); c++) {
+        Int_t i = fCandidates[c];
+        if (!InCluster(seed, i))
+          continue;
 
-  while (unusedCrystals>0) {
-    // First, finding the crystal with higher energy from the unused crystalHits
-      for (Int_t i=1; i<crystalHits; i++) {
-        if (!usedCrystalHits[i] && crystalHit[i]->GetEnergy() > 
-	    crystalHit[crystalWithHigherEnergy]->GetEnergy())
-          crystalWithHigherEnergy = i;
-      }
+        energy += fHits[i]->GetEnergy();
+        Nf += fHits[i]->GetNf();
+        Ns += fHits[i]->GetNs();
+        fUsed[i] = 1; crystalsInHit++;
 
-    usedCrystalHits[crystalWithHigherEnergy] = 1; 
-    unusedCrystals--; crystalsInHit++;
-
-    // Second, energy and angles come from the crystal with the higher energy
-      hitTime = crystalHit[crystalWithHigherEnergy]->GetTime();
-      energy = crystalHit[crystalWithHigherEnergy]->GetEnergy();
-      Nf = crystalHit[crystalWithHigherEnergy]->GetNf();
-      Ns = crystalHit[crystalWithHigherEnergy]->GetNs();
-      GetAngles(crystalHit[crystalWithHigherEnergy]->GetCrystalId(),
-		&polarAngle,&azimuthalAngle,&rhoAngle);
-
-    // Third, finding closest hits and adding their energy
-    // Clusterization: you want to put a condition on the angle between the highest
-    // energy crystal and the others. This is done by using the TVector3 classes and
-    // not with different DeltaAngle on theta and phi, to get a proper solid angle
-    // and not a "square" one.                    Enrico Fiori
-    TVector3 refAngle(1,0,0);     // EF
-    refAngle.SetTheta(polarAngle);
-    refAngle.SetPhi(azimuthalAngle);
-    for (Int_t i=0; i<crystalHits; i++) {
-      if (!usedCrystalHits[i] ) {
-          GetAngles(crystalHit[i]->GetCrystalId(), &testPolar, 
-		    &testAzimuthal, &testRho);
-
-        //if(kSimulation) eInc += crystalHitSim[i]->GetEinc();
-
-        takeCrystalInCluster = false;
-
-        TVector3 testAngle(1,0,0);       //EF
-        testAngle.SetTheta(testPolar);
-        testAngle.SetPhi(testAzimuthal);
-        // Check if the angle between the two vectors is less than the reference angle.
-        switch (fClusteringAlgorithmSelector) {
-        case 1: {  //square window
-          //Dealing with the particular definition of azimuthal 
-	  //angles (discontinuity in pi and -pi)
-          if (azimuthalAngle + fDeltaAzimuthal > TMath::Pi()) {
-            angle1 = azimuthalAngle-TMath::Pi(); 
-	    angle2 = testAzimuthal-TMath::Pi();
-          } else if (azimuthalAngle - fDeltaAzimuthal < -TMath::Pi()) {
-            angle1 = azimuthalAngle+TMath::Pi(); 
-	    angle2 = testAzimuthal+TMath::Pi();
-          } else {
-            angle1 = azimuthalAngle; angle2 = testAzimuthal;
-          }
-          if (TMath::Abs(polarAngle - testPolar) < fDeltaPolar &&
-              TMath::Abs(angle1 - angle2) < fDeltaAzimuthal ){
-                 takeCrystalInCluster = true;
-          }
-          break;
-        }
-        case 2:  //round window
-          // The angle is scaled to a reference distance (e.g. here is 
-	  // set to 35 cm) to take into account Califa's non-spherical 
-	  // geometry. The reference angle will then have to be defined 
-	  // in relation to this reference distance: for example, 10° at 
-	  // 35 cm corresponds to ~6cm, setting a fDeltaAngleClust=10 
-	  // means that the gamma rays will be allowed to travel 6 cm in 
-	  // the CsI, no matter the position of the crystal they hit.
-          if ( ((refAngle.Angle(testAngle))*((testRho+rhoAngle)/(35.*2.))) < 
-	       fDeltaAngleClust )  {
-                  takeCrystalInCluster = true;
-          }
-          break ;
-        case 3: {  //round window scaled with energy
-          // The same as before but the angular window is scaled 
-	  // according to the energy of the hit in the higher energy 
-	  // crystal. It needs a parameter that should be calibrated.
-            Double_t fDeltaAngleClustScaled = fDeltaAngleClust * 
-	      (crystalHit[crystalWithHigherEnergy]->GetEnergy()*fParCluster1);
-            if ( ((refAngle.Angle(testAngle))*((testRho+rhoAngle)/(35.*2.))) < 
-		 fDeltaAngleClustScaled )  {
-                  takeCrystalInCluster = true;
-            }
-          break;
-        }
-        case 4: // round window scaled with the energy of the _two_ hits 
-	  //(to be tested and implemented!!)
-          // More advanced: the condition on the distance between the 
-	  //two hits is function of the energy of both hits
-          break;
-        }
-
-        if(takeCrystalInCluster)
-        {
-              energy += crystalHit[i]->GetEnergy();
-  	      Nf += crystalHit[i]->GetNf();
-	      Ns += crystalHit[i]->GetNs();
-              usedCrystalHits[i] = 1; unusedCrystals--; crystalsInHit++;
-              
-              if(kSimulation)
-                  eInc += dynamic_cast<R3BCaloCrystalHitSim*>(crystalHit[i])->GetEinc();
-        }
+        if(kSimulation)
+          eInc += dynamic_cast<R3BCaloCrystalHitSim*>(fHits[i])->GetEinc();
       }
     }
-    
-    
+
     if(kSimulation) {
       AddHitSim(crystalsInHit, energy, Nf, Ns, polarAngle, azimuthalAngle, eInc);
     } else {
       AddHit(crystalsInHit, energy, Nf, Ns, polarAngle, azimuthalAngle, hitTime);
-//      n_clusters++;
-    }
-    
-    crystalsInHit = 0; //reset for next CaloHit
-    
-    //Finally, setting crystalWithHigherEnergy to the first unused 
-    //crystalHit (for the next iteration)
-    for (Int_t i=0; i<crystalHits; i++) {
-      if (!usedCrystalHits[i]) {
-        crystalWithHigherEnergy = i;
-        break;
-      }
     }
   }
+}
+
+
+// -----   Private method GetPolarWindow   ---------------------------------
+Double_t R3BCaloHitFinder::GetPolarWindow(Int_t seed) const
+{
+  // Half width of the polar band around the seed which contains all
+  // possible members of its cluster, negative if there are none.
+  // The clustering condition itself is applied in InCluster().
+  const Double_t margin = 1e-6;   // against rounding of the exact test
+  Double_t deltaAngle;
+
+  switch (fClusteringAlgorithmSelector) {
+  case 1:  //square window
+    return fDeltaPolar > 0. ? fDeltaPolar + margin : -1.;
+  case 2:  //round window
+    deltaAngle = fDeltaAngleClust;
+    break;
+  case 3:  //round window scaled with energy
+    deltaAngle = fDeltaAngleClust * (fEnergy[seed]*fParCluster1);
+    break;
+  default: //4: not implemented, no crystals are added
+    return -1.;
+  }
+
+  // angle * (rho + rhoSeed) / 70 < deltaAngle and |polar - polarSeed| <= angle
+  if (deltaAngle <= 0.)
+    return -1.;
+  Double_t rhoSum = fRho[seed] + fRhoMin;
+  if (rhoSum <= 0.)
+    return TMath::Pi();
+  Double_t window = deltaAngle * (35.*2.) / rhoSum;
+  return window < TMath::Pi() ? window * (1. + margin) + margin : TMath::Pi();
+}
 
-//  std::cout << "# " << n_clusters << "\n--------\n";
 
-  if(crystalHit)
-     delete[] crystalHit;
-  if(usedCrystalHits)
-     delete[] usedCrystalHits;
+// -----   Private method InCluster   --------------------------------------
+Bool_t R3BCaloHitFinder::InCluster(Int_t seed, Int_t i) const
+{
+  Double_t polarAngle = fPolar[seed];
+  Double_t azimuthalAngle = fAzimuthal[seed];
+  Double_t rhoAngle = fRho[seed];
+  Double_t testPolar = fPolar[i];
+  Double_t testAzimuthal = fAzimuthal[i];
+  Double_t testRho = fRho[i];
+  Double_t angle1,angle2;
+
+  // Clusterization: you want to put a condition on the angle between the highest
+  // energy crystal and the others. This is done by using the TVector3 classes and
+  // not with different DeltaAngle on theta and phi, to get a proper solid angle
+  // and not a "square" one.                    Enrico Fiori
+  const TVector3& refAngle = fDirection[seed];
+  const TVector3& testAngle = fDirection[i];
+
+  // Check if the angle between the two vectors is less than the reference angle.
+  switch (fClusteringAlgorithmSelector) {
+  case 1: {  //square window
+    //Dealing with the particular definition of azimuthal 
+    //angles (discontinuity in pi and -pi)
+    if (azimuthalAngle + fDeltaAzimuthal > TMath::Pi()) {
+      angle1 = azimuthalAngle-TMath::Pi(); 
+      angle2 = testAzimuthal-TMath::Pi();
+    } else if (azimuthalAngle - fDeltaAzimuthal < -TMath::Pi()) {
+      angle1 = azimuthalAngle+TMath::Pi(); 
+      angle2 = testAzimuthal+TMath::Pi();
+    } else {
+      angle1 = azimuthalAngle; angle2 = testAzimuthal;
+    }
+    return TMath::Abs(polarAngle - testPolar) < fDeltaPolar &&
+           TMath::Abs(angle1 - angle2) < fDeltaAzimuthal;
+  }
+  case 2:  //round window
+    // The angle is scaled to a reference distance (e.g. here is 
+    // set to 35 cm) to take into account Califa's non-spherical 
+    // geometry. The reference angle will then have to be defined 
+    // in relation to this reference distance: for example, 10° at 
+    // 35 cm corresponds to ~6cm, setting a fDeltaAngleClust=10 
+    // means that the gamma rays will be allowed to travel 6 cm in 
+    // the CsI, no matter the position of the crystal they hit.
+    return ((refAngle.Angle(testAngle))*((testRho+rhoAngle)/(35.*2.))) < 
+           fDeltaAngleClust;
+  case 3: {  //round window scaled with energy
+    // The same as before but the angular window is scaled 
+    // according to the energy of the hit in the higher energy 
+    // crystal. It needs a parameter that should be calibrated.
+    Double_t fDeltaAngleClustScaled = fDeltaAngleClust * 
+      (fEnergy[seed]*fParCluster1);
+    return ((refAngle.Angle(testAngle))*((testRho+rhoAngle)/(35.*2.))) < 
+           fDeltaAngleClustScaled;
+  }
+  case 4: // round window scaled with the energy of the _two_ hits 
+    //(to be tested and implemented!!)
+    // More advanced: the condition on the distance between the 
+    //two hits is function of the energy of both hits
+    return kFALSE;
+  }
+  return kFALSE;
 }
 
 
@@ -16,7 +16,12 @@
 #include "R3BCaloHitSim.h"
 #include "R3BCaloHitFinderPar.h"
 
+#include "TVector3.h"
+
+#include <vector>
+
 class TClonesArray;
+class R3BCaloCrystalHit;
 
 class R3BCaloHitFinder : public FairTask
 {
@@ -153,6 +158,35 @@ class R3BCaloHitFinder : public FairTask
 
     UInt_t nEvents;
 
+    // Per event buffers of the clustering, indexed by crystal hit
+    std::vector<R3BCaloCrystalHit*> fHits;  //!
+    std::vector<char>     fUsed;            //! Below threshold or in a cluster
+    std::vector<Double_t> fEnergy;          //!
+    std::vector<Double_t> fPolar;           //!
+    std::vector<Double_t> fAzimuthal;       //!
+    std::vector<Double_t> fRho;             //!
+    std::vector<TVector3> fDirection;       //! Unit vector (polar, azimuthal)
+    std::vector<Int_t>    fByEnergy;        //! Hits above threshold, by decreasing energy
+    std::vector<Int_t>    fByPolar;         //! Hits above threshold, by polar angle
+    std::vector<Double_t> fSortedPolar;     //! Polar angles in fByPolar order
+    std::vector<Int_t>    fCandidates;      //! Hits in the polar band of a seed
+    Double_t fRhoMin;                       //! Smallest rho of the event
+
+    /** Private method GetPolarWindow
+     **
+     ** Half width of the polar angle band around the seed hit which can
+     ** contain members of its cluster for the selected clustering
+     ** algorithm, negative if no hit can be added
+     **/
+    Double_t GetPolarWindow(Int_t seed) const;
+
+    /** Private method InCluster
+     **
+     ** Clustering condition of the selected algorithm
+     ** (see SetClusteringAlgorithm) for hit i and the seed hit
+     **/
+    Bool_t InCluster(Int_t seed, Int_t i) const;
+
     /** Private method ExpResSmearing
     **
     ** Smears the energy according to some Experimental Resolution distribution
@@ -25,8 +25,9 @@
 R3BCaloCal::R3BCaloCal() : FairTask("R3B CALIFA Calibrator"),
 			       fRawHitCA(0),
 			       fCrystalHitCA(new TClonesArray("R3BCaloCrystalHit")), 
-			       fCaloCalPar(0), calHighRange(false), calPID(false),
-                               nEvents(0)
+			       fCaloCalPar(0), ran(0), calHighRange(false), calPID(false),
+                               nEvents(0), fTableValid(kFALSE),
+                               fNUnknownCrystal()
 {
   //counter1=0;
   //counter2=0;
@@ -35,17 +36,23 @@ R3BCaloCal::R3BCaloCal() : FairTask("R3B CALIFA Calibrator"),
 void R3BCaloCal::UseHighRange(bool highRange)
 {
 	this->calHighRange = highRange;
+	fTableValid = kFALSE;
 }
 
 void R3BCaloCal::SetCalibratePID(bool cal)
 {
 	this->calPID = cal;
+	fTableValid = kFALSE;
 }
 
 //Virtual R3BCaloCal: Public method
 R3BCaloCal::~R3BCaloCal()
 {
   LOG(INFO) << "R3BCaloCal: Delete instance" << FairLogger::endl;
+  if(fNUnknownCrystal.GetCount()) {
+    LOG(WARNING) << "R3BCaloCal: " << fNUnknownCrystal.GetCount()
+                 << " raw hits skipped, no calibration for the crystal" << FairLogger::endl;
+  }
   delete fRawHitCA;
   delete fCrystalHitCA;
   delete ran;
@@ -58,6 +65,7 @@ InitStatus R3BCaloCal::Init()
 {
   Register();
   ran = new TRandom(0);
+  fTableValid = kFALSE;
   return kSUCCESS;
 }
 
@@ -108,9 +116,55 @@ void R3BCaloCal::Register()
 InitStatus R3BCaloCal::ReInit()
 {
   SetParContainers();
+  fTableValid = kFALSE;
   return kSUCCESS;
 }
 
+
+//BuildCalTable: Protected method
+void R3BCaloCal::BuildCalTable()
+{
+  // The parameter list is indexed by crystal id
+  Int_t nCrystals = fCaloCalPar ? fCaloCalPar->GetListOfDUCalPar(0)->GetEntriesFast() : 0;
+
+  fHasCal.assign(nCrystals, 0);
+  fGammaOffs.assign(nCrystals, 0.);
+  fGammaGain.assign(nCrystals, 0.);
+  fRangeOffs.assign(nCrystals, 0.);
+  fRangeGain.assign(nCrystals, 0.);
+  fModeOffs.assign(nCrystals, 0.);
+  fModeGain.assign(nCrystals, 1.);
+  fPidScale.assign(nCrystals, 1.);
+  fPidRange.assign(nCrystals, 1.);
+  fTotPar0.assign(nCrystals, 0.);
+  fTotPar1.assign(nCrystals, 1.);
+  fTotPar2.assign(nCrystals, 0.);
+
+  for (Int_t i = 0; i < nCrystals; i++) {
+    R3BCaloDUCalPar* p = fCaloCalPar->GetDUCalParAt(i);
+    if (!p) continue;
+    fHasCal[i] = 1;
+    fGammaOffs[i] = p->GetGammaCal_offset();
+    fGammaGain[i] = p->GetGammaCal_gain();
+    fRangeOffs[i] = p->GetRangeCal_offset();
+    fRangeGain[i] = p->GetRangeCal_gain();
+    if (calHighRange) {
+      fModeOffs[i] = fRangeOffs[i];
+      fModeGain[i] = fRangeGain[i];
+    }
+    if (calPID) {
+      fPidScale[i] = fGammaGain[i] * p->GetPidGain();
+      if (calHighRange) fPidRange[i] = fRangeGain[i];
+    }
+    fTotPar0[i] = p->GetToTCal_par0();
+    fTotPar1[i] = p->GetToTCal_par1();
+    fTotPar2[i] = p->GetToTCal_par2();
+  }
+
+  fTableValid = kTRUE;
+  LOG(DEBUG) << "R3BCaloCal::BuildCalTable() " << nCrystals << " crystals" << FairLogger::endl;
+}
+
 //DoCalib: Public method
 void R3BCaloCal::Exec(Option_t* option)
 {
@@ -122,77 +176,90 @@ void R3BCaloCal::Exec(Option_t* option)
 // Note: Using the same "random" value all the time is useless against quantization effects
 //  Float_t rando = ran->Rndm()-0.5;
   
-  if(fCrystalHitCA)fCrystalHitCA->Delete();
+  // Output objects are kept and constructed again in place
+  if(fCrystalHitCA)fCrystalHitCA->Clear();
+
+  if(!fTableValid) BuildCalTable();
 
-  R3BCaloRawHit*  rawHit;
-  Int_t rawHit_id=0;  
-  Int_t crystal_id=0;  
-  Double32_t energy=0;  
-  Double32_t n_f=0;  
-  Double32_t n_s=0;  
-  ULong64_t time=0;    
-  Double32_t tot_energy=0;    
-  Double32_t tempResult=0;    
-  Double_t tau = 878.625358; //electronics constant, taken a fixed value for the moment! // Not any more.. BP
-   
   Int_t rawHits;        // Nb of RawHits in current event
   rawHits = fRawHitCA->GetEntries();
- 
-  Double32_t gamma_gain, gamma_offs, range_gain, range_offs, pid_gain;
-  R3BCaloDUCalPar *p;
- 
-  if (rawHits>0) {
-    for (Int_t i=0; i<rawHits; i++) {
-      rawHit= (R3BCaloRawHit*) fRawHitCA->At(i);      
-      rawHit_id= rawHit->GetCrystalId();
-      crystal_id = rawHit_id;
-      p = fCaloCalPar->GetDUCalParAt(rawHit_id);
-
-      gamma_offs = p->GetGammaCal_offset();
-      gamma_gain = p->GetGammaCal_gain();
-      energy =  gamma_offs + ((rawHit->GetEnergy() + ran->Rndm()-0.5) * gamma_gain);
-      if(calHighRange)
-      {
-	range_gain = p->GetRangeCal_gain();
-	range_offs = p->GetRangeCal_offset();
-	energy = range_offs + (energy * range_gain);
-      }
-      n_f = (rawHit->GetNf() + ran->Rndm()-0.5); 
-      n_s = (rawHit->GetNs() + ran->Rndm()-0.5); 
-      if(calPID)
-      {
-         n_f *= gamma_gain * p->GetPidGain();
-         n_s *= gamma_gain * p->GetPidGain();
-
-         if(calHighRange)
-         {
-            n_f *= range_gain;
-            n_s *= range_gain;
-         }
-      }
-      time = rawHit->GetTime();
-      
-      //tot converted from tot-channels to 300MeV range channels
-      
-//      tempResult = fCaloCalPar->GetDUCalParAt(rawHit_id)->GetToTCal_offset() + 	( TMath::Exp((rawHit->GetTot()+rando)/tau) * fCaloCalPar->GetDUCalParAt(rawHit_id)->GetToTCal_gain()); 
-
-	  tempResult = p->GetToTCal_par0()*(TMath::Exp((rawHit->GetTot()+ran->Rndm()-0.5)/p->GetToTCal_par1()))+p->GetToTCal_par2();
-	  // E=par0*exp(TOT/par1)+par2, par1 is not constant..
-	
-      //tot converted from 300MeV range channels to 30MeV range channels
-      tempResult = p->GetRangeCal_offset() + 
-	( tempResult* p->GetRangeCal_gain()); 
-	
-      //tot converted from 30MeV range channels to energy (keV)
-         if(rawHit->GetTot()>0)
-      		{   
-      tot_energy = p->GetGammaCal_offset() + 
-      	(tempResult * p->GetGammaCal_gain());
-      		}
-	  else tot_energy = 0;
-      new ((*fCrystalHitCA)[i]) R3BCaloCrystalHit(crystal_id, energy, n_f, n_s, time, tot_energy);
-      
-    }  
+  if (rawHits<=0) return;
+
+  if ((Int_t)fHitCrystal.size() < rawHits) {
+    fHitCrystal.resize(rawHits);
+    fHitTime.resize(rawHits);
+    fHitEnergy.resize(rawHits);
+    fHitNf.resize(rawHits);
+    fHitNs.resize(rawHits);
+    fHitTot.resize(rawHits);
+    fHitTotRaw.resize(rawHits);
+  }
+
+  // Copy the raw values. The dither is drawn per hit in the same order
+  // as always (energy, Nf, Ns, TOT).
+  R3BCaloRawHit*  rawHit;
+  Int_t nTable = fHasCal.size();
+  Int_t nHits = 0;
+  for (Int_t i=0; i<rawHits; i++) {
+    rawHit= (R3BCaloRawHit*) fRawHitCA->At(i);      
+    Int_t crystal_id = rawHit->GetCrystalId();
+    if (crystal_id < 0 || crystal_id >= nTable || !fHasCal[crystal_id]) {
+      R3B_LOG_SAMPLED(WARNING, fNUnknownCrystal) << "R3BCaloCal::Exec : no calibration for crystal "
+                                                 << crystal_id << FairLogger::endl;
+      continue;
+    }
+    fHitCrystal[nHits] = crystal_id;
+    fHitTime[nHits]    = rawHit->GetTime();
+    fHitEnergy[nHits]  = rawHit->GetEnergy() + ran->Rndm()-0.5;
+    fHitNf[nHits]      = rawHit->GetNf() + ran->Rndm()-0.5;
+    fHitNs[nHits]      = rawHit->GetNs() + ran->Rndm()-0.5;
+    fHitTot[nHits]     = rawHit->GetTot() + ran->Rndm()-0.5;
+    fHitTotRaw[nHits]  = rawHit->GetTot();
+    nHits++;
+  }
+
+  // Calibrate in place. No branches on the modes: the mode constants of
+  // the table are neutral when a mode is off.
+  const Int_t*    crystal = fHitCrystal.data();
+  Double_t*       energy  = fHitEnergy.data();
+  Double_t*       n_f     = fHitNf.data();
+  Double_t*       n_s     = fHitNs.data();
+  Double_t*       tot     = fHitTot.data();
+  const Double_t* tot_raw = fHitTotRaw.data();
+  const Double_t* gamma_offs = fGammaOffs.data();
+  const Double_t* gamma_gain = fGammaGain.data();
+  const Double_t* range_offs = fRangeOffs.data();
+  const Double_t* range_gain = fRangeGain.data();
+  const Double_t* mode_offs  = fModeOffs.data();
+  const Double_t* mode_gain  = fModeGain.data();
+  const Double_t* pid_scale  = fPidScale.data();
+  const Double_t* pid_range  = fPidRange.data();
+  const Double_t* tot_par0   = &fTotPar0[0];
+  const Double_t* tot_par1   = &fTotPar1[0];
+  const Double_t* tot_par2   = &fTotPar2[0];
+
+  for (Int_t i=0; i<nHits; i++) {
+    const Int_t id = crystal[i];
+
+    // gamma calibration, then high range calibration (calHighRange)
+    Double_t e = gamma_offs[id] + energy[i] * gamma_gain[id];
+    energy[i] = mode_offs[id] + e * mode_gain[id];
+
+    // PID with gamma and high range gain (calPID)
+    n_f[i] = n_f[i] * pid_scale[id] * pid_range[id];
+    n_s[i] = n_s[i] * pid_scale[id] * pid_range[id];
+
+    //tot converted from tot-channels to 300MeV range channels
+    // E=par0*exp(TOT/par1)+par2, par1 is not constant..
+    Double_t t = tot_par0[id] * TMath::Exp(tot[i] / tot_par1[id]) + tot_par2[id];
+    //tot converted from 300MeV range channels to 30MeV range channels
+    t = range_offs[id] + t * range_gain[id];
+    //tot converted from 30MeV range channels to energy (keV)
+    tot[i] = tot_raw[i] > 0. ? gamma_offs[id] + t * gamma_gain[id] : 0.;
+  }
+
+  for (Int_t i=0; i<nHits; i++) {
+    new ((*fCrystalHitCA)[i]) R3BCaloCrystalHit(crystal[i], energy[i], n_f[i], n_s[i], fHitTime[i], tot[i]);
   }
   
   return;
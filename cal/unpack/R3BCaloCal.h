@@ -12,8 +12,11 @@
 #include "R3BCaloCalPar.h"
 #include "R3BCaloCrystalHit.h"
 #include "R3BCaloRawHit.h"
+#include "R3BTrace.h"
 #include <TRandom.h>
 
+#include <vector>
+
 class TClonesArray;
 
 class R3BCaloCal : public FairTask {
@@ -49,6 +52,9 @@ protected:
   virtual void Finish();
 
   virtual void Register();
+
+  /** Flatten the parameter container into the calibration table **/
+  void BuildCalTable();
  
  private:
     
@@ -68,6 +74,34 @@ protected:
 
   UInt_t nEvents;
 
+  // Calibration table indexed by crystal id, one array per constant.
+  // The modes are folded into fModeOffs, fModeGain, fPidScale and
+  // fPidRange, which are neutral (0 or 1) when a mode is off.
+  Bool_t fTableValid;               //! Table matches parameters and modes
+  std::vector<UChar_t>  fHasCal;    //! 1 if the crystal has parameters
+  std::vector<Double_t> fGammaOffs; //! Linear gamma calibration
+  std::vector<Double_t> fGammaGain; //!
+  std::vector<Double_t> fRangeOffs; //! High range calibration
+  std::vector<Double_t> fRangeGain; //!
+  std::vector<Double_t> fModeOffs;  //! Range offset/gain if calHighRange, else 0/1
+  std::vector<Double_t> fModeGain;  //!
+  std::vector<Double_t> fPidScale;  //! gamma_gain * pid_gain if calPID, else 1
+  std::vector<Double_t> fPidRange;  //! range_gain if calPID and calHighRange, else 1
+  std::vector<Double_t> fTotPar0;   //! E = par0 * exp(TOT / par1) + par2
+  std::vector<Double_t> fTotPar1;   //!
+  std::vector<Double_t> fTotPar2;   //!
+
+  // Per event work arrays, one entry per calibrated hit
+  std::vector<Int_t>     fHitCrystal; //!
+  std::vector<ULong64_t> fHitTime;    //!
+  std::vector<Double_t>  fHitEnergy;  //! Input in channels, output in keV
+  std::vector<Double_t>  fHitNf;      //!
+  std::vector<Double_t>  fHitNs;      //!
+  std::vector<Double_t>  fHitTot;     //! Input in channels (dithered), output in keV
+  std::vector<Double_t>  fHitTotRaw;  //! TOT in channels, 0 if not measured
+
+  R3BLogCounter fNUnknownCrystal;     //! Raw hits without calibration
+
  public:
   //Class definition
   ClassDef(R3BCaloCal, 0)
@@ -35,7 +35,8 @@ R3BCaloUnpack::R3BCaloUnpack(char *strCalDir,
                              Short_t subCrate, Short_t control)
   : FairUnpack(type, subType, procId, subCrate, control),
     fRawData(new TClonesArray("R3BCaloRawHit")),
-    fNHits(0),fCaloUnpackPar(0), nEvents(0)
+    fNHits(0),fCaloUnpackPar(0), nEvents(0),
+    fNWrongHeader(), fNBadMagic()
 {
    LOG(DEBUG2) << "R3BCaloUnpack::ctor()" << FairLogger::endl;
 }
@@ -51,6 +52,10 @@ R3BCaloUnpack::R3BCaloUnpack(char *strCalDir,
 R3BCaloUnpack::~R3BCaloUnpack()
 {
   LOG(DEBUG2) << "R3BCaloUnpack: Delete instance" << FairLogger::endl;
+  if(fNWrongHeader.GetCount() || fNBadMagic.GetCount()) {
+    LOG(WARNING) << "R3BCaloUnpack: " << fNWrongHeader.GetCount() << " wrong header sizes, "
+                 << fNBadMagic.GetCount() << " invalid event magic numbers" << FairLogger::endl;
+  }
   delete fRawData;
 }
 
@@ -113,7 +118,7 @@ void R3BCaloUnpack::Register() {
  */
 Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
 
-  LOG(DEBUG2) << "R3BCaloUnpack::DoUnpack()" << FairLogger::endl;
+  R3B_TRACE(DEBUG2) << "R3BCaloUnpack::DoUnpack()" << FairLogger::endl;
 
   UInt_t *pl_data = (UInt_t*) data;
   UInt_t l_s = 0; // skip over timerabit header
@@ -146,7 +151,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
   // there are two possible formats (old and new), a magic number defines version is being used. 
   // In the new format, each hit can be followed by optional extra data for time-over-threshold or trace
   
-  LOG(DEBUG) << "Unpacking" << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "Unpacking" << FairLogger::endl;
 
   while(l_s < size) {
 
@@ -181,7 +186,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
 
     
     if(header_size != 0x34) {
-      LOG(WARNING) << "Wrong header size ( is " << header_size << ")" << FairLogger::endl;
+      R3B_LOG_SAMPLED(WARNING, fNWrongHeader) << "Wrong header size ( is " << header_size << ")" << FairLogger::endl;
       break;
     }
     
@@ -267,7 +272,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
         
         // checks if optional time-over-threshold payload present (recognized by 0xBEEF as first word) 
         if ( (evsize > 4 * (l_s - start))   && ( ((pl_data[l_s] >> 16) & 0xffff) == 0xBEEF) ) {
-          LOG(DEBUG) << "TOT payload present" << FairLogger::endl;
+          R3B_TRACE(DEBUG) << "TOT payload present" << FairLogger::endl;
           tot = pl_data[l_s++] & 0xffff;
           tot_samples[0] = pl_data[l_s] & 0xffff;
           tot_samples[1] = (pl_data[l_s++] >> 16) & 0xffff;
@@ -286,7 +291,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
         break;
                                     
       default:
-        LOG(WARNING) << "Invalid event magic number:" << magic << "Discarding event..." << FairLogger::endl; 
+        R3B_LOG_SAMPLED(WARNING, fNBadMagic) << "Invalid event magic number:" << magic << "Discarding event..." << FairLogger::endl; 
         l_s = start + (evsize / 4); // skip the traces
         break;
             
@@ -313,7 +318,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
        new ((*fRawData)[fNHits]) R3BCaloRawHit(crystal_id, energy, n_f, n_s, rabbitStamp, error, tot);
        fNHits++;
 
-       LOG(DEBUG2) << "R3BCaloUnpack::DoUnpack(): New Hit: Crystal Id: " << crystal_id << ", fNHits: " << fNHits << FairLogger::endl;
+       R3B_TRACE(DEBUG2) << "R3BCaloUnpack::DoUnpack(): New Hit: Crystal Id: " << crystal_id << ", fNHits: " << fNHits << FairLogger::endl;
      }
   
   } // while
@@ -335,7 +340,7 @@ Bool_t R3BCaloUnpack::DoUnpack(Int_t *data, Int_t size) {
  * 
  */
 void R3BCaloUnpack::Reset() {
-  LOG(DEBUG2) << "Clearing Data Structure" << FairLogger::endl;
+  R3B_TRACE(DEBUG2) << "Clearing Data Structure" << FairLogger::endl;
   fRawData->Clear();
   fNHits = 0;
 }
@@ -13,6 +13,7 @@
 #include "FairUnpack.h"
 
 #include "R3BCaloUnpackPar.h"
+#include "R3BTrace.h"
 
 class TClonesArray;
 
@@ -65,6 +66,9 @@ class R3BCaloUnpack : public FairUnpack {
 
     ULong64_t nEvents;
 
+    R3BLogCounter fNWrongHeader;  //! Subevents with wrong gosip header size
+    R3BLogCounter fNBadMagic;     //! Hits with unknown data format
+
    public:
     //Class definition
     ClassDef(R3BCaloUnpack, 0)
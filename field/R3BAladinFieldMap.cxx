@@ -8,14 +8,16 @@
 
 // Includes from ROOT
 #include "TArrayF.h"
-#include "TArrayI.h"
 #include "TFile.h"
 #include "TMath.h"
 #include <assert.h>
+#include <algorithm>
+#include <mutex>
 
 #include "FairLogger.h"
 
 #include "R3BAladinFieldMap.h"
+#include "R3BFieldGrid.h"
 
 
 // Local Macros
@@ -51,20 +53,128 @@ map_fields_ALADiN R3BAladinFieldMap::gMapIField;
 coords_ALADiN    R3BAladinFieldMap::gCoords[2];
 Bool_t           R3BAladinFieldMap::gInitialized = kFALSE;
 
+// Serialises Init() of several instances (e.g. one per worker thread),
+// which fill the shared static maps
+static std::mutex gInitMutex;
+
+namespace {
+
+  // Measured Ic(A) points, ascending
+  const Int_t kMeasuredI[] = { 500, 1100, 1300, 1500, 1700, 1900, 2100, 2300, 2500 };
+  const Int_t kNMeasuredI  = sizeof(kMeasuredI) / sizeof(kMeasuredI[0]);
+
+  // Has to ben changed somehow using
+  // parameters here
+  // <DB> check me !!
+  const Double_t kDistanceToTarget = 350.0;  //cm
+  const Double_t kCorrection       = -95.0;  // cm
+  const Double_t kMagnetAngle      = -7.0;   // degree
+  const Double_t kMagnetZ          = kDistanceToTarget + kCorrection;
+
+  // Rotation into the magnet frame, evaluated once and not per point
+  const Double_t kSinAngle = TMath::Sin(-1.*kMagnetAngle*TMath::Pi()/180.);
+  const Double_t kCosAngle = TMath::Cos(-1.*kMagnetAngle*TMath::Pi()/180.);
+
+  TString MeasuredMapName(Int_t current)
+  {
+    char filename[256];
+    sprintf (filename,"ala_%04d.dat",current);
+    TString dir = getenv("VMCWORKDIR");
+    return dir + "/field/magField/Aladin/newmap/" + filename;
+  }
+
+  // Cache of the map interpolated for current, next to the measured ones
+  TString InterpMapName(Double_t current)
+  {
+    char filename[256];
+    snprintf (filename,sizeof(filename),"ala_I%.17g.bin",current);
+    TString dir = getenv("VMCWORKDIR");
+    return dir + "/field/magField/Aladin/newmap/" + filename;
+  }
+
+  // Set the grid dimensions, returns the number of values of all six grids
+  Int_t SetGridSizes(fields_ALADiN *field)
+  {
+    Int_t nValues = 0;
+    for (int j = 0; j < 3; j++)
+    {
+      field->f[0][j]._np[0] = 90; //  1 .. 90
+      field->f[0][j]._np[1] = 19; // -2 .. 16
+      field->f[0][j]._np[2] = 21; //  0 .. 20
+      field->f[1][j]._np[0] = 85; //  1 .. 85
+      field->f[1][j]._np[1] = 19; // -2 .. 16
+      field->f[1][j]._np[2] = 17; //  1 .. 17
+      nValues += 90 * 19 * 21 + 85 * 19 * 17;
+    }
+    return nValues;
+  }
+
+  // Binary caches hold the six grids f[rl][j] one after the other.
+  // A valid cache stays mapped as long as the map is in use, i.e. until
+  // the end of the process.
+  Bool_t UseCachedGrid(fields_ALADiN *field, Int_t nValues, const char *binName,
+                       const char *source, const char *source2)
+  {
+    R3BFieldGrid *grid = R3BFieldGrid::MapBinary(binName, source, source2);
+    if (!grid) {
+      return kFALSE;
+    }
+    if (grid->GetSize() != nValues) {
+      LOG(WARNING) << "R3BAladinFieldMap: Ignoring " << binName
+      << ", unexpected size" << FairLogger::endl;
+      R3BFieldGrid::Release(grid);
+      return kFALSE;
+    }
+    const Float_t *data = grid->GetData();
+    for (int rl = 0; rl < 2; rl++)
+      for (int j = 0; j < 3; j++)
+      {
+        field->f[rl][j].use_data(data);
+        data += field->f[rl][j]._n;
+      }
+    return kTRUE;
+  }
+
+  void WriteGrid(const fields_ALADiN *field, Int_t nValues, const char *binName,
+                 const char *source, const char *source2)
+  {
+    R3BFieldGrid *grid = new R3BFieldGrid(nValues, 1);
+    Float_t *out = grid->GetData();
+    for (int rl = 0; rl < 2; rl++)
+      for (int j = 0; j < 3; j++)
+      {
+        memcpy(out, field->f[rl][j]._data, sizeof(Float_t) * field->f[rl][j]._n);
+        out += field->f[rl][j]._n;
+      }
+    grid->WriteBinary(binName, source, source2);
+    R3BFieldGrid::Release(grid);
+  }
+
+}
+
 R3BAladinFieldMap::R3BAladinFieldMap()
 {
     fType = 1;
+    fBx = fBy = fBz = NULL;
+    fCurField = NULL;
+    fInterpMode = R3BFieldInterp::INTERP_LINEAR;
 }
 
 R3BAladinFieldMap::R3BAladinFieldMap(const char* mapName, const char* fileType)
 : FairField(mapName)
 {
     fType = 1;  
+    fBx = fBy = fBz = NULL;
+    fCurField = NULL;
+    fInterpMode = R3BFieldInterp::INTERP_LINEAR;
 }
 
 R3BAladinFieldMap::R3BAladinFieldMap(R3BFieldPar* fieldPar)
 {
     fType = 1;
+    fBx = fBy = fBz = NULL;
+    fCurField = NULL;
+    fInterpMode = R3BFieldInterp::INTERP_LINEAR;
     fCurrent = fieldPar->GetCurrent();
     fScale = fieldPar->GetScale();
 }
@@ -78,10 +188,24 @@ R3BAladinFieldMap::~R3BAladinFieldMap() {
 // -----------   Intialisation   ------------------------------------------
 void R3BAladinFieldMap::Init() {
   
-  if (gInitialized) return;
-  
   gFringeField=kTRUE;
   
+  {
+    std::lock_guard<std::mutex> lock(gInitMutex);
+    if (!gInitialized) {
+      InitCoords();
+      gInitialized = kTRUE;
+    }
+  }
+  
+  // The measured maps are shared and read on demand: only the ones
+  // bracketing the current are needed
+  LOG(INFO) << "R3BAladinFieldMap::Init() called" << FairLogger::endl;
+  InitField();
+  
+}
+
+void R3BAladinFieldMap::InitCoords() {
   
   af_box[0][0].SetXYZ( 123.300, 0.00,  -10.0);
   af_box[0][1].SetXYZ(-123.224, 0.00,  -10.0);
@@ -122,140 +246,124 @@ void R3BAladinFieldMap::Init() {
     LOG(INFO) << str << FairLogger::endl;
   }
   
+  // Transformations inverse
+  gRot = new TRotation();
+  gRot->RotateY(-1.*kMagnetAngle);
+  gTrans   = new TVector3(0.0,
+                          0.0,
+                          -1.* kMagnetZ
+                          );
+  
+}
+
+// Get a measured map, reading it on first use
+fields_ALADiN* R3BAladinFieldMap::GetMeasuredMap(Int_t current)
+{
+  map_fields_ALADiN::iterator iter = gMapIFieldOrig.find(current);
+  if (iter != gMapIFieldOrig.end()) {
+    return iter->second;
+  }
+  fields_ALADiN *field = ReadMeasuredMap(current);
+  gMapIFieldOrig.insert(map_fields_ALADiN::value_type(current,field));
+  return field;
+}
+
+// Read one measured map, from the binary cache if possible
+fields_ALADiN* R3BAladinFieldMap::ReadMeasuredMap(Int_t current)
+{
+  FILE *fin;
+  char str[256];
+  Char_t filename[256];
+  sprintf (filename,"ala_%04d.dat",current);
+  TString fMapFileName = MeasuredMapName(current);
+  
+  fields_ALADiN *field = new fields_ALADiN;
+  Int_t nValues = SetGridSizes(field);
+  
+  // The expanded map is cached in a binary file next to the ASCII one
+  TString binName = fMapFileName;
+  binName.Replace(binName.Length() - 4, 4, ".bin");
+  
+  if (UseCachedGrid(field, nValues, binName, fMapFileName, NULL)) {
+    return field;
+  }
   
-  // Read the field maps
-  // Measured Ic(A) points
-  //int measured_I[] = { 500, 1100, 1300, 1500, 1700, 1900, 2100, 2300, 2500 };
+  LOG(INFO) << "R3BAladinFieldMap opening Field Map file : " << fMapFileName << FairLogger::endl;
   
-  TArrayI measured_I;
-  measured_I.Set(9);
-  measured_I.AddAt(  500,0);
-  measured_I.AddAt( 1100,1);
-  measured_I.AddAt( 1300,2);
-  measured_I.AddAt( 1500,3);
-  measured_I.AddAt( 1700,4);
-  measured_I.AddAt( 1900,5);
-  measured_I.AddAt( 2100,6);
-  measured_I.AddAt( 2300,7);
-  measured_I.AddAt( 2500,8);
+  fin = fopen(fMapFileName,"r");
   
-  for (unsigned int i = 0; i < measured_I.GetSize(); i++)
+  if (!fin) {
+    LOG(ERROR) << "Failure opening field map : " << fMapFileName << FairLogger::endl;
+  }
+  
+  // free(fMapFileName.Data());
+  
+  for (int j = 0; j < 3; j++)
   {
-    FILE *fin;
-    Char_t filename[256];
-    sprintf (filename,"ala_%04d.dat",measured_I[i]);
-    TString mapName(filename);
-    TString dir = getenv("VMCWORKDIR");
-    TString fMapFileName = dir + "/field/magField/Aladin/newmap/" + mapName;
-    LOG(INFO) << "R3BAladinFieldMap opening Field Map file : " << fMapFileName << FairLogger::endl;
-    
-    fin = fopen(fMapFileName,"r");
+    field->f[0][j].init();
+    field->f[1][j].init();
+  }
+  
+  static const int off[2][3] = { { 1,-2,0 },{ 1,-2,1 }};
+  
+  for (int line = 0; !feof(fin); line++)
+  {
+    int I, rl, ixyz[3];
+    float bxyz[3], bdummy;
     
-    if (!fin) {
-      LOG(ERROR) << "Failure opening field map : " << fMapFileName << FairLogger::endl;
-    }
+    int n = fscanf(fin," %d %d %d %d %d %f %f %f %f\n",&I,&rl,
+                   &ixyz[2],&ixyz[1],&ixyz[0],
+                   &bxyz[0],&bxyz[1],&bxyz[2],
+                   &bdummy);
     
-    // free(fMapFileName.Data());
+    if (n != 9)
+	      LOG(ERROR) << "Failure parsing field from map: " << filename <<  " @ line: % "
+      << line << FairLogger::endl;
     
-    fields_ALADiN *field = new fields_ALADiN;
+    if (I != current)
+	      LOG(ERROR) << "Wrong current " << I << " when parsing field from map " << filename
+      << " @ line: " << line << FairLogger::endl;
     
-    for (int j = 0; j < 3; j++)
-    {
-      field->f[0][j]._np[0] = 90; //  1 .. 90
-      field->f[0][j]._np[1] = 19; // -2 .. 16
-      field->f[0][j]._np[2] = 21; //  0 .. 20
-      field->f[0][j].init();
-      field->f[1][j]._np[0] = 85; //  1 .. 85
-      field->f[1][j]._np[1] = 19; // -2 .. 16
-      field->f[1][j]._np[2] = 17; //  1 .. 17
-      field->f[1][j].init();
-    }
+    if (rl != 0 && rl != 1)
+	      LOG(ERROR) << "Wrong box " << rl << " when parsing field from map "
+      << filename << " @line: " << line << FairLogger::endl;
     
-    static const int off[2][3] = { { 1,-2,0 },{ 1,-2,1 }};
     
-    for (int line = 0; !feof(fin); line++)
-    {
-      int I, rl, ixyz[3];
-      float bxyz[3], bdummy;
-      
-      int n = fscanf(fin," %d %d %d %d %d %f %f %f %f\n",&I,&rl,
-                     &ixyz[2],&ixyz[1],&ixyz[0],
-                     &bxyz[0],&bxyz[1],&bxyz[2],
-                     &bdummy);
-      
-      if (n != 9)
-	      LOG(ERROR) << "Failure parsing field from map: " << filename <<  " @ line: % "
-        << line << FairLogger::endl;
-      
-      if (I != measured_I[i])
-	      LOG(ERROR) << "Wrong current " << I << " when parsing field from map " << filename
-        << " @ line: " << line << FairLogger::endl;
-      
-      if (rl != 0 && rl != 1)
-	      LOG(ERROR) << "Wrong box " << rl << " when parsing field from map "
-        << filename << " @line: " << line << FairLogger::endl;
-      
-      
-      for (int j = 0; j < 3; j++)
+    for (int j = 0; j < 3; j++)
 	    {
 	      ixyz[j] -= off[rl][j];
-        
+      
 	      if (ixyz[j] < 0 ||
-            ixyz[j] >= field->f[rl][0]._np[j]) {
-          sprintf(str, "Wrong coordinate(%d) (%d -> %d) >= %d when parsing field from map %s, line? %d.",
-                 j,ixyz[j]+off[rl][j],ixyz[j],field->f[rl][0]._np[j],
-                 filename,line);
-          LOG(ERROR) << str << FairLogger::endl;
-        }
+          ixyz[j] >= field->f[rl][0]._np[j]) {
+        sprintf(str, "Wrong coordinate(%d) (%d -> %d) >= %d when parsing field from map %s, line? %d.",
+               j,ixyz[j]+off[rl][j],ixyz[j],field->f[rl][0]._np[j],
+               filename,line);
+        LOG(ERROR) << str << FairLogger::endl;
+      }
 	    }
-      
-      for (int j = 0; j < 3; j++)
+    
+    for (int j = 0; j < 3; j++)
 	    {
 	      field->f[rl][j].set_data_pt(ixyz[0],ixyz[1],ixyz[2],bxyz[j]);
 	    }
-    }
-    
-    fclose (fin);
-    
-    
-    for (int j = 0; j < 3; j++) {
-      for (int rl = 0; rl < 2; rl++) {
-        while (field->f[rl][j].expand()) {
-          // expand as long as there are nodes to be expanded
-        }
+  }
+  
+  fclose (fin);
+  
+  
+  for (int j = 0; j < 3; j++) {
+    for (int rl = 0; rl < 2; rl++) {
+      while (field->f[rl][j].expand()) {
+        // expand as long as there are nodes to be expanded
       }
     }
-    
-    gMapIFieldOrig.insert(map_fields_ALADiN::value_type(measured_I[i],field));
-    
-    LOG(INFO) << "R3BAladinFieldMap: Reading field map: " << filename << FairLogger::endl;
   }
   
-  // Has to ben changed somehow using
-  // parameters here
-  // <DB> check me !!
-  Double_t DistanceToTarget = 350.0;  //cm
-  //Double_t Correction = -117.5; // cm
-  //Double_t Correction = -350.5; // cm
-  Double_t Correction = -95.0; // cm
-  //Double_t Glad_angle = +7.3; // degree
-  Double_t Glad_angle = -7.0; // degree
-  Double_t DistanceFromtargetToAladinCenter
-  = DistanceToTarget + Correction;
-  // Transformations inverse
-  gRot = new TRotation();
-  gRot->RotateY(-1.*Glad_angle);
-  gTrans   = new TVector3(0.0,
-                          0.0,
-                          -1.* DistanceFromtargetToAladinCenter
-                          );
+  LOG(INFO) << "R3BAladinFieldMap: Reading field map: " << filename << FairLogger::endl;
   
-  LOG(INFO) << "R3BAladinFieldMap::Init() called" << FairLogger::endl;
-  InitField();
-  
-  //Init has been called
-  gInitialized = kTRUE;
+  WriteGrid(field, nValues, binName, fMapFileName, NULL);
   
+  return field;
 }
 
 void CalcFieldDiv(R3BFieldInterp f[3],double d[3])
@@ -330,7 +438,27 @@ void CalcFieldDiv(R3BFieldInterp f[3],double d[3])
 
 void R3BAladinFieldMap::InitField()
 {
+  // Loads and interpolates shared maps on demand
+  std::lock_guard<std::mutex> lock(gInitMutex);
+  
   fCurField = NULL;
+  SetupField();
+  
+  // Smooth interpolation from precomputed coefficients. They belong to
+  // the (shared) map and are computed only once.
+  if (fCurField && fInterpMode == R3BFieldInterp::INTERP_TRICUBIC)
+  {
+    for (int rl = 0; rl < 2; rl++)
+      for (int j = 0; j < 3; j++)
+        if (!fCurField->f[rl][j]._coeff)
+          fCurField->f[rl][j].prepare_tricubic();
+  }
+}
+
+
+
+void R3BAladinFieldMap::SetupField()
+{
   
   map_fields_ALADiN::iterator iter;
   
@@ -339,11 +467,13 @@ void R3BAladinFieldMap::InitField()
   
   // First look in the original maps
   
-  iter = gMapIFieldOrig.find(current);
+  const Int_t *first = kMeasuredI;
+  const Int_t *last  = kMeasuredI + kNMeasuredI;
+  const Int_t *iter2 = std::lower_bound(first, last, current);
   
-  if (iter != gMapIFieldOrig.end())
+  if (iter2 != last && *iter2 == current)
   {
-    fCurField = iter->second;
+    fCurField = GetMeasuredMap(*iter2);
     return;
   }
   
@@ -357,46 +487,53 @@ void R3BAladinFieldMap::InitField()
     return;
   }
   
-  // If no interpolation found, then we need to create a new one
-  
-  map_fields_ALADiN::iterator iter1;
-  map_fields_ALADiN::iterator iter2;
-  
-  iter2 = gMapIFieldOrig.lower_bound(current);
+  // If no interpolation found, then we need to create a new one from
+  // the two measured maps around the current
   
-  if (iter2 == gMapIFieldOrig.end())
+  if (iter2 == last)
   {
     // Too high current requested...  Extrapolate
     --iter2;
   }
   
-  iter1 = iter2;
-  
-  if (iter2 == gMapIFieldOrig.begin())
+  if (iter2 == first)
   {
     LOG(ERROR) << "R3BAladinFieldMap: Cannot interpolate ALADiN field for current " << current
-    << " A, too low." << FairLogger::endl;
-    
+    << " A, too low. Extrapolating." << FairLogger::endl;
+    ++iter2;
   }
-  --iter1;
+  
+  const Int_t *iter1 = iter2 - 1;
   
   //printf ("# Interpolate ALADiN %7.1f A (%7.1f A, %7.1f A)\n",
-  //        current,iter1->first,iter2->first);
+  //        current,Double_t(*iter1),Double_t(*iter2));
   
   fCurField = new fields_ALADiN;
+  Int_t nValues = SetGridSizes(fCurField);
   
-  if (!fCurField)
-    LOG(DEBUG) << "R3BAladinFieldMap: ALADiN field interpolation, memory allocation failure." << FairLogger::endl;
+  // Interpolated maps are cached on disk as well, keyed by current and
+  // checked against both measured maps
+  TString binName = InterpMapName(current);
+  TString source1 = MeasuredMapName(*iter1);
+  TString source2 = MeasuredMapName(*iter2);
   
-  double w2 = (current - iter1->first) / (iter2->first - iter1->first);
-  double w1 = 1 - w2;
-  
-  for (int rl = 0; rl < 2; rl++)
-    for (int j = 0; j < 3; j++)
-    {
-      fCurField->f[rl][j].interpolate(iter1->second->f[rl][j],w1,
-                                      iter2->second->f[rl][j],w2);
-    }
+  if (!UseCachedGrid(fCurField, nValues, binName, source1, source2))
+  {
+    fields_ALADiN *field1 = GetMeasuredMap(*iter1);
+    fields_ALADiN *field2 = GetMeasuredMap(*iter2);
+    
+    double w2 = (current - Double_t(*iter1)) / (Double_t(*iter2) - Double_t(*iter1));
+    double w1 = 1 - w2;
+    
+    for (int rl = 0; rl < 2; rl++)
+      for (int j = 0; j < 3; j++)
+      {
+        fCurField->f[rl][j].interpolate(field1->f[rl][j],w1,
+                                        field2->f[rl][j],w2);
+      }
+    
+    WriteGrid(fCurField, nValues, binName, source1, source2);
+  }
   
   gMapIField.insert(map_fields_ALADiN::value_type(current,fCurField));
   
@@ -409,50 +546,35 @@ void R3BAladinFieldMap::InitField()
 
 
 void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
+  EvaluateField(point, bField);
+}
+
+
+void R3BAladinFieldMap::EvaluateField(const Double_t point[3], Double_t* bField) const {
   
   
   //<D.B> this is a modified version to work
   // in GEANT simulation environment
   
-  TVector3 B(0.0,0.0,0.0);
-  TVector3 p(point[0],point[1],point[2]);
-  
   // first we need to decompose the position into the magnet coordinates.
   //printf ("Vectorized  p: %10.5f %10.5f %10.5f : ",p.X(),p.Y(),p.Z());
   
   
-  Double_t DistanceToTarget = 350.0;  //cm
-  //  Double_t Correction = -114.5; // cm
-  Double_t Correction = -95.0; // cm
-  //  Double_t Magnet_angle = +7.3; // degree
-  Double_t Magnet_angle = -7.0; // degree
-  
-  
   Double_t xx = 0.;
   Double_t yy = 0.;
   Double_t zz = 0.;
   
-  
-  
-  
-  
-  Double_t angle = -1.*Magnet_angle*TMath::Pi()/180.;
-  
   // Translation
-  Double_t zt = point[2] - (DistanceToTarget + Correction);
+  Double_t zt = point[2] - kMagnetZ;
   
-  // Rotation
-  xx= zt*TMath::Sin(angle) + point[0]*TMath::Cos(angle);
+  // Rotation (sine and cosine of the magnet angle are constants)
+  xx= zt*kSinAngle + point[0]*kCosAngle;
   yy= point[1];
-  zz= zt*TMath::Cos(angle) - point[0]*TMath::Sin(angle);
-  
-  // Assign to c
-  TVector3 c(xx,yy,zz);
+  zz= zt*kCosAngle - point[0]*kSinAngle;
   
-  //printf ("c: %10.5f %10.5f %10.5f\n",c.X(),c.Y(),c.Z());
-  // c is in the magnet coordinate system.
+  // (xx,yy,zz) is in the magnet coordinate system.
   
-  double z_abs = TMath::Abs(c.Z());
+  double z_abs = TMath::Abs(zz);
   
   if ((gFringeField==kFALSE) && (z_abs > (160.0/1.)) ){
     bField[0]= 0.0;
@@ -479,7 +601,6 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
   // field map.
   
   double Bi[3];
-  double Bp[3];
   double wsum = 0.0;
   
   for (int i = 0; i < 3; i++)
@@ -490,9 +611,9 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
     // coords_ALADiN  gCoords;
     
     // swap axis
-    double magx =  c.Z();
-    double magy =  c.Y();
-    double magz = -c.X();
+    double magx =  zz;
+    double magy =  yy;
+    double magz = -xx;
     
     // move to origin at pt in magnet coord system
     double boxxp = magx - gCoords[rl].fMag_pt[0].X();
@@ -564,7 +685,17 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
       // printf (" -I- Interpolation parameters ---->> 0:%2d/%7.5f",
       //         ic[0],dc[0]);
       
-      Bbi[i] = fCurField->f[rl][i].interp(ic,dc);
+      switch (fInterpMode)
+      {
+        case R3BFieldInterp::INTERP_SMOOTH:
+          Bbi[i] = fCurField->f[rl][i].interp3(ic,dc);
+          break;
+        case R3BFieldInterp::INTERP_TRICUBIC:
+          Bbi[i] = fCurField->f[rl][i].interp_tricubic(ic,dc);
+          break;
+        default:
+          Bbi[i] = fCurField->f[rl][i].interp(ic,dc);
+      }
       
     }
     
@@ -580,10 +711,6 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
      printf ("%8.5f %8.5f %8.5f : ",Bbi[0],Bbi[1],Bbi[2]);
      printf ("%8.5f %8.5f %8.5f\n",Bi[0],Bi[1],Bi[2]);
      */
-    Bp[0] = -gCoords[rl].fCosa * Bbi[2] + gCoords[rl].fSina * Bbi[0];
-    Bp[1] =  Bbi[1];
-    Bp[2] = -gCoords[rl].fSina * Bbi[2] + gCoords[rl].fCosa * Bbi[0];
-    
     continue;
     
   no_field_map:
@@ -607,7 +734,6 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
   
   // And then transformed into world coordinates
   // rotate_field(B,Bi[0],Bi[1],Bi[2]);
-  TVector3 BLab(Bi[0],Bi[1],Bi[2]);
   //   BLab.Transform(*gRot);
   // copy value @ end
   //bField[0] = -1.*BLab.X()*10.; // [kGauss]
@@ -615,9 +741,9 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
   //bField[2] = -1.*BLab.Z()*10.; // [kGauss]
   //swap field like in tracker, according to denis and justyna
   //git/justyna version:
-  bField[2] = -1.*BLab.X()*10.; // [kGauss]
-  bField[1] = -1.*BLab.Y()*10.; // [kGauss]
-  bField[0] = +1.*BLab.Z()*10.; // [kGauss]
+  bField[2] = -1.*Bi[0]*10.; // [kGauss]
+  bField[1] = -1.*Bi[1]*10.; // [kGauss]
+  bField[0] = +1.*Bi[2]*10.; // [kGauss]
   ////old/standard version(?):
   //bField[2] = -1.*BLab.X()*10.; // [kGauss]
   //bField[1] = -1.*BLab.Y()*10.; // [kGauss]
@@ -630,6 +756,14 @@ void R3BAladinFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
 }
 
 
+void R3BAladinFieldMap::GetFieldValues(Int_t nPoints, const Double_t* points,
+                                       Double_t* bFields)
+{
+  for (Int_t i = 0; i < nPoints; i++) {
+    GetFieldValue(points + 3*i, bFields + 3*i);
+  }
+}
+
 
 
 
@@ -672,8 +806,4 @@ void R3BAladinFieldMap::ReadAsciiFile(const char* fileName) {
   
 }
 
-Double_t R3BAladinFieldMap::Interpolate(Double_t dx, Double_t dy, Double_t dz) {
-  return 0.;
-}
-
 ClassImp(R3BAladinFieldMap)
@@ -71,9 +71,13 @@ public:
   virtual ~R3BAladinFieldMap();
 
 
-  /** Initialisation (read map from file) **/
+  /** Initialisation (set up the map for the current) **/
   virtual void Init();
 
+  /** Set up the map for fCurrent. Only the measured maps bracketing
+   ** the current are read (once per process), and interpolated maps
+   ** are cached on disk next to the measured ones (ala_I<current>.bin).
+   **/
   virtual void InitField();
   
   
@@ -84,6 +88,22 @@ public:
   virtual void GetFieldValue(const Double_t point[3], Double_t* bField);
 
 
+  /** Get the field components for a set of points at once
+   ** @param nPoints   Number of points
+   ** @param points    Point coordinates (global) [cm], x,y,z per point
+   ** @param bFields   (return) Field components [kG], Bx,By,Bz per point
+   **/
+  void GetFieldValues(Int_t nPoints, const Double_t* points, Double_t* bFields);
+
+
+  /** Get the field components at a certain point. Does not modify the
+   ** map, so it can be called concurrently once InitField() is done.
+   ** @param point     Point coordinates (global) [cm]
+   ** @param bField    (return) Field components [kG]
+   **/
+  void EvaluateField(const Double_t point[3], Double_t* bField) const;
+
+
   /** Get the field components at a certain point 
    ** @param x,y,z     Point coordinates (global) [cm]
    ** @value Bx,By,Bz  Field components [kG]
@@ -168,6 +188,13 @@ public:
   Double_t GetCurrent() { return fCurrent;}
   void SetFringeField(Bool_t set ) {gFringeField=set;}
 
+  /** Select the interpolation of the map grids, one of
+   ** R3BFieldInterp::INTERP_LINEAR (default), INTERP_SMOOTH or
+   ** INTERP_TRICUBIC (as smooth, with coefficients precomputed in
+   ** InitField). Has to be set before Init. **/
+  void SetInterpolation(Int_t mode) { fInterpMode = mode; }
+  Int_t GetInterpolation() const { return fInterpMode; }
+
 	
  protected:
 
@@ -176,10 +203,27 @@ public:
   void Reset();
 
 
+  /** Find or interpolate the map for fCurrent, sets fCurField **/
+  void SetupField();
+
+
   /** Read the field map from an ASCII file **/
   void ReadAsciiFile(const char* fileName);
 
 
+  /** Set up the shared coordinate systems of the two map boxes **/
+  void InitCoords();
+
+
+  /** Get the measured map for one current, reading it on first use **/
+  static fields_ALADiN* GetMeasuredMap(Int_t current);
+
+
+  /** Read the measured map for one current (from the binary cache
+   ** <map>.bin if valid, else from ASCII, writing the cache) **/
+  static fields_ALADiN* ReadMeasuredMap(Int_t current);
+
+
   /** Read field map from a ROOT file **/	
   //void ReadRootFile(const char* fileName, const char* mapName);
 
@@ -188,12 +232,6 @@ public:
   //void SetField(const R3BAladinFieldMapData* data);
 
 
-  /** Get field values by interpolation of the grid.
-   ** @param dx,dy,dz  Relative distance from grid point [cell units]
-   **/
-  Double_t Interpolate(Double_t dx, Double_t dy, Double_t dz); 
-
-
   /** Map file name **/
   TString fFileName;
 
@@ -222,12 +260,6 @@ public:
   TArrayF* fBz;    //!
 
 
-  /** Variables for temporary storage 
-   ** Used in the very frequently called method GetFieldValue  **/
-  Double_t fHa[2][2][2];            //! Field at corners of a grid cell
-  Double_t fHb[2][2];               //! Interpolated field (2-dim)
-  Double_t fHc[2];                  //! Interpolated field (1-dim)
-
   /** local transformation
   **/
   TRotation* gRot;    //!
@@ -251,6 +283,7 @@ public:
   TVector3 af_box[2][2] ;            //!
   TVector3 af_mag[2][2] ;            //!
   Bool_t gFringeField;               //!
+  Int_t  fInterpMode;                //!
 
 
 
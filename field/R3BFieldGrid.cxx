@@ -0,0 +1,317 @@
+// -------------------------------------------------------------------------
+// -----                      R3BFieldGrid source file                 -----
+// -------------------------------------------------------------------------
+
+#include "R3BFieldGrid.h"
+
+#include <iostream>
+#include <mutex>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+
+namespace {
+
+  // Guards the registry and the reference counts
+  std::mutex gGridMutex;
+
+  // Layout of a binary grid file: this header, followed by the values
+  // (native float, native byte order) at offset kDataOffset.
+  // Increase kVersion whenever the layout or the meaning changes.
+  const char   kMagic[8]   = { 'R','3','B','F','G','R','I','D' };
+  const UInt_t kVersion    = 1;
+  const size_t kDataOffset = 256;
+
+  struct GridHeader {
+    char      magic[8];
+    UInt_t    version;
+    UInt_t    checksum;       // Adler-32 of the values
+    Int_t     size;           // Number of values
+    Int_t     nComp;
+    Int_t     n[3];
+    Int_t     floatSize;      // sizeof(Float_t), guards against other ABIs
+    Double_t  min[3];
+    Double_t  max[3];
+    Double_t  step[3];
+    Long64_t  sourceSize;     // Size and modification time of the
+    Long64_t  sourceMTime;    // source map(s), 0 if not given
+  };
+  static_assert(sizeof(GridHeader) <= kDataOffset, "grid header too large");
+
+  UInt_t Adler32(const void* buf, size_t len)
+  {
+    const UChar_t* p = static_cast<const UChar_t*>(buf);
+    ULong64_t a = 1, b = 0;
+    while (len > 0) {
+      // Defer the modulo as long as no overflow can happen
+      size_t n = len < 5552 ? len : 5552;
+      len -= n;
+      while (n--) {
+        a += *p++;
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+    }
+    return UInt_t((b << 16) | a);
+  }
+
+  // With two sources the sizes are summed and the newer time is kept,
+  // so a change of either one is noticed
+  Bool_t SourceInfo(const char* sourceName, const char* sourceName2,
+                    Long64_t& size, Long64_t& mtime)
+  {
+    size = mtime = 0;
+    const char* names[2] = { sourceName, sourceName2 };
+    for (Int_t i = 0; i < 2; i++) {
+      if (!names[i]) {
+        continue;
+      }
+      struct stat st;
+      if (stat(names[i], &st) != 0) {
+        return kFALSE;
+      }
+      size += st.st_size;
+      if (Long64_t(st.st_mtime) > mtime) {
+        mtime = st.st_mtime;
+      }
+    }
+    return kTRUE;
+  }
+
+}
+
+std::map<std::string, R3BFieldGrid*> R3BFieldGrid::fgGrids;
+
+
+// -------------   Constructors   -----------------------------------------
+R3BFieldGrid::R3BFieldGrid(Int_t nValues, Int_t nComp)
+  : fKey(),
+    fRefCount(0),
+    fData(new Float_t[nValues]()),
+    fSize(nValues),
+    fNComp(nComp),
+    fMapBase(NULL),
+    fMapSize(0)
+{
+  for (Int_t i = 0; i < 3; i++) {
+    fMin[i] = fMax[i] = fStep[i] = 0.;
+    fN[i] = 0;
+  }
+}
+
+
+R3BFieldGrid::R3BFieldGrid()
+  : fKey(),
+    fRefCount(0),
+    fData(NULL),
+    fSize(0),
+    fNComp(0),
+    fMapBase(NULL),
+    fMapSize(0)
+{
+  for (Int_t i = 0; i < 3; i++) {
+    fMin[i] = fMax[i] = fStep[i] = 0.;
+    fN[i] = 0;
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -------------   Destructor   -------------------------------------------
+R3BFieldGrid::~R3BFieldGrid()
+{
+  if (fMapBase) {
+    munmap(fMapBase, fMapSize);
+  } else {
+    delete[] fData;
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -------------   Grid geometry   ----------------------------------------
+void R3BFieldGrid::SetAxis(Int_t axis, Double_t min, Double_t max,
+                           Double_t step, Int_t n)
+{
+  fMin[axis]  = min;
+  fMax[axis]  = max;
+  fStep[axis] = step;
+  fN[axis]    = n;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -------------   Registry   ---------------------------------------------
+R3BFieldGrid* R3BFieldGrid::Acquire(const char* key)
+{
+  std::lock_guard<std::mutex> lock(gGridMutex);
+  std::map<std::string, R3BFieldGrid*>::iterator it = fgGrids.find(key);
+  if (it == fgGrids.end()) {
+    return NULL;
+  }
+  it->second->fRefCount++;
+  return it->second;
+}
+
+
+R3BFieldGrid* R3BFieldGrid::Publish(const char* key, R3BFieldGrid* grid)
+{
+  std::lock_guard<std::mutex> lock(gGridMutex);
+  std::map<std::string, R3BFieldGrid*>::iterator it = fgGrids.find(key);
+  if (it != fgGrids.end()) {
+    // Someone else loaded the same map in the meantime
+    if (it->second != grid) {
+      delete grid;
+    }
+    it->second->fRefCount++;
+    return it->second;
+  }
+  grid->fKey = key;
+  grid->fRefCount = 1;
+  fgGrids[grid->fKey] = grid;
+  return grid;
+}
+
+
+void R3BFieldGrid::Release(R3BFieldGrid* grid)
+{
+  if (!grid) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(gGridMutex);
+  if (--grid->fRefCount > 0) {
+    return;
+  }
+  if (!grid->fKey.empty()) {
+    fgGrids.erase(grid->fKey);
+  }
+  delete grid;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -------------   Binary file I/O   -------------------------------------
+R3BFieldGrid* R3BFieldGrid::MapBinary(const char* fileName,
+                                      const char* sourceName,
+                                      const char* sourceName2)
+{
+  Long64_t srcSize, srcMTime;
+  if (!SourceInfo(sourceName, sourceName2, srcSize, srcMTime)) {
+    srcSize = srcMTime = 0;
+  }
+
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < kDataOffset) {
+    close(fd);
+    return NULL;
+  }
+  size_t fileSize = st.st_size;
+  void* base = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    cerr << "-W- R3BFieldGrid::MapBinary: Cannot map " << fileName << endl;
+    return NULL;
+  }
+
+  const GridHeader* h = static_cast<const GridHeader*>(base);
+  const char* reason = NULL;
+  if (memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) {
+    reason = "not a field grid file";
+  } else if (h->version != kVersion) {
+    reason = "incompatible version";
+  } else if (h->floatSize != Int_t(sizeof(Float_t)) || h->size < 0 ||
+             fileSize != kDataOffset + size_t(h->size) * sizeof(Float_t)) {
+    reason = "wrong size";
+  } else if ((sourceName || sourceName2) && (srcSize != h->sourceSize ||
+                            srcMTime != h->sourceMTime)) {
+    reason = "source map has changed";
+  } else if (Adler32(static_cast<const char*>(base) + kDataOffset,
+                     size_t(h->size) * sizeof(Float_t)) != h->checksum) {
+    reason = "checksum mismatch";
+  }
+  if (reason) {
+    cerr << "-W- R3BFieldGrid::MapBinary: Ignoring " << fileName
+         << ": " << reason << endl;
+    munmap(base, fileSize);
+    return NULL;
+  }
+
+  R3BFieldGrid* grid = new R3BFieldGrid();
+  grid->fMapBase = base;
+  grid->fMapSize = fileSize;
+  grid->fData    = reinterpret_cast<Float_t*>(static_cast<char*>(base) + kDataOffset);
+  grid->fSize    = h->size;
+  grid->fNComp   = h->nComp;
+  for (Int_t i = 0; i < 3; i++) {
+    grid->SetAxis(i, h->min[i], h->max[i], h->step[i], h->n[i]);
+  }
+  cout << "-I- R3BFieldGrid: Mapped binary field grid " << fileName << endl;
+  return grid;
+}
+
+
+Bool_t R3BFieldGrid::WriteBinary(const char* fileName,
+                                 const char* sourceName,
+                                 const char* sourceName2) const
+{
+  GridHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version   = kVersion;
+  h.size      = fSize;
+  h.nComp     = fNComp;
+  h.floatSize = sizeof(Float_t);
+  for (Int_t i = 0; i < 3; i++) {
+    h.n[i]    = fN[i];
+    h.min[i]  = fMin[i];
+    h.max[i]  = fMax[i];
+    h.step[i] = fStep[i];
+  }
+  if (!SourceInfo(sourceName, sourceName2, h.sourceSize, h.sourceMTime)) {
+    return kFALSE;
+  }
+  size_t dataSize = size_t(fSize) * sizeof(Float_t);
+  h.checksum = Adler32(fData, dataSize);
+
+  char tmpName[4096];
+  snprintf(tmpName, sizeof(tmpName), "%s.tmp.%d", fileName, int(getpid()));
+  FILE* out = fopen(tmpName, "wb");
+  if (!out) {
+    cerr << "-W- R3BFieldGrid::WriteBinary: Cannot write " << fileName
+         << ", field map will be read from ASCII again next time" << endl;
+    return kFALSE;
+  }
+  char pad[kDataOffset];
+  memset(pad, 0, sizeof(pad));
+  memcpy(pad, &h, sizeof(h));
+  Bool_t ok = fwrite(pad, 1, kDataOffset, out) == kDataOffset &&
+              fwrite(fData, 1, dataSize, out) == dataSize;
+  ok = (fclose(out) == 0) && ok;
+  if (!ok || rename(tmpName, fileName) != 0) {
+    cerr << "-W- R3BFieldGrid::WriteBinary: Failed to write " << fileName
+         << endl;
+    unlink(tmpName);
+    return kFALSE;
+  }
+  cout << "-I- R3BFieldGrid: Wrote binary field grid " << fileName << endl;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+// -------------------------------------------------------------------------
+// -----                      R3BFieldGrid header file                 -----
+// -------------------------------------------------------------------------
+
+
+/** R3BFieldGrid.h
+ **
+ ** Read-only field values of a 3-D grid, shared between all field map
+ ** instances which use the same map file and scaling. Grids are
+ ** registered under a key and reference counted, so every map object
+ ** (e.g. one per worker thread) points to the same single copy.
+ **
+ ** The values are stored interleaved, nComp values per grid point.
+ ** Once published, a grid must not be modified anymore.
+ **
+ ** Grids can be written to a versioned, checksummed binary file and
+ ** mapped back read-only with mmap. Parsing the ASCII map is then only
+ ** needed once, and all processes on a node share the same pages.
+ **/
+
+
+#ifndef R3BFIELDGRID_H
+#define R3BFIELDGRID_H 1
+
+
+#include "Rtypes.h"
+
+#include <map>
+#include <string>
+
+
+class R3BFieldGrid
+{
+
+ public:
+
+  /** Get a published grid and increase its reference count
+   ** @param key   Registry key (e.g. file name and scale)
+   ** @value Shared grid or NULL if not registered
+   **/
+  static R3BFieldGrid* Acquire(const char* key);
+
+
+  /** Publish a new grid under key. If a grid with the same key has been
+   ** published meanwhile, the new one is deleted and the existing one
+   ** is returned instead. Increases the reference count.
+   **/
+  static R3BFieldGrid* Publish(const char* key, R3BFieldGrid* grid);
+
+
+  /** Decrease the reference count, delete the grid when unused **/
+  static void Release(R3BFieldGrid* grid);
+
+
+  /** Map a binary grid file read-only
+   ** @param fileName    Binary grid file
+   ** @param sourceName  Map file the grid was made from. If given, the
+   **                    grid is rejected when the source has changed.
+   ** @param sourceName2 Second map file, for grids derived from two
+   **                    maps (e.g. interpolated between them)
+   ** @value Unpublished grid or NULL if missing, outdated or corrupt
+   **/
+  static R3BFieldGrid* MapBinary(const char* fileName,
+                                 const char* sourceName = NULL,
+                                 const char* sourceName2 = NULL);
+
+
+  /** Write the grid to a binary file (via a temporary file and rename,
+   ** so concurrent jobs never see a partly written file)
+   ** @param fileName    Binary grid file
+   ** @param sourceName  Map file the grid was made from, see MapBinary
+   ** @param sourceName2 Second map file, see MapBinary
+   ** @value kTRUE on success
+   **/
+  Bool_t WriteBinary(const char* fileName,
+                     const char* sourceName = NULL,
+                     const char* sourceName2 = NULL) const;
+
+
+  /** Create an unpublished grid with nValues zero-initialised entries
+   ** @param nValues   Total number of values (points * components)
+   ** @param nComp     Number of values per grid point
+   **/
+  R3BFieldGrid(Int_t nValues, Int_t nComp);
+
+
+  /** Grid geometry, as used by the owning field map **/
+  void SetAxis(Int_t axis, Double_t min, Double_t max, Double_t step, Int_t n);
+  Double_t GetMin(Int_t axis)  const { return fMin[axis]; }
+  Double_t GetMax(Int_t axis)  const { return fMax[axis]; }
+  Double_t GetStep(Int_t axis) const { return fStep[axis]; }
+  Int_t    GetN(Int_t axis)    const { return fN[axis]; }
+
+
+  /** Accessors to the field values. Mapped grids are read-only. **/
+  const Float_t* GetData() const { return fData; }
+  Float_t*       GetData()       { return fData; }
+  Bool_t IsMapped() const { return fMapBase != NULL; }
+  Int_t GetSize()  const { return fSize; }
+  Int_t GetNComp() const { return fNComp; }
+
+
+ private:
+
+  R3BFieldGrid();
+  ~R3BFieldGrid();
+
+  R3BFieldGrid(const R3BFieldGrid&);
+  R3BFieldGrid& operator=(const R3BFieldGrid&);
+
+  std::string fKey;        // Registry key, empty if not published
+  Int_t       fRefCount;   // Number of field maps using this grid
+
+  Float_t*    fData;       // Field values, fNComp per grid point
+  Int_t       fSize;       // Total number of values
+  Int_t       fNComp;      // Values per grid point
+
+  Double_t    fMin[3];     // Grid limits and steps per axis
+  Double_t    fMax[3];
+  Double_t    fStep[3];
+  Int_t       fN[3];       // Number of grid points per axis
+
+  void*       fMapBase;    // Start of the mapped file, NULL if on heap
+  size_t      fMapSize;    // Size of the mapped file
+
+  static std::map<std::string, R3BFieldGrid*> fgGrids;
+
+};
+
+
+#endif
@@ -36,6 +36,15 @@ void R3BFieldInterp::init()
     _m2 = _np[2];
     _n = _np[0] * _np[1] * _np[2];
 
+  if (_external)
+    {
+      _data = NULL;
+      _external = false;
+    }
+
+  free(_coeff);
+  _coeff = NULL;
+
   float *d = (float *) realloc (_data,sizeof(float) * _n);
 
   if (!d)
@@ -47,6 +56,27 @@ void R3BFieldInterp::init()
     _data[i] = NAN;
 }
 
+void R3BFieldInterp::use_data(const float *data)
+{
+  if (!_external)
+    free(_data);
+
+  for (int i = 0; i < 3; i++){
+    _max_ic[i] = _np[i] - 1;
+  }
+
+  _m1 = _np[1] * _np[2];
+  _m2 = _np[2];
+  _n = _np[0] * _np[1] * _np[2];
+
+  // Only read through the const accessors afterwards
+  _data = const_cast<float *>(data);
+  _external = true;
+
+  free(_coeff);
+  _coeff = NULL;
+}
+
 bool R3BFieldInterp::expand()
 {
   bool expanded = false;
@@ -91,7 +121,7 @@ bool R3BFieldInterp::expand()
   return expanded;
 }
 
-double R3BFieldInterp::interp(int ic[3],double dc[3]/*,int &outside*/)
+double R3BFieldInterp::interp(const int ic[3],const double dc[3]/*,int &outside*/) const
 {
   int ic0[3], ic1[3];
   /*
@@ -192,7 +222,7 @@ struct interp3_cell
   double _f[4][4][4];
 };
 
-double R3BFieldInterp::interp3(int ic[3],double dc[3]/*,int &outside*/)
+double R3BFieldInterp::interp3(const int ic[3],const double dc[3]/*,int &outside*/) const
 {
   // Make field interpolation that also takes neighbouring cells into
   // account, for a smoother field map.  Within each cell, use a
@@ -230,10 +260,10 @@ double R3BFieldInterp::interp3(int ic[3],double dc[3]/*,int &outside*/)
 
   for (int i = 0; i < 3; i++)
     {
-      icj[i][0] = ic[0]-1; 
-      icj[i][1] = ic[0]; 
-      icj[i][2] = ic[0]+1; 
-      icj[i][3] = ic[0]+2; 
+      icj[i][0] = ic[i]-1; 
+      icj[i][1] = ic[i]; 
+      icj[i][2] = ic[i]+1; 
+      icj[i][3] = ic[i]+2; 
       
       if (icj[i][0] < 0) { icj[i][0] = 0; }
       if (icj[i][1] < 0) { icj[i][1] = 0; /*outside |= outside_mark; */}
@@ -278,7 +308,11 @@ double R3BFieldInterp::interp3(int ic[3],double dc[3]/*,int &outside*/)
     
     for (int i0 = 0; i0 < 4; i0++)
       for (int i1 = 0; i1 < 4; i1++)
-	ip2s[i0][i1] = interp3_factors_mul(ip3c._f[i0][i1],p1,p2,p3);
+	{
+	  // _f already holds the factors, only the powers are applied
+	  const double *f = ip3c._f[i0][i1];
+	  ip2s[i0][i1] = f[0] + p1 * f[1] + p2 * f[2] + p3 * f[3];
+	}
   }
 
   double ip1l[4];
@@ -306,6 +340,140 @@ double R3BFieldInterp::interp3(int ic[3],double dc[3]/*,int &outside*/)
 }
 
 
+// Rows: coefficients of the powers 0..3 of the position in the cell,
+// columns: weights of the four values, see interp3_factors
+static const double interp3_matrix[4][4] =
+  { {   0,    1,    0,   0 },
+    { -.5,    0,   .5,   0 },
+    {   1, -2.5,    2, -.5 },
+    { -.5,  1.5, -1.5,  .5 } };
+
+void R3BFieldInterp::prepare_tricubic()
+{
+  for (int i = 0; i < 3; i++)
+    _nc[i] = _np[i] + 3;
+
+  int ncells = _nc[0] * _nc[1] * _nc[2];
+
+  float *c = (float *) realloc (_coeff,sizeof(float) * 64 * ncells);
+
+  if (!c)
+    {
+      cout <<"-E- Field interpolation, memory allocation failure."<< endl;
+      return;
+    }
+
+  _coeff = c;
+
+  // Cell c covers ic = c - 2.  Outside of -2 .. _np[i] all four
+  // neighbours are clamped to the same boundary value, so the cells
+  // at the ends also serve all points further out.
+
+  for (int c0 = 0; c0 < _nc[0]; c0++)
+    for (int c1 = 0; c1 < _nc[1]; c1++)
+      for (int c2 = 0; c2 < _nc[2]; c2++)
+	{
+	  int ic[3] = { c0 - 2, c1 - 2, c2 - 2 };
+	  int icj[3][4];
+
+	  for (int i = 0; i < 3; i++)
+	    for (int j = 0; j < 4; j++)
+	      {
+		int k = ic[i] - 1 + j;
+		if (k < 0) k = 0;
+		if (k > _max_ic[i]) k = _max_ic[i];
+		icj[i][j] = k;
+	      }
+
+	  double v[4][4][4];
+
+	  for (int i0 = 0; i0 < 4; i0++)
+	    for (int i1 = 0; i1 < 4; i1++)
+	      for (int i2 = 0; i2 < 4; i2++)
+		v[i0][i1][i2] = get_data_pt(icj[0][i0],icj[1][i1],icj[2][i2]);
+
+	  // Apply the matrix along each axis in turn (separable)
+
+	  double t2[4][4][4], t1[4][4][4], t0[4][4][4];
+
+	  for (int i0 = 0; i0 < 4; i0++)
+	    for (int i1 = 0; i1 < 4; i1++)
+	      for (int p = 0; p < 4; p++)
+		{
+		  double sum = 0;
+		  for (int j = 0; j < 4; j++)
+		    sum += interp3_matrix[p][j] * v[i0][i1][j];
+		  t2[i0][i1][p] = sum;
+		}
+
+	  for (int i0 = 0; i0 < 4; i0++)
+	    for (int p = 0; p < 4; p++)
+	      for (int p2 = 0; p2 < 4; p2++)
+		{
+		  double sum = 0;
+		  for (int j = 0; j < 4; j++)
+		    sum += interp3_matrix[p][j] * t2[i0][j][p2];
+		  t1[i0][p][p2] = sum;
+		}
+
+	  for (int p = 0; p < 4; p++)
+	    for (int p1 = 0; p1 < 4; p1++)
+	      for (int p2 = 0; p2 < 4; p2++)
+		{
+		  double sum = 0;
+		  for (int j = 0; j < 4; j++)
+		    sum += interp3_matrix[p][j] * t1[j][p1][p2];
+		  t0[p][p1][p2] = sum;
+		}
+
+	  float *a = _coeff + 64 * ((c0 * _nc[1] + c1) * _nc[2] + c2);
+
+	  for (int p0 = 0; p0 < 4; p0++)
+	    for (int p1 = 0; p1 < 4; p1++)
+	      for (int p2 = 0; p2 < 4; p2++)
+		a[16 * p0 + 4 * p1 + p2] = (float) t0[p0][p1][p2];
+	}
+}
+
+double R3BFieldInterp::interp_tricubic(const int ic[3],const double dc[3]) const
+{
+  if (!_coeff)
+    return interp3(ic,dc);
+
+  int cell = 0;
+
+  for (int i = 0; i < 3; i++)
+    {
+      int c = ic[i] + 2;
+      if (c < 0) c = 0;
+      if (c >= _nc[i]) c = _nc[i] - 1;
+      cell = cell * _nc[i] + c;
+    }
+
+  const float *a = _coeff + 64 * cell;
+
+  // Horner scheme in z, y, then x
+
+  double s = 0;
+
+  for (int p0 = 3; p0 >= 0; p0--)
+    {
+      double sy = 0;
+
+      for (int p1 = 3; p1 >= 0; p1--)
+	{
+	  const float *az = a + 16 * p0 + 4 * p1;
+	  double sz = ((az[3] * dc[2] + az[2]) * dc[2] + az[1]) * dc[2] + az[0];
+	  sy = sy * dc[1] + sz;
+	}
+
+      s = s * dc[0] + sy;
+    }
+
+  return s;
+}
+
+
   /*
 
 In[4]:= Wa=CC*(1-x) ^2
@@ -9,6 +9,10 @@
 // interpolation.  When given a point outside the valid map: produce
 // values as at the boundary at that point, i.e.  give a continous
 // value outside.  But not where and in what direction it went wrong.
+//
+// Smoother (piecewise cubic) interpolation is available with interp3,
+// or, much faster, with interp_tricubic once the per-cell polynomial
+// coefficients have been computed by prepare_tricubic().
 
 
 class R3BFieldInterp
@@ -19,6 +23,8 @@ public:
     , _m2(0)
     , _n(0)
     , _data(NULL)
+    , _external(false)
+    , _coeff(NULL)
   {
     for (int i = 0; i < 3; i++)
       _np[i] = 0;
@@ -26,7 +32,9 @@ public:
 
   ~R3BFieldInterp()
   {
-    free(_data);
+    if (!_external)
+      free(_data);
+    free(_coeff);
   }
     
 private:
@@ -39,12 +47,27 @@ public:
 
   void init();
 
+  // Use data owned by someone else (e.g. a mapped binary grid) instead
+  // of allocating.  _np must be set.  The data is never modified.
+  void use_data(const float *data);
+
   bool expand();
 
 public:
-  double interp(int ic[3],double dc[3]/*,int &outside*/);
+  // Interpolation modes, for users that make them selectable
+  enum { INTERP_LINEAR = 0, INTERP_SMOOTH = 1, INTERP_TRICUBIC = 2 };
+
+  double interp(const int ic[3],const double dc[3]/*,int &outside*/) const;
+
+  double interp3(const int ic[3],const double dc[3]/*,int &outside*/) const;
+
+  // Same result as interp3, from the precomputed coefficients.  Falls
+  // back to interp3 if prepare_tricubic() has not been called.
+  double interp_tricubic(const int ic[3],const double dc[3]) const;
 
-  double interp3(int ic[3],double dc[3]/*,int &outside*/);
+  // Compute the 64 polynomial coefficients of every cell for
+  // interp_tricubic.  Has to be redone when the data changes.
+  void prepare_tricubic();
 
 public:  
   int    _np[3];
@@ -52,8 +75,11 @@ public:
   int    _m1, _m2;   // _m1 = _np[1] * _np[2] ; _m2 = _np[2]
   int    _n;         // _n = _np[0] * _np[1] * _np[2]
   float *_data;
+  bool   _external;  // _data is not ours, do not free or realloc
+  float *_coeff;     // 64 per cell, cells -2 .. _np[i] in each direction
+  int    _nc[3];     // _nc[i] = _np[i] + 3, number of coefficient cells
 
-  float get_data_pt(int i0,int i1,int i2)
+  float get_data_pt(int i0,int i1,int i2) const
   {
     return _data[i0 * _m1 + i1 * _m2 + i2];
   }
@@ -198,7 +198,13 @@ else if(typeField == 3) {
 
 void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
  // Main function to get the field values
- // not optimized  for the moment
+ EvaluateField(point, bField);
+}
+
+
+void  R3BFieldMap::EvaluateField(const Double_t point[3], Double_t* bField) const{
+ // Does not modify the map and uses no shared scratch space,
+ // can be called concurrently
  // <D.Bertini@gsi.de>
 
 
@@ -208,7 +214,7 @@ void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
  if ( typeField==0 || typeField==1 || typeField==3 ) {
 
 // local
- TArrayI* linesArray = new TArrayI(8);
+ Int_t linesArray[8];
 
 // local to global
  TVector3 localPoint(point[0],point[1],point[2]);
@@ -242,7 +248,7 @@ void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
 
  if (!returnValue) {
      TVector3 vertexReferenceInGrid;
-     Int_t linpos = linesArray->At(0);
+     Int_t linpos = linesArray[0];
      if(GetPositionForLine(linpos,&vertexReferenceInGrid)){
       cout << "-E-R3BFieldMap Line out of bound " << endl;
      }else{
@@ -251,32 +257,32 @@ void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
 	Double_t v = (localPoint.Z() - vertexReferenceInGrid.Z()) / (gridStep);
 
 
-        Bfield[0] = (1-t)*(1-u)*(1-v)*Bxfield[linesArray->At(0)] +
-	  t*(1-u)*(1-v)*Bxfield[linesArray->At(1)] +
-	  t*u*(1-v)*Bxfield[linesArray->At(2)] +
-	  t*u*v*Bxfield[linesArray->At(3)] +
-	  (1-t)*u*(1-v)*Bxfield[linesArray->At(4)] +
-	  (1-t)*u*v*Bxfield[linesArray->At(5)] +
-	  (1-t)*(1-u)*v*Bxfield[linesArray->At(6)] +
-	  t*(1-u)*v*Bxfield[linesArray->At(7)];
+        Bfield[0] = (1-t)*(1-u)*(1-v)*Bxfield[linesArray[0]] +
+	  t*(1-u)*(1-v)*Bxfield[linesArray[1]] +
+	  t*u*(1-v)*Bxfield[linesArray[2]] +
+	  t*u*v*Bxfield[linesArray[3]] +
+	  (1-t)*u*(1-v)*Bxfield[linesArray[4]] +
+	  (1-t)*u*v*Bxfield[linesArray[5]] +
+	  (1-t)*(1-u)*v*Bxfield[linesArray[6]] +
+	  t*(1-u)*v*Bxfield[linesArray[7]];
 	
-	Bfield[1] = (1-t)*(1-u)*(1-v)*Byfield[linesArray->At(0)] +
-	  t*(1-u)*(1-v)*Byfield[linesArray->At(1)] +
-	  t*u*(1-v)*Byfield[linesArray->At(2)] +
-	  t*u*v*Byfield[linesArray->At(3)] +
-	  (1-t)*u*(1-v)*Byfield[linesArray->At(4)] +
-	  (1-t)*u*v*Byfield[linesArray->At(5)] +
-	  (1-t)*(1-u)*v*Byfield[linesArray->At(6)] +
-	  t*(1-u)*v*Byfield[linesArray->At(7)];
+	Bfield[1] = (1-t)*(1-u)*(1-v)*Byfield[linesArray[0]] +
+	  t*(1-u)*(1-v)*Byfield[linesArray[1]] +
+	  t*u*(1-v)*Byfield[linesArray[2]] +
+	  t*u*v*Byfield[linesArray[3]] +
+	  (1-t)*u*(1-v)*Byfield[linesArray[4]] +
+	  (1-t)*u*v*Byfield[linesArray[5]] +
+	  (1-t)*(1-u)*v*Byfield[linesArray[6]] +
+	  t*(1-u)*v*Byfield[linesArray[7]];
 	
-	Bfield[2] = (1-t)*(1-u)*(1-v)*Bzfield[linesArray->At(0)] +
-	  t*(1-u)*(1-v)*Bzfield[linesArray->At(1)] +
-	  t*u*(1-v)*Bzfield[linesArray->At(2)] +
-	  t*u*v*Bzfield[linesArray->At(3)] +
-	  (1-t)*u*(1-v)*Bzfield[linesArray->At(4)] +
-	  (1-t)*u*v*Bzfield[linesArray->At(5)] +
-	  (1-t)*(1-u)*v*Bzfield[linesArray->At(6)] +
-	  t*(1-u)*v*Bzfield[linesArray->At(7)];
+	Bfield[2] = (1-t)*(1-u)*(1-v)*Bzfield[linesArray[0]] +
+	  t*(1-u)*(1-v)*Bzfield[linesArray[1]] +
+	  t*u*(1-v)*Bzfield[linesArray[2]] +
+	  t*u*v*Bzfield[linesArray[3]] +
+	  (1-t)*u*(1-v)*Bzfield[linesArray[4]] +
+	  (1-t)*u*v*Bzfield[linesArray[5]] +
+	  (1-t)*(1-u)*v*Bzfield[linesArray[6]] +
+	  t*(1-u)*v*Bzfield[linesArray[7]];
 
 
      }
@@ -289,9 +295,9 @@ void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
       cout << "-I- R3BFieldMap Point "
         << " is just in one grid point!" << endl;
 	
-	Bfield[0] = Bxfield[linesArray->At(0)];
-	Bfield[1] = Byfield[linesArray->At(0)];
-	Bfield[2] = Bzfield[linesArray->At(0)];
+	Bfield[0] = Bxfield[linesArray[0]];
+	Bfield[1] = Byfield[linesArray[0]];
+	Bfield[2] = Bzfield[linesArray[0]];
  } //returnValue ==1
 
   else{
@@ -314,14 +320,6 @@ void  R3BFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField){
       Bfield[1] = 0;
       Bfield[2] = 0;
   }
- // Reset heap memory
-
- if (linesArray) {
-     delete linesArray;
-     linesArray=NULL;
- }
-
-
  // linesArray
  // localPoint;
  }
@@ -396,33 +394,29 @@ void R3BFieldMap::Init() {
 }
 
 
-Int_t R3BFieldMap::GetLinesArrayForPosition(TVector3* pos, TArrayI* lines){
+Int_t R3BFieldMap::GetLinesArrayForPosition(const TVector3* pos, Int_t lines[8]) const{
 //
-  TVector3* posAux = new TVector3();
-  Int_t tmp  = GetLineForPosition(pos);
-  lines->AddAt(tmp,0);
-  Int_t tmpPos = lines->At(0);
-  GetPositionForLine(tmpPos,posAux);
-  if( (*posAux) == (*pos) ) {
-    delete posAux;
+  TVector3 posAux;
+  lines[0] = GetLineForPosition(pos);
+  GetPositionForLine(lines[0],&posAux);
+  if( posAux == (*pos) ) {
     return 1;
   }  
 
   //Faster method
-  lines->AddAt(lines->At(0) + stepsInY * stepsInZ,1);
-  lines->AddAt(lines->At(1) + stepsInZ,2);
-  lines->AddAt(lines->At(2) + 1,3);
-  lines->AddAt(lines->At(0) + stepsInZ,4);
-  lines->AddAt(lines->At(4) + 1,5);
-  lines->AddAt(lines->At(0) + 1,6);
-  lines->AddAt(lines->At(1) + 1,7);
-
-  if (posAux) delete posAux;
+  lines[1] = lines[0] + stepsInY * stepsInZ;
+  lines[2] = lines[1] + stepsInZ;
+  lines[3] = lines[2] + 1;
+  lines[4] = lines[0] + stepsInZ;
+  lines[5] = lines[4] + 1;
+  lines[6] = lines[0] + 1;
+  lines[7] = lines[1] + 1;
+
   return 0;
 
 }
 
-Int_t R3BFieldMap::GetLineForPosition(TVector3*  pos) const{
+Int_t R3BFieldMap::GetLineForPosition(const TVector3*  pos) const{
   //
   // Returns the line of the grid point with coordinates
   // equal or (closer and) below the coordinates of "pos" 
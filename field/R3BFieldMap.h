@@ -57,6 +57,8 @@ public:
   virtual void Print(Option_t *option="") const;
   /** Main GetField function */
   virtual void GetFieldValue(const Double_t point[3], Double_t* bField);
+  /** Same as GetFieldValue, but const and reentrant **/
+  void EvaluateField(const Double_t point[3], Double_t* bField) const;
 
   void SetVerbose(Bool_t verbosity){ fVerbose = verbosity;}
 
@@ -73,9 +75,9 @@ private:
   /** Read field map from a ROOT file **/	
   void ReadRootFile(const char* fileName, const char* mapName);
 
-  Int_t GetLineForPosition(TVector3*  pos) const;
+  Int_t GetLineForPosition(const TVector3*  pos) const;
   Int_t GetPositionForLine(Int_t line, TVector3* pos) const;
-  Int_t GetLinesArrayForPosition(TVector3* pos, TArrayI* lines);
+  Int_t GetLinesArrayForPosition(const TVector3* pos, Int_t lines[8]) const;
 
   /** Map file name **/
   TString fFileName;
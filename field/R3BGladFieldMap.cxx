@@ -4,11 +4,11 @@
 #include <fstream>
 
 // Includes from ROOT
-#include "TArrayF.h"
 #include "TFile.h"
 #include "TMath.h"
 
 #include "R3BGladFieldMap.h"
+#include "R3BFieldGrid.h"
 
 
 using std::cout;
@@ -31,7 +31,12 @@ R3BGladFieldMap::R3BGladFieldMap() {
   fXstep = fYstep = fZstep = 0.;
   fNx    = fNy    = fNz    = 0;
   fScale = 1.;
-  fBx    = fBy    = fBz    = NULL;
+  fGrid  = NULL;
+  fB     = NULL;
+  gTrans = NULL;
+  fTrans[0] = fTrans[1] = fTrans[2] = 0.;
+  fCosRot = 1.;
+  fSinRot = 0.;
   fPosX = fPosY = fPosZ = 0.;
   fName     = "";
   fFileName = "";
@@ -50,7 +55,12 @@ R3BGladFieldMap::R3BGladFieldMap(const char* mapName, const char* fileType)
   fXstep = fYstep = fZstep = 0.;
   fNx    = fNy    = fNz    = 0;
   fScale = 1.;
-  fBx    = fBy    = fBz    = NULL;
+  fGrid  = NULL;
+  fB     = NULL;
+  gTrans = NULL;
+  fTrans[0] = fTrans[1] = fTrans[2] = 0.;
+  fCosRot = 1.;
+  fSinRot = 0.;
   fName  = mapName;
   TString dir = getenv("VMCWORKDIR");
   fFileName = dir + "/field/magField/R3B/" + mapName;
@@ -70,7 +80,12 @@ R3BGladFieldMap::R3BGladFieldMap(R3BFieldPar* fieldPar) {
   fXstep = fYstep = fZstep = 0.;
   fNx    = fNy    = fNz    = 0;
   fScale = 1.;
-  fBx    = fBy    = fBz    = NULL;
+  fGrid  = NULL;
+  fB     = NULL;
+  gTrans = NULL;
+  fTrans[0] = fTrans[1] = fTrans[2] = 0.;
+  fCosRot = 1.;
+  fSinRot = 0.;
   if ( ! fieldPar ) {
     cerr << "-W- R3BGladFieldConst::R3BGladFieldMap: empty parameter container!"
 	 << endl;
@@ -96,9 +111,8 @@ R3BGladFieldMap::R3BGladFieldMap(R3BFieldPar* fieldPar) {
 
 // ------------   Destructor   --------------------------------------------
 R3BGladFieldMap::~R3BGladFieldMap() {
-  if ( fBx ) delete fBx;
-  if ( fBy ) delete fBy;
-  if ( fBz ) delete fBz;
+  R3BFieldGrid::Release(fGrid);
+  if ( gTrans ) delete gTrans;
 }
 // ------------------------------------------------------------------------
 
@@ -107,15 +121,44 @@ R3BGladFieldMap::~R3BGladFieldMap() {
 // -----------   Intialisation   ------------------------------------------
 void R3BGladFieldMap::Init() {
 //  if      (fFileName.EndsWith(".root")) ReadRootFile(fFileName, fName);
-  if (fFileName.EndsWith(".dat"))  ReadAsciiFile(fFileName);
-  else {
+  if ( ! fFileName.EndsWith(".dat") ) {
     cerr << "-E- R3BGladFieldMap::Init: No proper file name defined! ("
 	 << fFileName << ")" << endl;
     Fatal("Init", "No proper file name");
   }
 
+  // All maps from the same file share one grid. The grid holds the
+  // unscaled field, the scale is applied in EvaluateField.
+  R3BFieldGrid* grid = R3BFieldGrid::Acquire(fFileName);
+  if ( grid ) {
+    cout << "-I- R3BGladFieldMap: Using already loaded field map "
+	 << fFileName << endl;
+    SetGrid(grid);
+  }
+  else {
+    // Map the binary cache of the ASCII map, create it if needed
+    TString binName = fFileName;
+    binName.Replace(binName.Length() - 4, 4, ".bin");
+    grid = R3BFieldGrid::MapBinary(binName, fFileName);
+    if ( ! grid ) {
+      ReadAsciiFile(fFileName);
+      grid  = fGrid;
+      fGrid = NULL;
+      grid->WriteBinary(binName, fFileName);
+    }
+    SetGrid(R3BFieldGrid::Publish(fFileName, grid));
+  }
+
 
+  if ( gTrans ) delete gTrans;
   gTrans   = new TVector3(0.0, 0.0, -113.4);
+
+  // Cache the local transformation for the fused lookup
+  fTrans[0] = gTrans->X();
+  fTrans[1] = gTrans->Y();
+  fTrans[2] = gTrans->Z();
+  fCosRot   = TMath::Cos(14.*TMath::DegToRad());
+  fSinRot   = TMath::Sin(14.*TMath::DegToRad());
 }
 // ------------------------------------------------------------------------
 
@@ -123,42 +166,10 @@ void R3BGladFieldMap::Init() {
 
 // -----------   Get x component of the field   ---------------------------
 Double_t R3BGladFieldMap::GetBx(Double_t x, Double_t y, Double_t z) {
-
-
-// cout << "-I- get Bx called " << endl;
-  // transform to local coordinates
-  // local to global
-  TVector3 localPoint(x,y,z);
-  
-  localPoint = localPoint + (*gTrans);
-  localPoint.RotateY(14.*TMath::DegToRad());
-
-  Int_t ix    = 0;
-  Int_t iy    = 0;
-  Int_t iz    = 0;
-  Double_t dx = 0.;
-  Double_t dy = 0.;
-  Double_t dz = 0.;
-
-  if ( IsInside(localPoint.X(), localPoint.Y(), localPoint.Z(), ix, iy, iz, dx, dy, dz) ) {
-
-  // Get Bx field values at grid cell corners
-  fHa[0][0][0] = fBx->At(ix    *2*fNy*fNz + iy    *fNz + iz);
-  fHa[1][0][0] = fBx->At((ix+1)*2*fNy*fNz + iy    *fNz + iz);
-  fHa[0][1][0] = fBx->At(ix    *2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[1][1][0] = fBx->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[0][0][1] = fBx->At(ix    *2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[1][0][1] = fBx->At((ix+1)*2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[0][1][1] = fBx->At(ix    *2*fNy*fNz + (iy+1)*fNz + (iz+1));
-  fHa[1][1][1] = fBx->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + (iz+1));
-
-  // Return interpolated field value
-  Double_t val = Interpolate(dx, dy, dz);
-  //cout << " (X) interpolated " << val << endl;
-  return (val);
-  }
-
-  return 0.;
+  Double_t point[3] = { x, y, z };
+  Double_t bField[3];
+  EvaluateField(point, bField);
+  return bField[0];
 }
 // ------------------------------------------------------------------------
 
@@ -166,85 +177,102 @@ Double_t R3BGladFieldMap::GetBx(Double_t x, Double_t y, Double_t z) {
 
 // -----------   Get y component of the field   ---------------------------
 Double_t R3BGladFieldMap::GetBy(Double_t x, Double_t y, Double_t z) {
+  Double_t point[3] = { x, y, z };
+  Double_t bField[3];
+  EvaluateField(point, bField);
+  return bField[1];
+}
+// ------------------------------------------------------------------------
 
-  // transform to local coordinates
-  // local to global
-  TVector3 localPoint(x,y,z);
-  
-  localPoint = localPoint + (*gTrans);
-  localPoint.RotateY(14.*TMath::DegToRad());
-
-  Int_t ix    = 0;
-  Int_t iy    = 0;
-  Int_t iz    = 0;
-  Double_t dx = 0.;
-  Double_t dy = 0.;
-  Double_t dz = 0.;
-
-  if ( IsInside(localPoint.X(), localPoint.Y(), localPoint.Z(), ix, iy, iz, dx, dy, dz) ) {
-
-  // Get By field values at grid cell corners
-  fHa[0][0][0] = fBy->At(ix    *2*fNy*fNz + iy    *fNz + iz);
-  fHa[1][0][0] = fBy->At((ix+1)*2*fNy*fNz + iy    *fNz + iz);
-  fHa[0][1][0] = fBy->At(ix    *2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[1][1][0] = fBy->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[0][0][1] = fBy->At(ix    *2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[1][0][1] = fBy->At((ix+1)*2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[0][1][1] = fBy->At(ix    *2*fNy*fNz + (iy+1)*fNz + (iz+1));
-  fHa[1][1][1] = fBy->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + (iz+1));
-
-  // Return interpolated field value
-  Double_t val = Interpolate(dx, dy, dz);
-  //cout << " (Y) interpolated " << val << endl;
-  return (val);
 
-  }
 
-  return 0.;
+// -----------   Get z component of the field   ---------------------------
+Double_t R3BGladFieldMap::GetBz(Double_t x, Double_t y, Double_t z) {
+  Double_t point[3] = { x, y, z };
+  Double_t bField[3];
+  EvaluateField(point, bField);
+  return bField[2];
 }
 // ------------------------------------------------------------------------
 
 
 
-// -----------   Get z component of the field   ---------------------------
-Double_t R3BGladFieldMap::GetBz(Double_t x, Double_t y, Double_t z) {
+// -----------   Get all field components   -------------------------------
+void R3BGladFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField) {
+  EvaluateField(point, bField);
+}
+// ------------------------------------------------------------------------
 
-  Int_t ix    = 0;
-  Int_t iy    = 0;
-  Int_t iz    = 0;
-  Double_t dx = 0.;
-  Double_t dy = 0.;
-  Double_t dz = 0.;
 
-  // transform to local coordinates
-  // local to global
-  TVector3 localPoint(x,y,z);
-  
-  localPoint = localPoint + (*gTrans);
-  localPoint.RotateY(14.*TMath::DegToRad());
+
+// -----------   Get the field for a set of points   ----------------------
+void R3BGladFieldMap::GetFieldValues(Int_t nPoints, const Double_t* points,
+				     Double_t* bFields) {
+  for (Int_t i = 0; i < nPoints; i++) {
+    EvaluateField(points + 3*i, bFields + 3*i);
+  }
+}
+// ------------------------------------------------------------------------
 
 
 
-  if ( IsInside(localPoint.X(), localPoint.Y(), localPoint.Z(), ix, iy, iz, dx, dy, dz) ) {
+// -----------   Fused field evaluation (private)   -----------------------
+void R3BGladFieldMap::EvaluateField(const Double_t point[3],
+				    Double_t* bField) const {
 
-  // Get Bz field values at grid cell corners
-  fHa[0][0][0] = fBz->At(ix    *2*fNy*fNz + iy    *fNz + iz);
-  fHa[1][0][0] = fBz->At((ix+1)*2*fNy*fNz + iy    *fNz + iz);
-  fHa[0][1][0] = fBz->At(ix    *2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[1][1][0] = fBz->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + iz);
-  fHa[0][0][1] = fBz->At(ix    *2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[1][0][1] = fBz->At((ix+1)*2*fNy*fNz + iy    *fNz + (iz+1));
-  fHa[0][1][1] = fBz->At(ix    *2*fNy*fNz + (iy+1)*fNz + (iz+1));
-  fHa[1][1][1] = fBz->At((ix+1)*2*fNy*fNz + (iy+1)*fNz + (iz+1));
+  bField[0] = bField[1] = bField[2] = 0.;
+  if ( ! fB ) return;
 
-  // Return interpolated field value
-  Double_t val = Interpolate(dx, dy, dz);
-  //cout << " (Z) interpolated " << val << endl;
-  return (val);
+  // Transform to local coordinates: translation, then rotation around y
+  // (same arithmetic as TVector3::RotateY)
+  Double_t xt = point[0] + fTrans[0];
+  Double_t yl = point[1] + fTrans[1];
+  Double_t zt = point[2] + fTrans[2];
+  Double_t xl = fSinRot * zt + fCosRot * xt;
+  Double_t zl = fCosRot * zt - fSinRot * xt;
 
+  // Check for being outside the map range
+  if ( ! ( xl > -fXmax && xl < fXmax && yl > -fYmax && yl < fYmax &&
+	   zl >= fZmin && zl < fZmax ) ) return;
+
+  // Determine grid cell and relative position inside (in cell units)
+  Double_t ux = (xl+fXmax) / fXstep;
+  Double_t uy = (yl+fYmax) / fYstep;
+  Double_t uz = (zl-fZmin) / fZstep;
+  Int_t ix = Int_t(ux);
+  Int_t iy = Int_t(uy);
+  Int_t iz = Int_t(uz);
+  Double_t dx = ux - Double_t(ix);
+  Double_t dy = uy - Double_t(iy);
+  Double_t dz = uz - Double_t(iz);
+
+  // Corners of the cell in the interleaved grid
+  const Int_t sx = 3 * 2*fNy*fNz;
+  const Int_t sy = 3 * fNz;
+  const Int_t sz = 3;
+  const Float_t* h = fB + 3 * (ix*2*fNy*fNz + iy*fNz + iz);
+
+  // Interpolate all components at once, x, then y, then z
+  for (Int_t i = 0; i < 3; i++) {
+    Double_t h000 = h[i];
+    Double_t h100 = h[sx+i];
+    Double_t h010 = h[sy+i];
+    Double_t h110 = h[sx+sy+i];
+    Double_t h001 = h[sz+i];
+    Double_t h101 = h[sx+sz+i];
+    Double_t h011 = h[sy+sz+i];
+    Double_t h111 = h[sx+sy+sz+i];
+
+    Double_t hb00 = h000 + ( h100 - h000 ) * dx;
+    Double_t hb10 = h010 + ( h110 - h010 ) * dx;
+    Double_t hb01 = h001 + ( h101 - h001 ) * dx;
+    Double_t hb11 = h011 + ( h111 - h011 ) * dx;
+
+    Double_t hc0 = hb00 + ( hb10 - hb00 ) * dy;
+    Double_t hc1 = hb01 + ( hb11 - hb01 ) * dy;
+
+    bField[i] = ( hc0 + ( hc1 - hc0 ) * dz ) * fScale;
   }
-
-  return 0.;
 }
 // ------------------------------------------------------------------------
 
@@ -312,7 +340,7 @@ void R3BGladFieldMap::WriteAsciiFile(const char* fileName) {
   mapFile << fZmin << " " << fZmax << " " << fNz << endl;
 
   // Write field values
-  Double_t factor = 10. * fScale;  // Takes out scaling and converts kG->T
+  Double_t factor = 10.;  // Converts kG->T, the grid is not scaled
   cout << right;
   Int_t nTot = fNx * fNy * fNz;
   cout << "-I- R3BGladFieldMap: " << fNx*fNy*fNz << " entries to write... " 
@@ -329,8 +357,8 @@ void R3BGladFieldMap::WriteAsciiFile(const char* fileName) {
 	  Double_t perc = TMath::Nint(100.*index/nTot);
 	  cout << "\b\b\b\b\b\b" << setw(3) << perc << " % " << flush;
 	}
-	mapFile << fBx->At(index)/factor << " " << fBy->At(index)/factor 
-		<< " " << fBz->At(index)/factor << endl;
+	mapFile << fB[3*index]/factor << " " << fB[3*index+1]/factor 
+		<< " " << fB[3*index+2]/factor << endl;
       } // z-Loop
     }   // y-Loop
   }     // x-Loop
@@ -415,9 +443,9 @@ void R3BGladFieldMap::Reset() {
   fXstep = fYstep = fZstep = 0.;
   fNx = fNy = fNz = 0;
   fScale = 1.;
-  if ( fBx ) { delete fBx; fBx = NULL; }
-  if ( fBy ) { delete fBy; fBy = NULL; }
-  if ( fBz ) { delete fBz; fBz = NULL; }
+  R3BFieldGrid::Release(fGrid);
+  fGrid = NULL;
+  fB    = NULL;
 }
 // ------------------------------------------------------------------------  
 
@@ -464,12 +492,15 @@ void R3BGladFieldMap::ReadAsciiFile(const char* fileName) {
     fNx += 1;
     fNy += 1;
     fNz += 1;
-  fBx = new TArrayF(2*fNx * 2*fNy * fNz);
-  fBy = new TArrayF(2*fNx * 2*fNy * fNz);
-  fBz = new TArrayF(2*fNx * 2*fNy * fNz);
+  R3BFieldGrid::Release(fGrid);
+  fGrid = new R3BFieldGrid(3 * 2*fNx * 2*fNy * fNz, 3);
+  fGrid->SetAxis(0, fXmin, fXmax, fXstep, fNx);
+  fGrid->SetAxis(1, fYmin, fYmax, fYstep, fNy);
+  fGrid->SetAxis(2, fZmin, fZmax, fZstep, fNz);
+  Float_t* b = fGrid->GetData();
 
   // Read the field values
-  Double_t factor = fScale * 10.;   // Factor 10 for T -> kG
+  Double_t factor = 10.;   // Factor 10 for T -> kG, fScale applied later
   cout << right;
   Int_t nTot = fNx * fNy * fNz;
   cout << "-I- R3BGladFieldMap: " << nTot << " entries to read... " 
@@ -516,21 +547,21 @@ void R3BGladFieldMap::ReadAsciiFile(const char* fileName) {
           TVector3 B4(-bx, by, -bz);
           B4.RotateY(-14.*TMath::DegToRad());
 
-          fBx->AddAt(factor*B1.X(), index1);
-          fBy->AddAt(factor*B1.Y(), index1);
-          fBz->AddAt(factor*B1.Z(), index1);
+          b[3*index1]   = factor*B1.X();
+          b[3*index1+1] = factor*B1.Y();
+          b[3*index1+2] = factor*B1.Z();
 
-          fBx->AddAt(factor*B2.X(), index2);
-          fBy->AddAt(factor*B2.Y(), index2);
-          fBz->AddAt(factor*B2.Z(), index2);
+          b[3*index2]   = factor*B2.X();
+          b[3*index2+1] = factor*B2.Y();
+          b[3*index2+2] = factor*B2.Z();
 
-          fBx->AddAt(factor*B3.X(), index3);
-          fBy->AddAt(factor*B3.Y(), index3);
-          fBz->AddAt(factor*B3.Z(), index3);
+          b[3*index3]   = factor*B3.X();
+          b[3*index3+1] = factor*B3.Y();
+          b[3*index3+2] = factor*B3.Z();
 
-          fBx->AddAt(factor*B4.X(), index4);
-          fBy->AddAt(factor*B4.Y(), index4);
-          fBz->AddAt(factor*B4.Z(), index4);
+          b[3*index4]   = factor*B4.X();
+          b[3*index4+1] = factor*B4.Y();
+          b[3*index4+2] = factor*B4.Z();
           // ------------------------------------------------------------------------------------------
 
       //  cout << "-I- " << bx << " : " << by << " : "  << bz  << " : " << endl;
@@ -651,22 +682,25 @@ void R3BGladFieldMap::SetField(const R3BGladFieldMapData* data) {
 }
 */
 
-// ------------   Interpolation in a grid cell (private)  -----------------
-Double_t R3BGladFieldMap::Interpolate(Double_t dx, Double_t dy, Double_t dz) {
-
-  // Interpolate in x coordinate
-  fHb[0][0] = fHa[0][0][0] + ( fHa[1][0][0]-fHa[0][0][0] ) * dx;
-  fHb[1][0] = fHa[0][1][0] + ( fHa[1][1][0]-fHa[0][1][0] ) * dx;
-  fHb[0][1] = fHa[0][0][1] + ( fHa[1][0][1]-fHa[0][0][1] ) * dx;
-  fHb[1][1] = fHa[0][1][1] + ( fHa[1][1][1]-fHa[0][1][1] ) * dx;
-
-  // Interpolate in y coordinate
-  fHc[0] = fHb[0][0] + ( fHb[1][0] - fHb[0][0] ) * dy;
-  fHc[1] = fHb[0][1] + ( fHb[1][1] - fHb[0][1] ) * dy;
-
-  // Interpolate in z coordinate
-  return fHc[0] + ( fHc[1] - fHc[0] ) * dz;
-
+// ------------   Use a shared field grid (private)  ---------------------
+void R3BGladFieldMap::SetGrid(R3BFieldGrid* grid) {
+  // The caller hands over one reference. Init() called again acquires
+  // the grid already held, so the extra reference is dropped here.
+  R3BFieldGrid::Release(fGrid);
+  fGrid  = grid;
+  fB     = grid->GetData();
+  fXmin  = grid->GetMin(0);
+  fXmax  = grid->GetMax(0);
+  fXstep = grid->GetStep(0);
+  fNx    = grid->GetN(0);
+  fYmin  = grid->GetMin(1);
+  fYmax  = grid->GetMax(1);
+  fYstep = grid->GetStep(1);
+  fNy    = grid->GetN(1);
+  fZmin  = grid->GetMin(2);
+  fZmax  = grid->GetMax(2);
+  fZstep = grid->GetStep(2);
+  fNz    = grid->GetN(2);
 }
 // ------------------------------------------------------------------------
 
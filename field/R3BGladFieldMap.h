@@ -7,7 +7,7 @@
 #include "TRotation.h"
 #include "TVector3.h"
 
-class TArrayF;
+class R3BFieldGrid;
 
 class R3BGladFieldMap : public FairField {
 
@@ -51,6 +51,31 @@ public:
   virtual Double_t GetBz(Double_t x, Double_t y, Double_t z);
 
 
+  /** Get all field components at a certain point with a single
+   ** transformation and grid cell lookup
+   ** @param point     Point coordinates (global) [cm]
+   ** @param bField    (return) Field components [kG]
+   **/
+  virtual void GetFieldValue(const Double_t point[3], Double_t* bField);
+
+
+  /** Get the field components for a set of points at once
+   ** @param nPoints   Number of points
+   ** @param points    Point coordinates (global) [cm], x,y,z per point
+   ** @param bFields   (return) Field components [kG], Bx,By,Bz per point
+   **/
+  void GetFieldValues(Int_t nPoints, const Double_t* points, Double_t* bFields);
+
+
+  /** Transform a point to the local system, locate its grid cell and
+   ** interpolate all three field components in one pass.
+   ** Does not modify the map, so it can be called concurrently.
+   ** @param point     Point coordinates (global) [cm]
+   ** @param bField    (return) Field components [kG], 0 outside the map
+   **/
+  void EvaluateField(const Double_t point[3], Double_t* bField) const;
+
+
   /** Determine whether a point is inside the field map
    ** @param x,y,z              Point coordinates (global) [cm]
    ** @param ix,iy,iz (return)  Grid cell
@@ -103,10 +128,8 @@ public:
   Double_t GetScale() const { return fScale; }
 
 
-  /** Accessors to the field value arrays **/
-  TArrayF* GetBx() const { return fBx; }
-  TArrayF* GetBy() const { return fBy; }
-  TArrayF* GetBz() const { return fBz; }
+  /** Accessor to the (shared, read-only) field grid **/
+  const R3BFieldGrid* GetGrid() const { return fGrid; }
 
 
   /** Accessor to field map file **/
@@ -137,10 +160,10 @@ public:
   //void SetField(const R3BGladFieldMapData* data);
 
 
-  /** Get field values by interpolation of the grid.
-   ** @param dx,dy,dz  Relative distance from grid point [cell units]
+  /** Use a (shared) field grid and take over its parameters. Takes
+   ** over one reference of grid and releases the one held before.
    **/
-  Double_t Interpolate(Double_t dx, Double_t dy, Double_t dz); 
+  void SetGrid(R3BFieldGrid* grid);
 
 
   /** Map file name **/
@@ -165,23 +188,27 @@ public:
   Int_t fNx, fNy, fNz;   //
 
 
-  /** Arrays with the field values  **/
-  TArrayF* fBx;    //!
-  TArrayF* fBy;    //! 
-  TArrayF* fBz;    //!
-
-
-  /** Variables for temporary storage 
-   ** Used in the very frequently called method GetFieldValue  **/
-  Double_t fHa[2][2][2];            //! Field at corners of a grid cell
-  Double_t fHb[2][2];               //! Interpolated field (2-dim)
-  Double_t fHc[2];                  //! Interpolated field (1-dim)
+  /** Field grid, shared by all maps read from the same file. Unscaled
+   ** values interleaved as (Bx,By,Bz) per grid point. Mapped from the
+   ** binary cache (<map>.bin) when available. **/
+  R3BFieldGrid*  fGrid;   //!
+  const Float_t* fB;      //! Cached fGrid->GetData()
 
   /** local transformation
   **/
   TRotation* gRot;    //!
   TVector3* gTrans;   //!
 
+  /** Cached components of gTrans and of the rotation around y **/
+  Double_t fTrans[3];          //!
+  Double_t fCosRot, fSinRot;   //!
+
+
+
+ private:
+
+  R3BGladFieldMap(const R3BGladFieldMap&);
+  R3BGladFieldMap& operator=(const R3BGladFieldMap&);
 
 
  ClassDef(R3BGladFieldMap,1)
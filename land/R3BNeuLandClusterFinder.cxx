@@ -142,11 +142,8 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
   Int_t nClusters = 0;
   fhHits->Fill(nDigis);
  
-  // Map from digi index to cluster index
-  Int_t belongsToCluster[3000];
-  for(Int_t i = 0; i < 3000; i++) {
-    belongsToCluster[i] = -1;
-  }
+  // Map from digi index to cluster index (buffer is kept between events)
+  fBelongsToCluster.assign(nDigis, -1);
   
   // Declare variables outside of loop
   R3BLandDigi *digi2;
@@ -155,7 +152,7 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
   Int_t clusNo;
 
   // Check number of digis
-  if (nDigis > 0 && nDigis <= 3000) {
+  if (nDigis > 0) {
   
     // Loop over all sorted digis
     for (Int_t i = 0; i < nDigis; i++) {
@@ -168,7 +165,8 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
       post = digi1->GetTdc();        
       oldPaddle = (Int_t)(digi1->GetPaddleNr()-1);
       
-      // find neighbour
+      // find neighbour. Digis are sorted in time, so only the following
+      // digis up to the end of the time window can be neighbours.
       for (Int_t k = i; k < nDigis; k++) {
 	// Get pointer to 2-nd digi
 	digi2 = fVectorDigi.at(k);
@@ -183,6 +181,11 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
 	  // 2-nd digi has earlier time. Stop here.
 	  Fatal("Exec()", "Sorting of digis failed.");
 	}
+
+	// End of the time window, no later digi can be a neighbour
+	if(delt >= 1.0) {
+	  break;
+	}
         
 	// Check if neighbour
 	if(TMath::Abs(delx) < 7.5 && TMath::Abs(dely) < 7.5 &&
@@ -190,11 +193,11 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
 	  // This is a neighbour
 
 	  // Check if this cluster already exists
-	  if(belongsToCluster[i] > -1) {
+	  if(fBelongsToCluster[i] > -1) {
 	    if(i != k) {
 	      // Inside cluster
-	      clusNo = belongsToCluster[i];
-	      belongsToCluster[k] = nClusters-1;
+	      clusNo = fBelongsToCluster[i];
+	      fBelongsToCluster[k] = nClusters-1;
 	      // Get pointer to the current cluster
 	      cluster = (R3BNeuLandCluster*) fArrayCluster->At(clusNo);
 	      // Update information of the cluster
@@ -212,7 +215,7 @@ void R3BNeuLandClusterFinder::Exec(Option_t *option)
 							 digi2->GetXX(), digi2->GetYY(), digi2->GetZZ(),
 							 digi2->GetTdc(),
 							 digi2->GetQdc(), 1);
-	    belongsToCluster[k] = nClusters;
+	    fBelongsToCluster[k] = nClusters;
 	    // Increment number of clusters
 	    nClusters += 1;
 	  }
@@ -279,7 +282,7 @@ void R3BNeuLandClusterFinder::Reset()
 {
   // Reset an event
 
-  // Clear sorted vector
+  // Clear sorted vector (keeps its capacity)
   fVectorDigi.clear();
 
   // Clear output array
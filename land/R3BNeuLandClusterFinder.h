@@ -43,6 +43,7 @@ class R3BNeuLandClusterFinder : public FairTask {
   TClonesArray              *fArrayDigi;    // Array of digis - input
   TClonesArray              *fArrayCluster; // Array of clusters - output
   std::vector<R3BLandDigi*>  fVectorDigi;   // Vector of digis (for sorting in time)
+  std::vector<Int_t>         fBelongsToCluster; //! Cluster index of each sorted digi
 
   // Control histograms
   TH1F *fhClusterSize;
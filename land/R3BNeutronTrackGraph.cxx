@@ -0,0 +1,449 @@
+// -------------------------------------------------------------------------
+// -----                 R3BNeutronTrackGraph source file              -----
+// -------------------------------------------------------------------------
+
+#include "R3BNeutronTrackGraph.h"
+
+#include "TMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+  const Double_t kNeighbour = 7.5;   // Max. distance of hits in a cluster [cm]
+  const Double_t kTimeWindow = 1.0;  // Max. time difference [ns]
+  const Double_t kDio = 10.6;        // 3 times half the diagonal of a paddle
+
+  // Smallest and largest angle between v1 and v, v being moved by the
+  // position resolution in every direction
+  void AngleRange(Double_t v1x, Double_t v1y, Double_t v1z,
+                  Double_t vx, Double_t vy, Double_t vz,
+                  Double_t& min, Double_t& max)
+  {
+    Double_t r1 = sqrt(v1x*v1x + v1y*v1y + v1z*v1z);
+    for (Int_t k = 0; k < 2; k++) {
+      Double_t x = k == 0 ? vx - kDio : vx + kDio;
+      for (Int_t l = 0; l < 2; l++) {
+        Double_t y = l == 0 ? vy - kDio : vy + kDio;
+        for (Int_t m = 0; m < 2; m++) {
+          Double_t z = m == 0 ? vz - kDio : vz + kDio;
+          Double_t angle = acos((v1x*x + v1y*y + v1z*z) / r1
+                                / sqrt(x*x + y*y + z*z));
+          if (angle > max) max = angle;
+          if (angle < min) min = angle;
+        }
+      }
+    }
+  }
+
+  template <class T>
+  bool EarlierHit(const T& a, const T& b) { return a.t < b.t; }
+
+}
+
+
+// -----   Default constructor   -------------------------------------------
+R3BNeutronTrackGraph::R3BNeutronTrackGraph()
+  : fAmu(931.49432),
+    fC(2.99792458E8),
+    fBeamEnergy(0.),
+    fBeamBeta(0.),
+    fNClusters(0)
+{
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method Clear   -------------------------------------------
+void R3BNeutronTrackGraph::Clear()
+{
+  fHits.clear();
+  fClusters.clear();
+  fNClusters = 0;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method AddHit   ------------------------------------------
+void R3BNeutronTrackGraph::AddHit(Double_t x, Double_t y, Double_t z,
+                                  Double_t t, Double_t e)
+{
+  Hit hit = { x, y, z, t, e };
+  fHits.push_back(hit);
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method FindClusters   ------------------------------------
+Int_t R3BNeutronTrackGraph::FindClusters()
+{
+  Int_t nHits = fHits.size();
+
+  // Time order, equal times keep their input order
+  std::stable_sort(fHits.begin(), fHits.end(), EarlierHit<Hit>);
+
+  // Links to the later neighbours. The hits are time ordered, so the
+  // scan ends at the first hit outside the time window.
+  fLinkStart.resize(nHits + 1);
+  fLinks.clear();
+  for (Int_t l = 0; l < nHits; l++) {
+    fLinkStart[l] = fLinks.size();
+    const Hit& a = fHits[l];
+    for (Int_t k = l + 1; k < nHits; k++) {
+      const Hit& b = fHits[k];
+      if (b.t - a.t >= kTimeWindow) {
+        break;
+      }
+      if (TMath::Abs(b.x - a.x) < kNeighbour &&
+          TMath::Abs(b.y - a.y) < kNeighbour &&
+          TMath::Abs(b.z - a.z) < kNeighbour) {
+        fLinks.push_back(k);
+      }
+    }
+  }
+  fLinkStart[nHits] = fLinks.size();
+
+  // A hit without a cluster starts a new one, its neighbours are added
+  // to the cluster of the hit. As in the original tracker, a neighbour
+  // is labelled with the newest cluster number, which is the one its
+  // own neighbours are added to later, and a neighbour already in a
+  // cluster is counted again.
+  fLabel.assign(nHits, 0);
+  for (Int_t l = 0; l < nHits; l++) {
+    const Hit& a = fHits[l];
+    if (fLabel[l] == 0) {
+      CLUSTER cluster;
+      cluster.xStart = cluster.xEnd = a.x;
+      cluster.yStart = cluster.yEnd = a.y;
+      cluster.zStart = cluster.zEnd = a.z;
+      cluster.tStart = cluster.tStop = a.t;
+      cluster.e = a.e;
+      cluster.size = 1;
+      fClusters.push_back(cluster);
+      fLabel[l] = fClusters.size();
+    }
+    CLUSTER& cluster = fClusters[fLabel[l] - 1];
+    for (Int_t n = fLinkStart[l]; n < fLinkStart[l + 1]; n++) {
+      Int_t k = fLinks[n];
+      const Hit& b = fHits[k];
+      fLabel[k] = fClusters.size();
+      cluster.e = cluster.e + b.e;
+      cluster.size = cluster.size + 1;
+      if (b.t > cluster.tStop) {
+        cluster.tStop = b.t;
+        cluster.xEnd = b.x;
+        cluster.yEnd = b.y;
+        cluster.zEnd = b.z;
+      }
+    }
+  }
+
+  fNClusters = fClusters.size();
+  return fNClusters;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method BuildClusterEdges   ------------------------------
+void R3BNeutronTrackGraph::BuildClusterEdges()
+{
+  // Only cluster pairs for which the measured momentum range of the
+  // scattered neutron is valid, i.e. beta3 can be < 1 within the
+  // position resolution, can pass the momentum test of IsElastic.
+  // This does not depend on the incoming neutron and is done once.
+  fEdgeStart.resize(fNClusters + 1);
+  fEdges.clear();
+  for (Int_t i = 0; i < fNClusters; i++) {
+    fEdgeStart[i] = fEdges.size();
+    const CLUSTER& ci = fClusters[i];
+    for (Int_t j = i + 1; j < fNClusters; j++) {
+      const CLUSTER& cj = fClusters[j];
+      Double_t v3x = cj.xStart - ci.xStart;
+      Double_t v3y = cj.yStart - ci.yStart;
+      Double_t v3z = cj.zStart - ci.zStart;
+      Double_t dt = cj.tStart - ci.tStart;
+      Double_t dr = sqrt(v3x*v3x + v3y*v3y + v3z*v3z);
+
+      Double_t beta3max = (dr + kDio) / dt * 1.E7 / fC;
+      Double_t beta3min = (dr - kDio) / dt * 1.E7 / fC;
+      if (beta3max > 0.99) beta3max = 0.99;
+      if (beta3min < 0.) beta3min = 0.;
+      Double_t gamma3min = 1. / sqrt(1. - beta3min*beta3min);
+      Double_t gamma3max = 1. / sqrt(1. - beta3max*beta3max);
+
+      Edge edge;
+      edge.j = j;
+      edge.p3min = beta3min * gamma3min * 1. * fAmu;
+      edge.p3max = beta3max * gamma3max * 1. * fAmu;
+      if (std::isfinite(edge.p3min) && edge.p3max > 0.) {
+        fEdges.push_back(edge);
+      }
+    }
+  }
+  fEdgeStart[fNClusters] = fEdges.size();
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method SetIncoming   ------------------------------------
+void R3BNeutronTrackGraph::SetIncoming(Int_t i, Double_t x0, Double_t y0,
+                                       Double_t z0, Double_t t0,
+                                       Incoming& in) const
+{
+  const CLUSTER& ci = fClusters[i];
+
+  // Incoming neutron, from the previous interaction
+  in.v1x = ci.xStart - x0;
+  in.v1y = ci.yStart - y0;
+  in.v1z = ci.zStart - z0;
+  Double_t dt = ci.tStart - t0;
+  Double_t dr = sqrt(in.v1x*in.v1x + in.v1y*in.v1y + in.v1z*in.v1z);
+
+  Double_t beta1 = dr / dt * 1.E7 / fC;
+  Double_t beta1max = (dr + kDio) / dt * 1.E7 / fC;
+  Double_t beta1min = (dr - kDio) / dt * 1.E7 / fC;
+  if (beta1max > 0.99) beta1max = 0.99;
+  if (beta1min < 0.) beta1min = 0.;
+
+  Double_t gamma1 = 1. / sqrt(1. - beta1*beta1);
+  Double_t gamma1min = 1. / sqrt(1. - beta1min*beta1min);
+  Double_t gamma1max = 1. / sqrt(1. - beta1max*beta1max);
+  Double_t p1min = beta1min * gamma1min * 1. * fAmu;
+  Double_t p1max = beta1max * gamma1max * 1. * fAmu;
+  Double_t p1 = beta1 * gamma1 * 1. * fAmu;
+  in.K1 = sqrt(p1*p1 + fAmu*fAmu) - fAmu;
+  in.K1min = sqrt(p1min*p1min + fAmu*fAmu) - fAmu;
+  in.K1max = sqrt(p1max*p1max + fAmu*fAmu) - fAmu;
+
+  // Recoil proton and the normal of the scattering plane
+  Double_t v4x = ci.xEnd - ci.xStart;
+  Double_t v4y = ci.yEnd - ci.yStart;
+  Double_t v4z = ci.zEnd - ci.zStart;
+  in.v5x = in.v1y*v4z - in.v1z*v4y;
+  in.v5y = in.v1z*v4x - in.v1x*v4z;
+  in.v5z = in.v1x*v4y - in.v1y*v4x;
+
+  Double_t theta4Measured = acos((in.v1x*v4x + in.v1y*v4y + in.v1z*v4z)
+                                 / sqrt(in.v1x*in.v1x + in.v1y*in.v1y + in.v1z*in.v1z)
+                                 / sqrt(v4x*v4x + v4y*v4y + v4z*v4z));
+  in.theta4Measuredmin = theta4Measured;
+  in.theta4Measuredmax = theta4Measured;
+  if ((v4x*v4x + v4y*v4y + v4z*v4z) == 0.) {
+    in.theta4Measuredmin = 0.;
+    in.theta4Measuredmax = 1.55;
+  }
+  AngleRange(in.v1x, in.v1y, in.v1z, v4x, v4y, v4z,
+             in.theta4Measuredmin, in.theta4Measuredmax);
+  if (in.theta4Measuredmax > 1.55) in.theta4Measuredmax = 1.55;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method IsElastic   --------------------------------------
+Bool_t R3BNeutronTrackGraph::IsElastic(Int_t i, const Edge& edge,
+                                       const Incoming& in) const
+{
+  // Elastic scattering of particle 1 (neutron) on particle 2 (proton)
+  // at rest. Outgoing particles are 3 (scattered neutron) and 4 (recoil
+  // proton). The conditions are those of the original tracker, the
+  // cheapest one first.
+  const CLUSTER& ci = fClusters[i];
+  const CLUSTER& cj = fClusters[edge.j];
+
+  Double_t v3x = cj.xStart - ci.xStart;
+  Double_t v3y = cj.yStart - ci.yStart;
+  Double_t v3z = cj.zStart - ci.zStart;
+
+  // Neutron and proton are in opposite directions of the incoming one
+  Double_t v6x = in.v1y*v3z - in.v1z*v3y;
+  Double_t v6y = in.v1z*v3x - in.v1x*v3z;
+  Double_t v6z = in.v1x*v3y - in.v1y*v3x;
+  Double_t theta56 = acos((in.v5x*v6x + in.v5y*v6y + in.v5z*v6z)
+                          / sqrt(in.v5x*in.v5x + in.v5y*in.v5y + in.v5z*in.v5z)
+                          / sqrt(v6x*v6x + v6y*v6y + v6z*v6z));
+  if ((in.v5x*in.v5x + in.v5y*in.v5y + in.v5z*in.v5z) == 0. ||
+      (v6x*v6x + v6y*v6y + v6z*v6z) == 0.) {
+    theta56 = 3.14;
+  }
+  if (!(theta56*180./3.14 > 120.)) {
+    return kFALSE;
+  }
+
+  Double_t theta3 = acos((in.v1x*v3x + in.v1y*v3y + in.v1z*v3z)
+                         / sqrt(in.v1x*in.v1x + in.v1y*in.v1y + in.v1z*in.v1z)
+                         / sqrt(v3x*v3x + v3y*v3y + v3z*v3z));
+  Double_t theta3min = theta3;
+  Double_t theta3max = theta3;
+  AngleRange(in.v1x, in.v1y, in.v1z, v3x, v3y, v3z, theta3min, theta3max);
+  if (theta3max > 1.55) theta3max = 1.55;
+
+  // Momenta of the scattered neutron and proton
+  Double_t Ma = 1.0087 * fAmu;
+  Double_t Mb = 1.0073 * fAmu;
+  Double_t Mc = Ma;
+  Double_t Md = Mb;
+  Double_t Ka = in.K1;
+  Double_t Thc = theta3;
+  Double_t Ei = Ma + Mb + Ka;
+  Double_t Pa = sqrt(Ka * Ka + 2. * Ka * Ma);
+  Double_t AA = Ei * Ei - Md * Md + Mc * Mc - Pa * Pa;
+  Double_t BB = AA * AA - 4. * Ei * Ei * Mc * Mc;
+  Double_t a = 4. * Pa * Pa * cos(Thc) * cos(Thc) - 4. * Ei * Ei;
+  Double_t b = 4. * AA * Pa * cos(Thc);
+  Double_t cc = BB;
+  Double_t Pc1 = -b/(2. * a) + sqrt((b * b)/(4. * a * a) - (cc / a));
+  if (Pc1 < 0.) Pc1 = 0.;
+  Double_t Pd1 = sqrt(Pc1 * Pc1 + Pa * Pa - 2. * Pc1 * Pa * cos(Thc));
+  Double_t Thd1 = acos((Pc1 * Pc1 - Pd1 * Pd1 - Pa * Pa) / (-2. * Pd1 * Pa));
+
+  Double_t p3bmin = Pc1;
+  Double_t p3bmax = Pc1;
+  Double_t p4bmin = Pd1;
+  Double_t p4bmax = Pd1;
+  Double_t theta4min = Thd1;
+  Double_t theta4max = Thd1;
+
+  // Minimum and maximum within the errors
+  for (Int_t m = 1; m < 5; m++) {
+    Ka = m < 3 ? in.K1min : in.K1max;
+    Thc = (m % 2) == 1 ? theta3min : theta3max;
+
+    Ei = Ma + Mb + Ka;
+    Pa = sqrt(Ka * Ka + 2. * Ka * Ma);
+    AA = Ei * Ei - Md * Md + Mc * Mc - Pa * Pa;
+    BB = AA * AA - 4. * Ei * Ei * Mc * Mc;
+    a = 4. * Pa * Pa * cos(Thc) * cos(Thc) - 4. * Ei * Ei;
+    b = 4. * AA * Pa * cos(Thc);
+    cc = BB;
+    Pc1 = -b/(2. * a) + sqrt((b * b)/(4. * a * a) - (cc / a));
+    if (((b * b)/(4. * a * a) - (cc / a)) < 0.) Pc1 = 0.;
+    if (Pc1 < 0.) Pc1 = 0.;
+    Pd1 = sqrt(Pc1 * Pc1 + Pa * Pa - 2. * Pc1 * Pa * cos(Thc));
+    Thd1 = acos((Pc1 * Pc1 - Pd1 * Pd1 - Pa * Pa) / (-2. * Pd1 * Pa));
+
+    if (Pc1 < p3bmin) p3bmin = Pc1;
+    if (Pc1 > p3bmax) p3bmax = Pc1;
+    if (Pd1 < p4bmin) p4bmin = Pd1;
+    if (Pd1 > p4bmax) p4bmax = Pd1;
+    if (Thd1 < theta4min) theta4min = Thd1;
+    if (Thd1 > theta4max) theta4max = Thd1;
+  }
+
+  if (!(p3bmax > edge.p3min && p3bmin < edge.p3max &&
+        theta4max > in.theta4Measuredmin && theta4min < in.theta4Measuredmax)) {
+    return kFALSE;
+  }
+
+  Double_t K4bmin = sqrt(p4bmin * p4bmin - -Mb * Mb) - Mb;
+  Double_t K4bmax = sqrt(p4bmax * p4bmax - -Mb * Mb) - Mb;
+  Double_t protonEnergy = 8.76839 + 4.13858*ci.e - 0.00337368*ci.e*ci.e;
+  return K4bmax > protonEnergy && K4bmin < protonEnergy;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method RemoveCluster   ----------------------------------
+void R3BNeutronTrackGraph::RemoveCluster(Int_t k)
+{
+  // Shift the following clusters down. The storage keeps its size, so
+  // the entries behind the last cluster are the same as in the arrays
+  // of the original tracker.
+  fNClusters--;
+  for (Int_t l = k; l < fNClusters; l++) {
+    fClusters[l] = fClusters[l + 1];
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method RemoveElastic   -----------------------------------
+Int_t R3BNeutronTrackGraph::RemoveElastic()
+{
+  BuildClusterEdges();
+
+  fElastic.clear();
+  fOrigin.clear();
+  Double_t x0 = 0., y0 = 0., z0 = 0., t0 = 0.;
+  Incoming in;
+  for (Int_t i = 0; i < fNClusters; i++) {
+    if (fEdgeStart[i] == fEdgeStart[i + 1]) {
+      continue;
+    }
+    SetIncoming(i, x0, y0, z0, t0, in);
+    for (Int_t n = fEdgeStart[i]; n < fEdgeStart[i + 1]; n++) {
+      if (IsElastic(i, fEdges[n], in)) {
+        fElastic.push_back(fEdges[n].j);
+        fOrigin.push_back(i);
+        x0 = fClusters[i].xStart;
+        y0 = fClusters[i].yStart;
+        z0 = fClusters[i].zStart;
+        t0 = fClusters[i].tStart;
+        break;
+      }
+    }
+  }
+
+  for (Int_t n = fElastic.size() - 1; n >= 0; n--) {
+    RemoveCluster(fElastic[n]);
+  }
+  return fNClusters;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method SelectClusters   ----------------------------------
+Int_t R3BNeutronTrackGraph::SelectClusters()
+{
+  // Late clusters and clusters with little energy are removed, the
+  // first cluster is always kept
+  fDelete.assign(fNClusters, kFALSE);
+  for (Int_t k = 0; k < fNClusters; k++) {
+    const CLUSTER& cluster = fClusters[k];
+    Double_t betaCluster = cluster.zStart / cluster.tStart * 1.E7 / fC;
+    if (TMath::Abs(betaCluster - fBeamBeta) > 0.05*600./fBeamEnergy) {
+      fDelete[k] = kTRUE;
+    }
+    if (cluster.e < 2.5 && k > 0) {
+      fDelete[k] = kTRUE;
+    }
+  }
+  for (Int_t k = fNClusters - 1; k > 0; k--) {
+    if (fDelete[k]) {
+      RemoveCluster(k);
+    }
+  }
+
+  // Order the others by their energy weighted difference to the beam
+  // beta. A cluster taken is set to t = 10000, e = 1 and competes
+  // further, as in the original tracker.
+  fSorted.assign(fClusters.begin(), fClusters.begin() + fNClusters);
+  for (Int_t i = 1; i < fNClusters; i++) {
+    Double_t betaMin = 10.;
+    Int_t index = 1;
+    for (Int_t k = 1; k < fNClusters; k++) {
+      Double_t betaCluster = fSorted[k].zStart / fSorted[k].tStart * 1.E7 / fC;
+      Double_t deltaBeta = 1. / fSorted[k].e * TMath::Abs(betaCluster - fBeamBeta);
+      if (deltaBeta < betaMin) {
+        betaMin = deltaBeta;
+        index = k;
+      }
+    }
+    fClusters[i] = fSorted[index];
+    fSorted[index].tStart = 10000.;
+    fSorted[index].e = 1.;
+  }
+
+  return fNClusters;
+}
+// -------------------------------------------------------------------------
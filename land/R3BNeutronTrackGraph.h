@@ -0,0 +1,149 @@
+// -------------------------------------------------------------------------
+// -----                 R3BNeutronTrackGraph header file              -----
+// -------------------------------------------------------------------------
+
+/**  R3BNeutronTrackGraph.h
+ **
+ **  Cluster and track building of R3BNeutronTracker on neighbour graphs.
+ **
+ **  The digis are sorted in time once. Each digi is linked to the later
+ **  digis within 7.5 cm in x, y and z and 1 ns; the scan stops at the
+ **  first digi outside the time window. Clusters are built on these
+ **  links. For the elastic scattering search every cluster is linked to
+ **  the later clusters which the scattered neutron can reach with
+ **  beta < 1 (within the position resolution); the kinematics is only
+ **  evaluated on these links, cheapest condition first.
+ **
+ **  The rules are those of the original R3BNeutronTracker loops, so the
+ **  clusters and their order are the same.
+ **/
+
+
+#ifndef R3BNEUTRONTRACKGRAPH_H
+#define R3BNEUTRONTRACKGRAPH_H 1
+
+
+#include "Rtypes.h"
+
+#include <vector>
+
+
+struct CLUSTER
+{
+  Double_t xStart,yStart,zStart,xEnd,yEnd,zEnd,tStart,tStop,e,size;
+};
+
+
+class R3BNeutronTrackGraph
+{
+
+ public:
+
+  R3BNeutronTrackGraph();
+
+
+  /** Atomic mass unit [MeV] and speed of light [m/s] as used by the
+   ** tracker **/
+  void SetConstants(Double_t amu, Double_t c) { fAmu = amu; fC = c; }
+
+
+  /** Beam energy [AMeV] and velocity, for the cluster selection **/
+  void SetBeam(Double_t beamEnergy, Double_t beamBeta)
+  { fBeamEnergy = beamEnergy; fBeamBeta = beamBeta; }
+
+
+  /** Start a new event, keeps the allocated storage **/
+  void Clear();
+
+
+  /** Add a digi
+   ** @param x,y,z  Position [cm]
+   ** @param t      Time [ns]
+   ** @param e      Energy (QDC)
+   **/
+  void AddHit(Double_t x, Double_t y, Double_t z, Double_t t, Double_t e);
+
+
+  /** Sort the digis in time and build the clusters
+   ** @value Number of clusters
+   **/
+  Int_t FindClusters();
+
+
+  /** Remove the clusters made by a neutron scattered elastically in
+   ** an earlier cluster
+   ** @value Number of remaining clusters
+   **/
+  Int_t RemoveElastic();
+
+
+  /** Remove late and low-energy clusters (except the first) and order
+   ** the others by their beta compared to the beam
+   ** @value Number of remaining clusters
+   **/
+  Int_t SelectClusters();
+
+
+  /** Accessors **/
+  Int_t GetNHits()     const { return fHits.size(); }
+  Int_t GetNClusters() const { return fNClusters; }
+  Int_t GetNLinks()    const { return fLinks.size(); }
+  Int_t GetNEdges()    const { return fEdges.size(); }
+
+  /** Cluster i. The entries from GetNClusters() to GetNStored()-1 are
+   ** left over from removed clusters, as in the arrays of the original
+   ** tracker. **/
+  const CLUSTER& GetCluster(Int_t i) const { return fClusters[i]; }
+  Int_t GetNStored() const { return fClusters.size(); }
+
+
+ private:
+
+  struct Hit {
+    Double_t x, y, z, t, e;
+  };
+
+  // Cluster j reachable from cluster i, with the measured momentum
+  // range of the scattered neutron
+  struct Edge {
+    Int_t j;
+    Double_t p3min, p3max;
+  };
+
+  // Incoming neutron at cluster i and the measured recoil proton
+  struct Incoming {
+    Double_t v1x, v1y, v1z;
+    Double_t v5x, v5y, v5z;
+    Double_t K1, K1min, K1max;
+    Double_t theta4Measuredmin, theta4Measuredmax;
+  };
+
+  void BuildClusterEdges();
+  void SetIncoming(Int_t i, Double_t x0, Double_t y0, Double_t z0,
+                   Double_t t0, Incoming& in) const;
+  Bool_t IsElastic(Int_t i, const Edge& edge, const Incoming& in) const;
+  void RemoveCluster(Int_t k);
+
+  Double_t fAmu;
+  Double_t fC;
+  Double_t fBeamEnergy;
+  Double_t fBeamBeta;
+
+  Int_t fNClusters;
+
+  std::vector<Hit>      fHits;       // Digis, time ordered after FindClusters
+  std::vector<Int_t>    fLinkStart;  // Neighbours of digi l: fLinks[fLinkStart[l] ..
+  std::vector<Int_t>    fLinks;      //   fLinkStart[l+1]-1]
+  std::vector<Int_t>    fLabel;      // Cluster number of each digi, 0 if none
+  std::vector<CLUSTER>  fClusters;
+  std::vector<Int_t>    fEdgeStart;  // Edges of cluster i, as the links above
+  std::vector<Edge>     fEdges;
+  std::vector<Int_t>    fElastic;    // Elastically scattered cluster
+  std::vector<Int_t>    fOrigin;     //   and its origin, in order found
+  std::vector<Bool_t>   fDelete;
+  std::vector<CLUSTER>  fSorted;
+
+};
+
+
+#endif
@@ -24,6 +24,7 @@
 #include "TH2F.h"
 #include <string>
 #include <iostream>
+#include <vector>
 
 
 #include "R3BLandPoint.h"
@@ -35,14 +36,26 @@
 using std::cout;
 using std::endl;
 
+// A primary neutron counts as found if a track starts within this
+// distance [cm] of its first interaction
+static const Double_t kMatchDistance = 10.6;
+
 		
 
 R3BNeutronTracker::R3BNeutronTracker() :
-  FairTask("R3B Land Digitization scheme ") { 
+  FairTask("R3B Land Digitization scheme "),
+  fNeutronTracks(NULL),
+  fNClusterAlloc(0),
+  fGraph(NULL),
+  fUseGraph(kTRUE),
+  fNPrimNeutrons(0),
+  fNTracks(0),
+  fNMatched(0) { 
 }
 
 
 R3BNeutronTracker::~R3BNeutronTracker() {
+  delete fGraph;
 }
 
 
@@ -100,6 +113,10 @@ InitStatus R3BNeutronTracker::Init() {
   NEUT1_hit=new NEUT1_HIT[100];
   NEUT2_hit=new NEUT2_HIT[100];
   Cluster=new CLUSTER[100];
+  fNClusterAlloc=100;
+
+  fGraph = new R3BNeutronTrackGraph();
+  fGraph->SetConstants(amu, c);
      
   hNeutmult = new TH1F("Neutmult","Neutron multiplicity from energy considerations",10,-0.5,9.5);
   hNeutmult->GetXaxis()->SetTitle("Number of Neutrons");
@@ -394,6 +411,7 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
       if (aTrack1!=0) prim = aTrack1->GetMotherId();
       else prim= 1;
    }
+   fNPrimNeutrons += TMath::Min(nPrimNeutrons, 6);
    
    Double_t sumTotalEnergy=0;   
    for (Int_t l=0;l<nentries;l++){
@@ -470,6 +488,8 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
       }			 
    }
   
+   fTimer.Start(kFALSE);
+   if(!fUseGraph){
    //cout<<"sort hits"<<endl;
    // sort hits for time
    for (Int_t i=0;i<nentries;i++){
@@ -502,6 +522,8 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
          cout<<"pos "<<PM_hit[i].x<<"  "<<PM_hit[i].y<<"  "<<PM_hit[i].z<<endl;
       }           
    }	  
+   } // !fUseGraph
+   fTimer.Stop();
 
    // find clusters and mark the position of the cluster by 
    // time of first hit, position of first hit, and total energy 
@@ -513,6 +535,20 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
    hHits->Fill(nentries);
    if (nentries>0) {
 
+      fTimer.Start(kFALSE);
+      if(fUseGraph){
+         // The digis are time sorted by the graph
+         fGraph->Clear();
+         for (Int_t l=0;l<nentries;l++){
+            R3BLandDigi *land_obj = (R3BLandDigi*) fLandDigi->At(l);
+            fGraph->AddHit(land_obj->GetXX(), land_obj->GetYY(), land_obj->GetZZ(),
+                           land_obj->GetTdc(), land_obj->GetQdc());
+         }
+         fGraph->FindClusters();
+         Nclusters=CopyClusters();
+      }
+      else{
+
       for (Int_t l=0;l<nentries;l++){
          temp[l][0] = PM_hit[l].x;
          temp[l][1] = PM_hit[l].y;  
@@ -601,6 +637,8 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
 
 
       }
+      } // fUseGraph
+      fTimer.Stop();
 
       cout<< "number of clusters: " << Nclusters  <<  endl;
       hClusters->Fill(Nclusters);
@@ -626,6 +664,14 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
       hClusterSize->Fill(Nclusters/MaxSize);	
 //      hClusterEnergy->Fill(MaxEnergy);	
 
+      fTimer.Start(kFALSE);
+      if(fUseGraph){
+         // Kinematics only for the cluster pairs which can be connected
+         // by the time of flight
+         Nclusters=fGraph->RemoveElastic();
+         CopyClusters();
+      }
+      else{
       Double_t x0=0.;
       Double_t y0=0.;
       Double_t z0=0.;
@@ -1028,6 +1074,8 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
          }
 	 
       }
+      } // fUseGraph
+      fTimer.Stop();
 //      cout<< "number of clusters: " << Nclusters  <<  endl;
       hClusters1->Fill(Nclusters);
 
@@ -1062,6 +1110,13 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
       }
       Double_t dt,dr;
 
+      fTimer.Start(kFALSE);
+      if(fUseGraph){
+         fGraph->SetBeam(beamEnergy, beamBeta);
+         Nclusters=fGraph->SelectClusters();
+         CopyClusters();
+      }
+      else{
       // From the sum energy we know best how many neutrons there are. 
       // Now we have to find the correct position and time for them
       // we sort according to closest beta compared to beam
@@ -1222,6 +1277,8 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
          temp[index][4] = 1.;
 
       }
+      } // fUseGraph
+      fTimer.Stop();
 
 /*
       // we sort then according to cluster energy
@@ -1475,6 +1532,12 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
 	 sum_momentumY+=momentumY[i];
 	 sum_momentumZ+=momentumZ[i];
 	 sum_masses+=mNeutron;
+
+         // Store the neutron: first and last hit of its cluster
+         AddHit(TVector3(Cluster[i].xStart, Cluster[i].yStart, Cluster[i].zStart),
+                TVector3(Cluster[i].xEnd, Cluster[i].yEnd, Cluster[i].zEnd),
+                TVector3(momentumX[i], momentumY[i], momentumZ[i]),
+                Cluster[i].tStart);
 /*
 	 cout<<"Sum energy " <<sum_energy<<endl;
 	 cout<<"sum momentumX " <<sum_momentumX<<endl;
@@ -1561,6 +1624,7 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
          }
       }
       }
+      MatchTracks(firstHitX, firstHitY, firstHitZ, nPrimNeutrons);
 //******************************************************************
 // Now reconstruction of momenta with first hits
 
@@ -1721,9 +1785,56 @@ void R3BNeutronTracker::Exec(Option_t* opt) {
 void R3BNeutronTracker::Reset(){
 // Clear the structure
 //   cout << " -I- Digit Reset() called " << endl;
-// if (fDigis ) fDigis->Clear();
+   if (fNeutronTracks) fNeutronTracks->Clear();
 }   
 
+Int_t R3BNeutronTracker::CopyClusters(){
+// Copy the clusters of the graph to Cluster. The entries behind the
+// last cluster are copied as well, they are those of the original loops.
+   Int_t nStored = fGraph->GetNStored();
+   if (nStored > fNClusterAlloc){
+      CLUSTER *clusters = new CLUSTER[nStored];
+      for (Int_t i=0;i<fNClusterAlloc;i++) clusters[i] = Cluster[i];
+      delete[] Cluster;
+      Cluster = clusters;
+      fNClusterAlloc = nStored;
+   }
+   for (Int_t i=0;i<nStored;i++){
+      Cluster[i] = fGraph->GetCluster(i);
+   }
+   return fGraph->GetNClusters();
+}
+
+void R3BNeutronTracker::MatchTracks(const Double_t* firstHitX,
+                                    const Double_t* firstHitY,
+                                    const Double_t* firstHitZ,
+                                    Int_t nPrimNeutrons){
+// Count the primary neutrons with a track starting at their first hit,
+// each track is taken once
+   Int_t nTracks = fNeutronTracks->GetEntriesFast();
+   fNTracks += nTracks;
+   std::vector<Bool_t> used(nTracks, kFALSE);
+   for (Int_t i=0;i<TMath::Min(nPrimNeutrons, 6);i++){
+      Int_t closest=-1;
+      Double_t minDis=kMatchDistance;
+      for (Int_t j=0;j<nTracks;j++){
+         if (used[j]) continue;
+         R3BNeutronTrack *track = (R3BNeutronTrack*) fNeutronTracks->At(j);
+         Double_t distance=sqrt((firstHitX[i]-track->GetXIn())*(firstHitX[i]-track->GetXIn())+
+                                (firstHitY[i]-track->GetYIn())*(firstHitY[i]-track->GetYIn())+
+                                (firstHitZ[i]-track->GetZIn())*(firstHitZ[i]-track->GetZIn()));
+         if (distance<minDis){
+            minDis=distance;
+            closest=j;
+         }
+      }
+      if (closest>=0){
+         used[closest]=kTRUE;
+         fNMatched+=1;
+      }
+   }
+}
+
 void R3BNeutronTracker::Finish()
 {
 // here event. write histos
@@ -1772,6 +1883,21 @@ void R3BNeutronTracker::Finish()
    hDelta->Write();
    
    hFirstHitZ->Write();
+
+   Double_t time = fTimer.RealTime();
+   cout << "-I- R3BNeutronTracker: " << (fUseGraph ? "graph" : "original")
+        << " cluster building, " << eventNo << " events" << endl;
+   cout << "-I- R3BNeutronTracker: " << fNPrimNeutrons << " primary neutrons, "
+        << fNTracks << " tracks, " << fNMatched << " found";
+   if (fNPrimNeutrons > 0) {
+      cout << " (" << 100.*fNMatched/fNPrimNeutrons << " %)";
+   }
+   cout << endl;
+   cout << "-I- R3BNeutronTracker: cluster building " << time << " s";
+   if (time > 0.) {
+      cout << ", " << fNPrimNeutrons/time << " neutrons/s";
+   }
+   cout << endl;
 }
 
 R3BNeutronTrack* R3BNeutronTracker::AddHit(TVector3 posIn,
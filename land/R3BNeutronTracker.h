@@ -9,6 +9,8 @@
 #include "R3BLandDigi.h"
 #include "TLorentzVector.h"
 #include "R3BLandFirstHits.h"
+#include "R3BNeutronTrackGraph.h"
+#include "TStopwatch.h"
 
 class TClonesArray;
 class TObjectArray;
@@ -32,11 +34,6 @@ struct NEUT2_HIT
 {
   Double_t x,y,z,t,px,py,pz,p;
 };
-struct CLUSTER
-{
-  Double_t xStart,yStart,zStart,xEnd,yEnd,zEnd,tStart,tStop,e,size;
-};
-
 class R3BNeutronTracker : public FairTask
 {
 
@@ -62,6 +59,17 @@ class R3BNeutronTracker : public FairTask
 
   void UseBeam(Double_t _beam_energy,Double_t _beam_beta);
 
+  /** Build the clusters with R3BNeutronTrackGraph (default) or with
+   ** the original loops. Both give the same clusters and tracks. **/
+  void SetUseGraph(Bool_t useGraph) { fUseGraph = useGraph; }
+
+  /** Counters of the run, for benchmarks **/
+  Int_t    GetNEvents()         const { return eventNo; }
+  Int_t    GetNPrimNeutrons()   const { return fNPrimNeutrons; }
+  Int_t    GetNTracks()         const { return fNTracks; }
+  Int_t    GetNMatched()        const { return fNMatched; }
+  Double_t GetTrackingTime()          { return fTimer.RealTime(); }
+
   private:
   
   TLorentzVector fPosIn, fPosOut;    //!  position
@@ -71,6 +79,10 @@ class R3BNeutronTracker : public FairTask
   R3BNeutronTrack* AddHit(TVector3 pos_in, TVector3 pos_out,
                           TVector3 momOut, Double_t time);
 
+  Int_t CopyClusters();
+  void MatchTracks(const Double_t* firstHitX, const Double_t* firstHitY,
+                   const Double_t* firstHitZ, Int_t nPrimNeutrons);
+
 
   protected:
   // Reused structure from previous
@@ -149,12 +161,21 @@ class R3BNeutronTracker : public FairTask
   NEUT1_HIT *NEUT1_hit;
   NEUT2_HIT *NEUT2_hit;
   CLUSTER *Cluster;
+  Int_t fNClusterAlloc;   // Size of Cluster
+
+  R3BNeutronTrackGraph* fGraph;   //! Graph based cluster building
+  Bool_t fUseGraph;
+
+  TStopwatch fTimer;      //! Time of the cluster and track building
+  Int_t fNPrimNeutrons;   //! Primary neutrons with first hits
+  Int_t fNTracks;         //! Neutron tracks stored
+  Int_t fNMatched;        //! Primary neutrons with a track at their first hit
   
   private:
   virtual void SetParContainers();
 
  
-  ClassDef(R3BNeutronTracker,1);
+  ClassDef(R3BNeutronTracker,2);
   
 };
 
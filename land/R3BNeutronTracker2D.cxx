@@ -43,7 +43,12 @@ bool AuxSortClustersBeta(R3BNeuLandCluster*, R3BNeuLandCluster*);
 
 // -----------------------------------------------------------------------------
 R3BNeutronTracker2D::R3BNeutronTracker2D() :
-  FairTask("R3B NeuLAND Neutron Tracker")
+  FairTask("R3B NeuLAND Neutron Tracker"),
+  fNofTracks(0),
+  fNPrimNeut(0),
+  fNPrimProt(0),
+  fNPrimGamma(0),
+  fNofFrag(0)
 { 
   dio=10.6; //3 times half the diogonal of a paddle
 }
@@ -108,10 +113,10 @@ InitStatus R3BNeutronTracker2D::Init()
   eventNo=0;
   printing=0;
   
-  PRIM_part=new R3BPrimPart*[10];
-  PRIM_prot=new R3BPrimPart*[10];
-  PRIM_frag=new R3BPrimPart*[10];
-  PRIM_gamma=new R3BPrimPart*[10];  
+  PRIM_part.reserve(10);
+  PRIM_prot.reserve(10);
+  PRIM_frag.reserve(10);
+  PRIM_gamma.reserve(10);
      
   CreateHistograms();
 
@@ -188,7 +193,7 @@ void R3BNeutronTracker2D::Exec(Option_t* opt)
     
     if(2112 == particleID) {
       //neutron
-      PRIM_part[fNPrimNeut] = new R3BPrimPart(aTrack1->GetPdgCode(),
+      PRIM_part.push_back(R3BPrimPart(aTrack1->GetPdgCode(),
 					      aTrack1->GetPx()*1000.,
 					      aTrack1->GetPy()*1000.,
 					      aTrack1->GetPz()*1000.,
@@ -196,11 +201,11 @@ void R3BNeutronTracker2D::Exec(Option_t* opt)
 					      aTrack1->GetStartY(),
 					      aTrack1->GetStartZ(),
 					      aTrack1->GetStartT(),
-					      1.0086649, mNeutron);
+					      1.0086649, mNeutron));
       fNPrimNeut += 1;
     } else if(2212 == particleID) {
       //proton
-      PRIM_prot[fNPrimProt] = new R3BPrimPart(aTrack1->GetPdgCode(),
+      PRIM_prot.push_back(R3BPrimPart(aTrack1->GetPdgCode(),
 					      aTrack1->GetPx()*1000.,
 					      aTrack1->GetPy()*1000.,
 					      aTrack1->GetPz()*1000.,
@@ -208,11 +213,11 @@ void R3BNeutronTracker2D::Exec(Option_t* opt)
 					      aTrack1->GetStartY(),
 					      aTrack1->GetStartZ(),
 					      aTrack1->GetStartT(),
-					      1.00782503207, 1.00782503207*amu);
+					      1.00782503207, 1.00782503207*amu));
       fNPrimProt += 1;
     } else if(22 == particleID) {
       //gamma
-      PRIM_gamma[fNPrimGamma] = new R3BPrimPart(aTrack1->GetPdgCode(),
+      PRIM_gamma.push_back(R3BPrimPart(aTrack1->GetPdgCode(),
 						aTrack1->GetPx()*1000.,
 						aTrack1->GetPy()*1000.,
 						aTrack1->GetPz()*1000.,
@@ -220,12 +225,12 @@ void R3BNeutronTracker2D::Exec(Option_t* opt)
 						aTrack1->GetStartY(),
 						aTrack1->GetStartZ(),
 						aTrack1->GetStartT(),
-						0., 0.);
+						0., 0.));
       fNPrimGamma += 1;
     } else{
       //fragment
       Double_t A = aTrack1->GetMass();
-      PRIM_frag[fNofFrag] = new R3BPrimPart(aTrack1->GetPdgCode(),
+      PRIM_frag.push_back(R3BPrimPart(aTrack1->GetPdgCode(),
 					    aTrack1->GetPx()*1000.,
 					    aTrack1->GetPy()*1000.,
 					    aTrack1->GetPz()*1000.,
@@ -233,7 +238,7 @@ void R3BNeutronTracker2D::Exec(Option_t* opt)
 					    aTrack1->GetStartY(),
 					    aTrack1->GetStartZ(),
 					    aTrack1->GetStartT(),
-					    A, A*amu);
+					    A, A*amu));
       fNofFrag += 1;
     }
   }
@@ -326,16 +331,13 @@ Int_t R3BNeutronTracker2D::AdvancedMethod()
   SortClustersBeta();
 
   Int_t nOutput = 0;
-  Bool_t mapUsed[3000];
-  for(Int_t i = 0; i < 3000; i++) {
-    mapUsed[i] = kFALSE;
-  }
+  fMapUsed.assign(fNofClusters1, kFALSE);
   for(Int_t i = 0; i < nNeut; i++) {
     for(Int_t ic = 0; ic < fNofClusters1; ic++) {
       cluster = fVectorCluster.at(ic);
 
       // Skip found clusters
-      if(mapUsed[ic]) {
+      if(fMapUsed[ic]) {
   	continue;
       }
 
@@ -353,10 +355,11 @@ Int_t R3BNeutronTracker2D::AdvancedMethod()
       }
 
       // Create neutron track
-      fTracks[fNofTracks][0] = ic;
-      mapUsed[ic] = kTRUE;
-      fNofHits[fNofTracks] += 1;
-      fMapTracks[fNofTracks] = kTRUE;
+      if(fNofTracks == (Int_t)fTracks.size()) {
+	fTracks.resize(fNofTracks+1);
+      }
+      fTracks[fNofTracks].push_back(ic);
+      fMapUsed[ic] = kTRUE;
       new ((*fNeutHits)[fNofTracks]) R3BNeutHit(pos.X(),
 						pos.Y(),
 						pos.Z(),
@@ -761,7 +764,7 @@ void R3BNeutronTracker2D::CalculateMassInv()
 
   for (Int_t i = 0; i < fNPrimNeut; i++) {
     TVector3 mom;
-    PRIM_part[i]->Momentum(mom);
+    PRIM_part[i].Momentum(mom);
     Double_t momentumZ = mom.Z();
     Double_t momentumX = mom.X();
     Double_t momentumY = mom.Y();
@@ -891,28 +894,28 @@ void R3BNeutronTracker2D::CalculateMassInv()
   // fragment: This information have to come later from the Tracker
   if(fNofFrag > 0) {
     TVector3 momF;
-    PRIM_frag[0]->Momentum(momF);
+    PRIM_frag[0].Momentum(momF);
     Double_t beta_frag=momF.Mag()/sqrt(momF.Mag2()+
-				       PRIM_frag[0]->GetM()*PRIM_frag[0]->GetM());
+				       PRIM_frag[0].GetM()*PRIM_frag[0].GetM());
     Double_t gamma_frag=1./sqrt(1.-beta_frag*beta_frag);
-    Double_t energy_frag = gamma_frag*PRIM_frag[0]->GetM();
+    Double_t energy_frag = gamma_frag*PRIM_frag[0].GetM();
     sum_energy += energy_frag;
     sum_momentumX += momF.X();
     sum_momentumY += momF.Y();
     sum_momentumZ += momF.Z();
-    sum_masses += PRIM_frag[0]->GetM();
+    sum_masses += PRIM_frag[0].GetM();
     sum_energy_tr += energy_frag;
     sum_momentumX_tr += momF.X();
     sum_momentumY_tr += momF.Y();
     sum_momentumZ_tr += momF.Z();
-    sum_masses_tr += PRIM_frag[0]->GetM();
+    sum_masses_tr += PRIM_frag[0].GetM();
   }
 
 
   // Gamma
   TVector3 momGamma;
   for(Int_t ig = 0; ig < fNPrimGamma; ig++) {
-    PRIM_gamma[ig]->Momentum(momGamma);
+    PRIM_gamma[ig].Momentum(momGamma);
     sum_energy += momGamma.Mag();      
     sum_momentumX += momGamma.X();
     sum_momentumY += momGamma.Y();
@@ -943,41 +946,30 @@ void R3BNeutronTracker2D::CalculateMassInv()
 void R3BNeutronTracker2D::CalculateExce()
 {
   TVector3 mom1;
-  TVector3 mom2;
   Double_t en_g = 0;
   for(Int_t i = 0; i < fNPrimGamma; i++) {
-    PRIM_gamma[i]->Momentum(mom1);
+    PRIM_gamma[i].Momentum(mom1);
     en_g += mom1.Mag();
   }
 
+  // Only the first proton is used, and the last neutron is left out
   Int_t N = fNofFrag + fNPrimProt + fNPrimNeut - 1;   // !!!!!!!!!!!!! FIXME
-  R3BPrimPart* p[30];
+  Int_t nProt = TMath::Min(1, fNPrimProt);            // !!!!!!!!!!!!! FIXME
 
-  Int_t ii = 0;
+  fExceParts.clear();
   for(Int_t i = 0; i < fNofFrag; i++) {
-    p[ii] = PRIM_frag[i];
-    ii += 1;
+    fExceParts.push_back(&PRIM_frag[i]);
   }
-  for(Int_t i = 0; i < 1/*fNPrimProt*/; i++) {    // !!!!!!!!!!!!! FIXME
-    p[ii] = PRIM_prot[i];
-    ii += 1;
+  for(Int_t i = 0; i < nProt; i++) {
+    fExceParts.push_back(&PRIM_prot[i]);
   }
+  Int_t ii = fExceParts.size();
   for(Int_t i = 0; i < fNPrimNeut; i++) {
-    p[ii] = PRIM_part[i];
-    ii += 1;
+    fExceParts.push_back(&PRIM_part[i]);
   }
 
   // MC truth - ideal neutron reconstruction -------------------------
-  Double_t sum_mc = 0.;
-  for(Int_t i = 0; i < N; i++) {
-    p[i]->Momentum(mom1);
-    for(Int_t j = 0; j < N; j++) {
-      p[j]->Momentum(mom2);
-      sum_mc += p[i]->GetGamma()*p[j]->GetGamma()*
-	p[i]->GetM()*p[j]->GetM()*
-	(1. - p[i]->GetBeta()*p[j]->GetBeta()*cos(mom1.Angle(mom2)));
-    }
-  }
+  Double_t sum_mc = MassInv2(fExceParts, N);
   // Double_t m_proj = 135.939300*amu;
   Double_t m_proj = 2.0141017778*amu;
   fExceTrue = sqrt(sum_mc) + en_g - m_proj;
@@ -991,16 +983,7 @@ void R3BNeutronTracker2D::CalculateExce()
   }
 
   N = fNofFrag + fNPrimProt + fNofTracks - 1;   // !!!!!!!!!!!!! FIXME
-  ii = 0;
-  for(Int_t i = 0; i < fNofFrag; i++) {
-    p[ii] = PRIM_frag[i];
-    ii += 1;
-  }
-  for(Int_t i = 0; i < 1/*fNPrimProt*/; i++) {   // !!!!!!!!!!!!! FIXME
-    p[ii] = PRIM_prot[i];
-    ii += 1;
-  }
-  Int_t k = ii;
+  fRecoNeut.clear();
   for(Int_t i = 0; i < fNofTracks; i++) {
     R3BNeuLandCluster *c1 = fVectorCluster.at(fTracks[i][0]);
     TVector3 pos;
@@ -1014,25 +997,16 @@ void R3BNeutronTracker2D::CalculateExce()
     Double_t momZ = momT*cos(TMath::ATan2(rr, pos.Z()));
     Double_t momX = momZ*pos.X()/pos.Z();
     Double_t momY = momZ*pos.Y()/pos.Z();
-    p[k] = new R3BPrimPart(2112, momX, momY, momZ,
-			   0., 0., 0., 0.,
-			   1.0086649, mNeutron);
-    k += 1;
+    fRecoNeut.push_back(R3BPrimPart(2112, momX, momY, momZ,
+				    0., 0., 0., 0.,
+				    1.0086649, mNeutron));
   }
-  Double_t sum = 0.;
-  for(Int_t i = 0; i < N; i++) {
-    p[i]->Momentum(mom1);
-    for(Int_t j = 0; j < N; j++) {
-      p[j]->Momentum(mom2);
-      sum += p[i]->GetGamma()*p[j]->GetGamma()*
-	p[i]->GetM()*p[j]->GetM()*
-	(1. - p[i]->GetBeta()*p[j]->GetBeta()*cos(mom1.Angle(mom2)));
-    }
+  fExceParts.resize(ii);
+  for(Int_t i = 0; i < fNofTracks; i++) {
+    fExceParts.push_back(&fRecoNeut[i]);
   }
+  Double_t sum = MassInv2(fExceParts, N);
   fExce = sqrt(sum) + en_g - m_proj;
-  for(Int_t i = ii; i < N; i++) {
-    delete p[i];
-  }
   // -----------------------------------------------------------------
 }
 // -----------------------------------------------------------------------------
@@ -1041,19 +1015,44 @@ void R3BNeutronTracker2D::CalculateExce()
 
 
 // -----------------------------------------------------------------------------
-void R3BNeutronTracker2D::Reset()
+Double_t R3BNeutronTracker2D::MassInv2(const std::vector<const R3BPrimPart*>& parts,
+				       Int_t n) const
 {
-  for(Int_t i = 0; i < fNPrimNeut; i++) {
-    delete PRIM_part[i];
-  }
-  for(Int_t i = 0; i < fNPrimProt; i++) {
-    delete PRIM_prot[i];
-  }
-  for(Int_t i = 0; i < fNPrimGamma; i++) {
-    delete PRIM_gamma[i];
+  // Square of the invariant mass of the first n particles from the sum of
+  // their four-momenta, (sum E)^2 - (sum p)^2. This is the same as the sum
+  // over all pairs of gamma_i*gamma_j*m_i*m_j*(1 - beta_i*beta_j*cos(angle_ij)).
+  n = TMath::Min(n, (Int_t)parts.size());
+  Double_t sumE = 0.;
+  Double_t sumPx = 0.;
+  Double_t sumPy = 0.;
+  Double_t sumPz = 0.;
+  TVector3 mom;
+  for(Int_t i = 0; i < n; i++) {
+    parts[i]->Momentum(mom);
+    sumE += sqrt(mom.Mag2() + parts[i]->GetM2());
+    sumPx += mom.X();
+    sumPy += mom.Y();
+    sumPz += mom.Z();
   }
-  for(Int_t i = 0; i < fNofFrag; i++) {
-    delete PRIM_frag[i];
+  return sumE*sumE - (sumPx*sumPx + sumPy*sumPy + sumPz*sumPz);
+}
+// -----------------------------------------------------------------------------
+
+
+
+
+// -----------------------------------------------------------------------------
+void R3BNeutronTracker2D::Reset()
+{
+  // Particles and tracks are cleared, but keep their storage for the next event
+  PRIM_part.clear();
+  PRIM_prot.clear();
+  PRIM_gamma.clear();
+  PRIM_frag.clear();
+
+  // Reset the neutron tracks of the last event
+  for(Int_t i = 0; i < fNofTracks; i++) {
+    fTracks[i].clear();
   }
 
   fMinvTrue = 0.;
@@ -1073,15 +1072,6 @@ void R3BNeutronTracker2D::Reset()
   if(fVectorCluster.size() > 0) {
     fVectorCluster.clear();
   }
-  
-  // Reset the neutron tracks
-  for(Int_t i = 0; i < 1000; i++) {
-    fMapTracks[i] = kTRUE;
-    for(Int_t k = 0; k < 300; k++) {
-      fTracks[i][k] = -1;
-    }
-    fNofHits[i] = 0;
-  }
 
   fNeutHits->Clear();
 }   
@@ -117,10 +117,13 @@ class R3BNeutronTracker2D : public FairTask
   Double_t cMedia; // speed of light in material in cm/ns
   Double_t calFactor; //calibration factor energy of LAND paddles
   Int_t eventNo;
-  R3BPrimPart **PRIM_part;
-  R3BPrimPart **PRIM_prot;
-  R3BPrimPart **PRIM_frag;
-  R3BPrimPart **PRIM_gamma;
+  // Primary particles of the event, kept between events to reuse the storage
+  std::vector<R3BPrimPart> PRIM_part;   //!
+  std::vector<R3BPrimPart> PRIM_prot;   //!
+  std::vector<R3BPrimPart> PRIM_frag;   //!
+  std::vector<R3BPrimPart> PRIM_gamma;  //!
+  std::vector<R3BPrimPart> fRecoNeut;   //! Reconstructed neutrons (CalculateExce)
+  std::vector<const R3BPrimPart*> fExceParts; //! Particles summed in CalculateExce
 
   Int_t Nclusters;
   Double_t dio;
@@ -135,9 +138,9 @@ class R3BNeutronTracker2D : public FairTask
   std::vector<R3BNeuLandCluster*> fVectorCluster;
   Int_t fNofClusters1;
   Int_t fNofTracks;
-  Int_t fTracks[1000][300];
-  Int_t fNofHits[1000];
-  Bool_t fMapTracks[1000];
+  // Cluster indices per neutron track, only the first fNofTracks are in use
+  std::vector< std::vector<Int_t> > fTracks;  //!
+  std::vector<Bool_t> fMapUsed;               //! Clusters assigned to a track
   Int_t nTemp;
   Int_t nNeut;
   Double_t fMinvTrue;
@@ -160,12 +163,13 @@ class R3BNeutronTracker2D : public FairTask
   Int_t AdvancedMethod();
   void CalculateMassInv();
   void CalculateExce();
+  Double_t MassInv2(const std::vector<const R3BPrimPart*>& parts, Int_t n) const;
   void SortClustersBeta();
   void NextIteration(Int_t curIndex, R3BNeuLandCluster *curClus);
   Bool_t IsElastic(R3BNeuLandCluster *c1, R3BNeuLandCluster *c2);
 
  public: 
-  ClassDef(R3BNeutronTracker2D,1)  
+  ClassDef(R3BNeutronTracker2D,2)  
 };
 
 
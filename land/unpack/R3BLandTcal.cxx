@@ -23,35 +23,45 @@
 
 #include "TClonesArray.h"
 
+#include <algorithm>
+
 R3BLandTcal::R3BLandTcal()
     : FairTask("LandTcal", 1)
     , fNEvents(0)
-    , fMapPar()
+    , fChannelPar()
     , fRawHit(NULL)
     , fPmt(new TClonesArray("R3BLandPmt"))
     , fNPmt(0)
     , fTcalPar(NULL)
     , fTrigger(-1)
-    , fMap17Seen()
-    , fMapStopTime()
-    , fMapStopClock()
+    , fFirstHit(TACQUILA_NUM_GEOM, -1)
+    , fLastHit(TACQUILA_NUM_GEOM, -1)
+    , fNextHit()
     , fClockFreq(1. / TACQUILA_CLOCK_MHZ * 1000.)
+    , fNWrongAddress()
+    , fNWrongChannel()
+    , fNMissingPar()
+    , fNBadTime()
 {
 }
 
 R3BLandTcal::R3BLandTcal(const char* name, Int_t iVerbose)
     : FairTask(name, iVerbose)
     , fNEvents(0)
-    , fMapPar()
+    , fChannelPar()
     , fRawHit(NULL)
     , fPmt(new TClonesArray("R3BLandPmt"))
     , fNPmt(0)
     , fTcalPar(NULL)
     , fTrigger(-1)
-    , fMap17Seen()
-    , fMapStopTime()
-    , fMapStopClock()
+    , fFirstHit(TACQUILA_NUM_GEOM, -1)
+    , fLastHit(TACQUILA_NUM_GEOM, -1)
+    , fNextHit()
     , fClockFreq(1. / TACQUILA_CLOCK_MHZ * 1000.)
+    , fNWrongAddress()
+    , fNWrongChannel()
+    , fNMissingPar()
+    , fNBadTime()
 {
 }
 
@@ -71,12 +81,23 @@ InitStatus R3BLandTcal::Init()
               << FairLogger::endl;
     // fTcalPar->printParams();
     R3BTCalModulePar* par;
+    fChannelPar.assign(fNofPMTs + fNof17, NULL);
     for (Int_t i = 0; i < fTcalPar->GetNumModulePar(); i++)
     {
         par = fTcalPar->GetModuleParAt(i);
-        fMapPar[par->GetModuleId()] = par;
+        if (par->GetModuleId() < 0)
+        {
+            LOG(ERROR) << "R3BLandTcal::Init : wrong module ID: " << par->GetModuleId() << FairLogger::endl;
+            continue;
+        }
+        if (par->GetModuleId() >= (Int_t)fChannelPar.size())
+        {
+            fChannelPar.resize(par->GetModuleId() + 1, NULL);
+        }
+        fChannelPar[par->GetModuleId()] = par;
         par->printParams();
     }
+    fTcalPar->BuildLookup(kFALSE);
 
     FairRootManager* mgr = FairRootManager::Instance();
     if (NULL == mgr)
@@ -142,7 +163,16 @@ void R3BLandTcal::Exec(Option_t* option)
     Int_t gtb;
     Int_t tacAddr;
     Int_t index;
-    Int_t index2;
+
+    // PMT hits are chained per Tacquila index (in input order) as they come.
+    // A stop signal (17-th channel) applies to all earlier PMT hits with the
+    // same index, so the whole event is calibrated in a single pass.
+    std::fill(fFirstHit.begin(), fFirstHit.end(), -1);
+    std::fill(fLastHit.begin(), fLastHit.end(), -1);
+    if ((Int_t)fNextHit.size() < nHits)
+    {
+        fNextHit.resize(nHits);
+    }
 
     for (Int_t ihit = 0; ihit < nHits; ihit++)
     {
@@ -151,24 +181,47 @@ void R3BLandTcal::Exec(Option_t* option)
         {
             continue;
         }
-        if (hit->Is17())
+
+        gtb = hit->GetGtb();
+        tacAddr = hit->GetTacAddr();
+        index = hit->GetSam() * (MAX_TACQUILA_MODULE + 1) * (MAX_TACQUILA_GTB + 1) + gtb * (MAX_TACQUILA_MODULE + 1) +
+                tacAddr;
+        if (index < 0 || index >= TACQUILA_NUM_GEOM)
         {
-            // 17-th channel
-            channel = fNofPMTs + hit->GetGtb() * 20 + hit->GetTacAddr();
+            R3B_LOG_SAMPLED(ERROR, fNWrongAddress) << "R3BLandTcal::Exec : wrong Tacquila address: SAM=" << hit->GetSam()
+                                                   << ", GTB=" << gtb << ", TacAddr=" << tacAddr << FairLogger::endl;
+            continue;
         }
-        else
+
+        if (!hit->Is17())
         {
+            // PMT signal, calibrated when its stop signal arrives
+            fNextHit[ihit] = -1;
+            if (fLastHit[index] < 0)
+            {
+                fFirstHit[index] = ihit;
+            }
+            else
+            {
+                fNextHit[fLastHit[index]] = ihit;
+            }
+            fLastHit[index] = ihit;
             continue;
         }
+
+        // 17-th channel
+        channel = fNofPMTs + gtb * 20 + tacAddr;
         // Convert TDC to [ns]
         if (channel < 0 || channel >= (fNofPMTs + fNof17))
         {
-            LOG(ERROR) << "R3BLandTcal::Exec : wrong hardware channel: " << channel << FairLogger::endl;
+            R3B_LOG_SAMPLED(ERROR, fNWrongChannel) << "R3BLandTcal::Exec : wrong hardware channel: " << channel
+                                                   << FairLogger::endl;
             continue;
         }
         if (!FindChannel(channel, &par))
         {
-            LOG(WARNING) << "R3BLandTcal::Exec : Tcal par not found, channel: " << channel << FairLogger::endl;
+            R3B_LOG_SAMPLED(WARNING, fNMissingPar) << "R3BLandTcal::Exec : Tcal par not found, channel: " << channel
+                                                   << FairLogger::endl;
             continue;
         }
 
@@ -180,65 +233,31 @@ void R3BLandTcal::Exec(Option_t* option)
         }
         if (time < 0. || time > fClockFreq)
         {
-            LOG(ERROR) << "R3BLandTcal::Exec : error in time calibration: ch=" << channel << ", tdc=" << tdc
-                       << ", time=" << time << FairLogger::endl;
+            R3B_LOG_SAMPLED(ERROR, fNBadTime) << "R3BLandTcal::Exec : error in time calibration: ch=" << channel
+                                              << ", tdc=" << tdc << ", time=" << time << FairLogger::endl;
             continue;
         }
 
-        gtb = hit->GetGtb();
-        tacAddr = hit->GetTacAddr();
-        index = hit->GetSam() * (MAX_TACQUILA_MODULE + 1) * (MAX_TACQUILA_GTB + 1) + gtb * (MAX_TACQUILA_MODULE + 1) +
-                tacAddr;
-        if (fMap17Seen.find(index) != fMap17Seen.end() && fMap17Seen[index])
-        {
-            LOG(WARNING) << "R3BLandTcal::Exec : multiple stop signal for: GTB=" << gtb << ", TacAddr=" << tacAddr
-                         << FairLogger::endl;
-            //            continue;
-        }
-        fMap17Seen[index] = kTRUE;
-        fMapStopTime[index] = time;
-        fMapStopClock[index] = hit->GetClock();
-
-        for (Int_t khit = 0; khit < ihit; khit++)
+        for (Int_t khit = fFirstHit[index]; khit >= 0; khit = fNextHit[khit])
         {
             hit2 = (R3BLandRawHitMapped*)fRawHit->At(khit);
-            if (NULL == hit2)
-            {
-                continue;
-            }
 
+            // PMT signal
             iBar = hit2->GetBarId();
             iSide = hit2->GetSide();
-            if (hit2->Is17())
-            {
-                // 17-th channel
-                continue;
-            }
-            else
-            {
-                // PMT signal
-                channel = fNofPMTs / 2 * (iSide - 1) + iBar - 1;
-            }
-
-            gtb = hit2->GetGtb();
-            tacAddr = hit2->GetTacAddr();
-            index2 = hit2->GetSam() * (MAX_TACQUILA_MODULE + 1) * (MAX_TACQUILA_GTB + 1) +
-                     gtb * (MAX_TACQUILA_MODULE + 1) + tacAddr;
-            if (index != index2)
-            {
-                continue;
-            }
+            channel = fNofPMTs / 2 * (iSide - 1) + iBar - 1;
 
             // Convert TDC to [ns]
             if (channel < 0 || channel >= (fNofPMTs + fNof17))
             {
-                LOG(ERROR) << "R3BLandTcal::Exec : wrong hardware channel: " << channel << FairLogger::endl;
+                R3B_LOG_SAMPLED(ERROR, fNWrongChannel) << "R3BLandTcal::Exec : wrong hardware channel: " << channel
+                                                   << FairLogger::endl;
                 continue;
             }
             if (!FindChannel(channel, &par))
             {
-                LOG(DEBUG) << "R3BLandTcal::Exec : Tcal par not found, barId: " << iBar << ", side: " << iSide
-                           << FairLogger::endl;
+                R3B_TRACE(DEBUG) << "R3BLandTcal::Exec : Tcal par not found, barId: " << iBar << ", side: " << iSide
+                                 << FairLogger::endl;
                 continue;
             }
 
@@ -250,25 +269,15 @@ void R3BLandTcal::Exec(Option_t* option)
             }
             if (time2 < 0. || time2 > fClockFreq)
             {
-                LOG(ERROR) << "R3BLandTcal::Exec : error in time calibration: ch=" << channel << ", tdc=" << tdc
-                           << ", time=" << time2 << FairLogger::endl;
+                R3B_LOG_SAMPLED(ERROR, fNBadTime) << "R3BLandTcal::Exec : error in time calibration: ch=" << channel
+                                                  << ", tdc=" << tdc << ", time=" << time2 << FairLogger::endl;
                 continue;
             }
 
-            if (fMap17Seen.find(index2) == fMap17Seen.end())
-            {
-                LOG(ERROR) << "R3BLandTcal::Exec : NO stop signal for: GTB=" << gtb << ", TacAddr=" << tacAddr
-                           << FairLogger::endl;
-                continue;
-            }
-            time2 = time2 - fMapStopTime[index2] + hit2->GetClock() * fClockFreq;
+            time2 = time2 - time + hit2->GetClock() * fClockFreq;
             new ((*fPmt)[fNPmt]) R3BLandPmt(iBar, iSide, time2, hit2->GetQdcData());
             fNPmt += 1;
         }
-
-        fMap17Seen.clear();
-        fMapStopTime.clear();
-        fMapStopClock.clear();
     }
 }
 
@@ -284,20 +293,29 @@ void R3BLandTcal::FinishEvent()
         fPmt->Clear();
         fNPmt = 0;
     }
-    fMap17Seen.clear();
-    fMapStopTime.clear();
-    fMapStopClock.clear();
 
     fNEvents += 1;
 }
 
 void R3BLandTcal::FinishTask()
 {
+    if (fNWrongAddress.GetCount() || fNWrongChannel.GetCount() || fNMissingPar.GetCount() || fNBadTime.GetCount())
+    {
+        LOG(WARNING) << "R3BLandTcal::FinishTask : skipped hits: " << fNWrongAddress.GetCount()
+                     << " wrong Tacquila address, " << fNWrongChannel.GetCount() << " wrong hardware channel, "
+                     << fNMissingPar.GetCount() << " stop signals without Tcal par, " << fNBadTime.GetCount()
+                     << " errors in time calibration" << FairLogger::endl;
+    }
 }
 
 Bool_t R3BLandTcal::FindChannel(Int_t channel, R3BTCalModulePar** par)
 {
-    (*par) = fMapPar[channel];
+    if (channel < 0 || channel >= (Int_t)fChannelPar.size())
+    {
+        (*par) = NULL;
+        return kFALSE;
+    }
+    (*par) = fChannelPar[channel];
     if (NULL == (*par))
     {
         return kFALSE;
@@ -6,10 +6,12 @@
 #ifndef R3BLANDTCAL
 #define R3BLANDTCAL
 
-#include <map>
+#include <vector>
 
 #include "FairTask.h"
 
+#include "R3BTrace.h"
+
 class TClonesArray;
 class R3BTCalModulePar;
 class R3BTCalPar;
@@ -110,7 +112,7 @@ class R3BLandTcal : public FairTask
 
   private:
     Int_t fNEvents;                             /**< Event counter. */
-    std::map<Int_t, R3BTCalModulePar*> fMapPar; /**< Map for matching mdoule ID with parameter container. */
+    std::vector<R3BTCalModulePar*> fChannelPar; /**< Parameter container by module ID, NULL if not calibrated. */
     R3BEventHeader* header;                     /**< Event header. */
     TClonesArray* fRawHit;                      /**< Array with raw items - input data. */
     TClonesArray* fPmt;                         /**< Array with time items - output data. */
@@ -119,10 +121,14 @@ class R3BLandTcal : public FairTask
     Int_t fTrigger;                             /**< Trigger value. */
     Int_t fNofPMTs;                             /**< Number of photomultipliers. */
     Int_t fNof17;                               /**< Number of channels with stop signal. */
-    std::map<Int_t, Bool_t> fMap17Seen;         /**< Map with flag of observed stop signal. */
-    std::map<Int_t, Double_t> fMapStopTime;     /**< Map with value of stop time. */
-    std::map<Int_t, Int_t> fMapStopClock;       /**< Map with value of stop clock. */
+    std::vector<Int_t> fFirstHit;               /**< First PMT hit of the event per Tacquila index. */
+    std::vector<Int_t> fLastHit;                /**< Last PMT hit of the event per Tacquila index. */
+    std::vector<Int_t> fNextHit;                /**< Next PMT hit with the same Tacquila index, per hit. */
     Double_t fClockFreq;                        /**< Clock cycle in [ns]. */
+    R3BLogCounter fNWrongAddress;               //! Hits with a wrong Tacquila address.
+    R3BLogCounter fNWrongChannel;               //! Hits with a wrong hardware channel.
+    R3BLogCounter fNMissingPar;                 //! Stop signals without Tcal parameters.
+    R3BLogCounter fNBadTime;                    //! Hits outside of the clock cycle after calibration.
 
     /**
      * Method for retrieving parameter container for specific module ID.
@@ -17,6 +17,8 @@
 #include "FairRunOnline.h"
 #include "FairLogger.h"
 
+#include "R3BTrace.h"
+
 // Land headers
 #include "R3BLandRawHit.h"
 #include "R3BLandUnpack.h"
@@ -60,7 +62,7 @@ void R3BLandUnpack::Register()
 // DoUnpack: Public method
 Bool_t R3BLandUnpack::DoUnpack(Int_t* data, Int_t size)
 {
-    LOG(DEBUG) << "R3BLandUnpack : Unpacking... size = " << size << FairLogger::endl;
+    R3B_TRACE(DEBUG) << "R3BLandUnpack : Unpacking... size = " << size << FairLogger::endl;
 
     UInt_t l_i = 0;
 
@@ -76,7 +78,7 @@ Bool_t R3BLandUnpack::DoUnpack(Int_t* data, Int_t size)
         UInt_t l_lec = (p1[0] & 0x00f00000) >> 20;
         UInt_t l_da_siz = (p1[0] & 0x000001ff);
 
-        LOG(DEBUG) << "R3BLandUnpack : SAM:" << l_sam_id << ",  GTB:" << l_gtb_id << ",  lec:" << l_lec << ",  size:" << l_da_siz << FairLogger::endl;
+        R3B_TRACE(DEBUG) << "R3BLandUnpack : SAM:" << l_sam_id << ",  GTB:" << l_gtb_id << ",  lec:" << l_lec << ",  size:" << l_da_siz << FairLogger::endl;
 
         l_i += 1;
 
@@ -102,23 +104,23 @@ Bool_t R3BLandUnpack::DoUnpack(Int_t* data, Int_t size)
             {
                 n17 += 1;
             }
-            LOG(DEBUG) << "R3BLandUnpack : TAC ADDR IS " << tac_addr << ",  TAC CH IS " << tac_ch << ",  TAC Data IS " << tac_data << ",  QDC Data IS " << qdc_data
+            R3B_TRACE(DEBUG) << "R3BLandUnpack : TAC ADDR IS " << tac_addr << ",  TAC CH IS " << tac_ch << ",  TAC Data IS " << tac_data << ",  QDC Data IS " << qdc_data
             << FairLogger::endl;
             new ((*fRawData)[fNHits]) R3BLandRawHit(l_sam_id, l_gtb_id, tac_addr, tac_ch, cal, clock, tac_data, qdc_data);
             fNHits++;
         }
 
-        LOG(DEBUG) << "R3BLandUnpack : n17=" << n17 << FairLogger::endl;
+        R3B_TRACE(DEBUG) << "R3BLandUnpack : n17=" << n17 << FairLogger::endl;
     }
 
-    LOG(DEBUG) << "R3BLandUnpack : Number of hits in LAND: " << fNHits << FairLogger::endl;
+    R3B_TRACE(DEBUG) << "R3BLandUnpack : Number of hits in LAND: " << fNHits << FairLogger::endl;
     return kTRUE;
 }
 
 // Reset: Public method
 void R3BLandUnpack::Reset()
 {
-    LOG(DEBUG) << "R3BLandUnpack : Clearing Data Structure" << FairLogger::endl;
+    R3B_TRACE(DEBUG) << "R3BLandUnpack : Clearing Data Structure" << FairLogger::endl;
     fRawData->Clear();
     fNHits = 0;
 }
@@ -59,6 +59,7 @@ InitStatus R3BLosTcal::Init()
         fMapPar[par->GetModuleId()] = par;
         par->printParams();
     }
+    fTcalPar->BuildLookup(kTRUE);
 
     FairRootManager* mgr = FairRootManager::Instance();
     if(NULL == mgr)
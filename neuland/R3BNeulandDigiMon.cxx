@@ -7,12 +7,12 @@
 #include "TClonesArray.h"
 #include "TH1D.h"
 #include "TH2D.h"
-#include "TH3D.h"
 
 #include "FairRootManager.h"
 #include "FairLogger.h"
 
 #include "R3BLandDigi.h"
+#include "R3BNeulandMonPoint.h"
 
 
 R3BNeulandDigiMon::R3BNeulandDigiMon(const Option_t *option) : FairTask("R3B NeuLAND NeulandDigi Monitor")
@@ -28,11 +28,14 @@ R3BNeulandDigiMon::R3BNeulandDigiMon(const Option_t *option) : FairTask("R3B Neu
     } else {
         fIs3DTrackEnabled = false;
     }
+    fPoints = nullptr;
 }
 
 
 R3BNeulandDigiMon::~R3BNeulandDigiMon()
-{}
+{
+    delete fPoints;
+}
 
 
 InitStatus R3BNeulandDigiMon::Init()
@@ -42,14 +45,9 @@ InitStatus R3BNeulandDigiMon::Init()
     fDigis = (TClonesArray *) rm->GetObject("LandDigi");
 
     if (fIs3DTrackEnabled) {
-        // XYZ -> ZXY (side view)
-        fh3 = new TH3D("hDigis", "hDigis", 60, 1400, 1700, 50, -125, 125, 50, -125, 125);
-        fh3->SetTitle("NeuLAND Digis");
-        fh3->GetXaxis()->SetTitle("Z");
-        fh3->GetYaxis()->SetTitle("X");
-        fh3->GetZaxis()->SetTitle("Y");
-
-        rm->Register("NeulandDigiMon", "Digis in NeuLAND", fh3, kTRUE);
+        // Only the digis are stored, not a 3D histogram per event
+        fPoints = new TClonesArray("R3BNeulandMonPoint");
+        rm->Register("NeulandDigiMon", "Digis in NeuLAND", fPoints, kTRUE);
     }
 
     hDepth = new TH1D("hDepth", "Maxial penetration depth", 60, 1400, 1700);
@@ -70,12 +68,11 @@ void R3BNeulandDigiMon::Exec(Option_t *)
     const unsigned int nDigis = fDigis->GetEntries();
 
     if (fIs3DTrackEnabled) {
-        fh3->Reset("ICES");
+        fPoints->Clear();
         R3BLandDigi *digi;
         for (unsigned int i = 0; i < nDigis; i++) {
             digi = (R3BLandDigi *) fDigis->At(i);
-            // XYZ -> ZXY (side view)
-            fh3->Fill(digi->GetZZ(), digi->GetXX(), digi->GetYY(), digi->GetQdc());
+            new((*fPoints)[i]) R3BNeulandMonPoint(digi->GetXX(), digi->GetYY(), digi->GetZZ(), digi->GetQdc());
         }
     }
 
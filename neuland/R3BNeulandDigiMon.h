@@ -5,7 +5,8 @@
  *  Input:  Digis. Should work both on Digis from Monte Carlo simulations
  *          as well as experimental data on digi level.
  *  Output: Soon: Vairous diagrams.
- *          Currently: A 3D scatterplot for each event.
+ *          Currently: With option "3DTRACK", the digis of each event as
+ *          R3BNeulandMonPoints (for R3BNeulandVisualizer).
  */
 
 #ifndef R3BNEULANDDIGIMON_H
@@ -16,7 +17,6 @@
 class TClonesArray;
 class TH1D;
 class TH2D;
-class TH3D;
 
 class R3BNeulandDigiMon : public FairTask {
 public:
@@ -31,7 +31,7 @@ private:
     TClonesArray *fDigis;
 
     Bool_t fIs3DTrackEnabled;
-    TH3D *fh3;
+    TClonesArray *fPoints;
 
     TH1D *hDepth;
     TH1D *hForemostEnergy;
@@ -4,11 +4,27 @@
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <map>
+#include <cstring>
 
+#include "RVersion.h"
 #include "TGeoManager.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TGeoBBox.h"
 #include "TClonesArray.h"
 #include "TMath.h"
 #include "TH1F.h"
+#include "TTree.h"
+#include "TBranch.h"
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+#include "TROOT.h"
+#else
+#include "TThread.h"
+#endif
 
 #include "FairRootManager.h"
 #include "FairRunAna.h"
@@ -23,10 +39,41 @@ inline bool IsHorizontalPaddle(const Int_t paddle, const Int_t paddle_per_plane)
 }
 
 
+namespace {
+// Navigation with gGeoManager changes its state and must not run concurrently
+std::mutex gGeoMutex;
+
+// Centre of the paddle containing a point, by navigation (fallback only)
+void FindPaddleCentre(const Double_t x, const Double_t y, const Double_t z, Double_t centre[3])
+{
+    std::lock_guard<std::mutex> lock(gGeoMutex);
+    gGeoManager->FindNode(x, y, z);
+    gGeoManager->CdUp();
+    Double_t local_point[] = {0., 0., 0.};
+    gGeoManager->LocalToMaster(local_point, centre);
+}
+
+// Seed of an event, decorrelated from the neighbouring events (splitmix64)
+UInt_t EventSeed(const UInt_t seed, const Long64_t eventNumber)
+{
+    ULong64_t z = ((ULong64_t)seed << 32) ^ (ULong64_t)eventNumber;
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    // Seed 0 would make TRandom3 pick a random seed
+    const UInt_t eventSeed = (UInt_t)z;
+    return eventSeed != 0 ? eventSeed : 1;
+}
+}
+
+
 R3BNeulandDigitizer::R3BNeulandDigitizer()
     : FairTask("R3B NeuLAND Digitizer", 0),
       fLandDigi(new TClonesArray("R3BLandDigi")),
-      fDigitizingEngine(new Neuland::DigitizingEngine())
+      fDigitizingEngine(new Neuland::DigitizingEngine()),
+      fSeed(4357),
+      fEventNumber(0)
 {
 }
 
@@ -83,6 +130,9 @@ InitStatus R3BNeulandDigitizer::Init()
     // half of the length of a scintillator
     fPlength = fLandDigiPar->GetPaddleLength(); // [cm]
     fDigitizingEngine->SetPaddleHalfLength(fPlength);
+    fDigitizingEngine->SetNPaddles(npaddles);
+
+    InitPaddleGeometry();
 
     // Initialise control histograms
     hPMl = new TH1F("PM_left", "Arrival times of left PM", 1000, 0., 1000.);
@@ -98,16 +148,97 @@ InitStatus R3BNeulandDigitizer::Init()
 void R3BNeulandDigitizer::Exec(Option_t *)
 {
     Reset();
+    const Histograms histos = {hPMl, hPMr, hMultOne, hMultTwo, hRLTimeToTrig};
+    DigitizeEvent(fLandPoints, fEventNumber++, fDigitizingEngine, fLandDigi, histos);
+
+    if (fVerbose) {
+        LOG(INFO) << "R3BNeulandDigitizer: produced "
+                  << fLandDigi->GetEntries() << " digis" << FairLogger::endl;
+    }
+}
+
+
+void R3BNeulandDigitizer::InitPaddleGeometry()
+{
+    // Orientation as before: the prototype has only vertical paddles,
+    // otherwise the planes alternate
+    const Bool_t proto = fLandDigiPar->GetGeometryFileName().Contains("proto");
+    fPaddleGeometry.assign(npaddles, PaddleGeometry());
+    for (Int_t id = 0; id < npaddles; id++) {
+        fPaddleGeometry[id].horizontal = !proto && IsHorizontalPaddle(id, paddle_per_plane);
+    }
+
+    if (!gGeoManager) {
+        LOG(WARNING) << "R3BNeulandDigitizer: No geometry, paddle positions will be navigated per point"
+                     << FairLogger::endl;
+        return;
+    }
+
+    /* The scintillator (padle_h_box5) is placed in an assembly per paddle, whose
+     * copy number is the paddle number (sector) of the LandPoints */
+    Int_t nFound = 0;
+    TGeoIterator next(gGeoManager->GetTopVolume());
+    TGeoNode *node;
+    TString path;
+    while ((node = next())) {
+        if (strcmp(node->GetVolume()->GetName(), "padle_h_box5") != 0) {
+            continue;
+        }
+        next.GetPath(path);
+        if (!gGeoManager->cd(path)) {
+            continue;
+        }
+
+        // Half length along the longest axis of the scintillator
+        const TGeoBBox *box = (const TGeoBBox *)node->GetVolume()->GetShape();
+        const Double_t halfLength = std::max(box->GetDX(), std::max(box->GetDY(), box->GetDZ()));
+
+        gGeoManager->CdUp();
+        const Int_t id = gGeoManager->GetCurrentNode()->GetNumber() - 1;
+        if (id < 0 || id >= npaddles) {
+            continue;
+        }
+        PaddleGeometry &geo = fPaddleGeometry[id];
+        const Double_t local_point[] = {0., 0., 0.};
+        gGeoManager->LocalToMaster(local_point, geo.centre);
+        geo.halfLength = halfLength;
+        if (!geo.valid) {
+            geo.valid = kTRUE;
+            nFound++;
+        }
+    }
+    gGeoManager->CdTop();
+
+    LOG(INFO) << "R3BNeulandDigitizer: cached geometry of " << nFound << " of " << npaddles - 1
+              << " paddles" << FairLogger::endl;
+    for (Int_t id = 0; id < npaddles; id++) {
+        if (fPaddleGeometry[id].valid && TMath::Abs(fPaddleGeometry[id].halfLength - fPlength) > 0.1) {
+            LOG(WARNING) << "R3BNeulandDigitizer: paddle " << id << " is " << 2. * fPaddleGeometry[id].halfLength
+                         << " cm long in the geometry, but " << 2. * fPlength << " cm in the parameters"
+                         << FairLogger::endl;
+            break;
+        }
+    }
+}
+
+
+void R3BNeulandDigitizer::DigitizeEvent(const TClonesArray *landPoints, Long64_t eventNumber,
+                                        Neuland::DigitizingEngine *engine, TClonesArray *landDigis,
+                                        const Histograms &histos) const
+{
+    engine->Clear();
+    engine->SetSeed(EventSeed(fSeed, eventNumber));
 
-    Double_t xpaddle[npaddles], ypaddle[npaddles], zpaddle[npaddles];
+    // Paddles not found in InitPaddleGeometry, navigated per point
+    std::map<Int_t, TVector3> navigated;
 
 
     /* Look at each Land Point, if it deposited energy in the szintillator,
      * store it with reference to the bar */
-    const UInt_t nLandPoints = fLandPoints->GetEntries();
+    const UInt_t nLandPoints = landPoints->GetEntries();
     R3BLandPoint *landPoint;
     for (UInt_t l = 0; l < nLandPoints; l++) {
-        landPoint = (R3BLandPoint *)fLandPoints->At(l);
+        landPoint = (R3BLandPoint *)landPoints->At(l);
         const Int_t paddle_id = int(landPoint->GetSector()) - 1; //note that paddle starts at 1
 
         Double_t light = landPoint->GetLightYield() * 1000.;
@@ -115,51 +246,42 @@ void R3BNeulandDigitizer::Exec(Option_t *)
 
         if (landPoint->GetEnergyLoss() > 0. && media == 3) {
 
-            // TODO: What is this?
-            gGeoManager->FindNode(landPoint->GetXIn(), landPoint->GetYIn(), landPoint->GetZIn());
-            gGeoManager->CdUp();
-            Double_t local_point[] = {0., 0., 0.};
-            Double_t global_point[3];
-            gGeoManager->LocalToMaster(local_point, global_point);
-            xpaddle[paddle_id] = global_point[0];
-            ypaddle[paddle_id] = global_point[1];
-            zpaddle[paddle_id] = global_point[2];
-
-            Double_t dist;
-            if (fLandDigiPar->GetGeometryFileName().Contains("proto")) {
-                dist = landPoint->GetYIn(); // only vertical paddles
-            } else {
-                if (IsHorizontalPaddle(paddle_id, paddle_per_plane)) {
-                    dist = landPoint->GetXIn();
-                } else {
-                    dist = landPoint->GetYIn();
-                }
+            if (paddle_id < 0 || paddle_id >= npaddles) {
+                Fatal("DigitizeEvent", "Paddle %d out of range", paddle_id + 1);
             }
+            const PaddleGeometry &geo = fPaddleGeometry[paddle_id];
+            if (!geo.valid) {
+                Double_t centre[3];
+                FindPaddleCentre(landPoint->GetXIn(), landPoint->GetYIn(), landPoint->GetZIn(), centre);
+                navigated[paddle_id].SetXYZ(centre[0], centre[1], centre[2]);
+            }
+
+            const Double_t dist = geo.horizontal ? landPoint->GetXIn() : landPoint->GetYIn();
 
             try {
-                fDigitizingEngine->DepositLight(paddle_id, landPoint->GetTime(), light, dist);
+                engine->DepositLight(paddle_id, landPoint->GetTime(), light, dist);
             } catch (std::exception &e) {
-                Fatal("Exec", "%s", e.what());
+                Fatal("DigitizeEvent", "%s", e.what());
             }
 
         } //! eloss
     } //! MC hits
 
 
-    const Double_t triggerTime = fDigitizingEngine->GetTriggerTime();
+    const Double_t triggerTime = engine->GetTriggerTime();
 
 
     /* Fill histograms */
     Int_t multOne = 0;
     Int_t multTwo = 0;
-    for (const auto &kv : fDigitizingEngine->paddles) {
-        const auto &paddle = kv.second;
+    for (const Int_t paddleNr : engine->GetHitPaddleIds()) {
+        const auto &paddle = engine->GetPaddle(paddleNr);
 
         for (const auto &hit : paddle.leftPMT.GetHits()) {
-            hPMl->Fill(hit.time);
+            histos.pmL->Fill(hit.time);
         }
         for (const auto &hit : paddle.rightPMT.GetHits()) {
-            hPMr->Fill(hit.time);
+            histos.pmR->Fill(hit.time);
         }
 
         // Multiplicity if only PMT has fired
@@ -173,41 +295,37 @@ void R3BNeulandDigitizer::Exec(Option_t *)
         // Multiplicity if two PMT have fired
         if (paddle.leftPMT.HasFired() && paddle.rightPMT.HasFired()) {
             multTwo++;
-            hRLTimeToTrig->Fill(paddle.leftPMT.GetTDC() - triggerTime);
-            hRLTimeToTrig->Fill(paddle.rightPMT.GetTDC() - triggerTime);
+            histos.rlTimeToTrig->Fill(paddle.leftPMT.GetTDC() - triggerTime);
+            histos.rlTimeToTrig->Fill(paddle.rightPMT.GetTDC() - triggerTime);
         }
     }
-    hMultOne->Fill(multOne);
-    hMultTwo->Fill(multTwo);
+    histos.multOne->Fill(multOne);
+    histos.multTwo->Fill(multTwo);
 
 
 
-    for (const auto &kv : fDigitizingEngine->paddles) {
-        const Int_t paddleNr = kv.first;
-        const auto &paddle = kv.second;
-
+    for (const Int_t paddleNr : engine->GetHitPaddleIds()) {
+        const auto &paddle = engine->GetPaddle(paddleNr);
         if (paddle.HasFired()) {
 
             // Get position and other information and fill digis.
+            const PaddleGeometry &geo = fPaddleGeometry[paddleNr];
             Double_t xx, yy, zz;
-
-            if (fLandDigiPar->GetGeometryFileName().Contains("proto")) {
-                // vertical paddles
-                xx = xpaddle[paddleNr];
-                yy = paddle.GetPosition();
-                zz = zpaddle[paddleNr];
+            if (geo.valid) {
+                xx = geo.centre[0];
+                yy = geo.centre[1];
+                zz = geo.centre[2];
             } else {
-                if (IsHorizontalPaddle(paddleNr, paddle_per_plane)) {
-                    //horizontal paddles
-                    xx = paddle.GetPosition();
-                    yy = ypaddle[paddleNr];
-                    zz = zpaddle[paddleNr];
-                } else {
-                    // vertical paddles
-                    xx = xpaddle[paddleNr];
-                    yy = paddle.GetPosition();
-                    zz = zpaddle[paddleNr];
-                }
+                const TVector3 &centre = navigated[paddleNr];
+                xx = centre.X();
+                yy = centre.Y();
+                zz = centre.Z();
+            }
+            // The position along the paddle comes from the time difference
+            if (geo.horizontal) {
+                xx = paddle.GetPosition();
+            } else {
+                yy = paddle.GetPosition();
             }
 
             Double_t tdcL = paddle.leftPMT.GetTDC();
@@ -218,19 +336,115 @@ void R3BNeulandDigitizer::Exec(Option_t *)
             Double_t qdc = paddle.GetPaddleEnergy();
             Double_t tdc = paddle.GetPaddleTime();
 
-            new((*fLandDigi)[fLandDigi->GetEntriesFast()]) R3BLandDigi(paddleNr,
+            new((*landDigis)[landDigis->GetEntriesFast()]) R3BLandDigi(paddleNr,
                     tdcL, tdcR, tdc,
                     qdcL, qdcR, qdc,
                     xx, yy, zz);
         }
     } // loop over paddles
+}
 
 
+Long64_t R3BNeulandDigitizer::DigitizeTree(TTree *inTree, TTree *outTree, Int_t nThreads, Long64_t nEvents)
+{
+    TBranch *inBranch = inTree->GetBranch("LandPoint");
+    if (!inBranch) {
+        Error("DigitizeTree", "No LandPoint branch in input tree");
+        return 0;
+    }
+    if (nEvents < 0 || nEvents > inTree->GetEntries()) {
+        nEvents = inTree->GetEntries();
+    }
+    if (nThreads < 1) {
+        nThreads = 1;
+    }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+
+    // One engine and one set of histograms per worker, merged at the end
+    std::vector<Neuland::DigitizingEngine *> engines(nThreads);
+    std::vector<Histograms> histos(nThreads);
+    for (Int_t t = 0; t < nThreads; t++) {
+        engines[t] = new Neuland::DigitizingEngine();
+        engines[t]->SetPaddleHalfLength(fPlength);
+        engines[t]->SetNPaddles(npaddles);
+        histos[t].pmL = (TH1F *)hPMl->Clone();
+        histos[t].pmR = (TH1F *)hPMr->Clone();
+        histos[t].multOne = (TH1F *)hMultOne->Clone();
+        histos[t].multTwo = (TH1F *)hMultTwo->Clone();
+        histos[t].rlTimeToTrig = (TH1F *)hRLTimeToTrig->Clone();
+        for (TH1F *h : {histos[t].pmL, histos[t].pmR, histos[t].multOne, histos[t].multTwo, histos[t].rlTimeToTrig}) {
+            h->SetDirectory(NULL);
+            h->Reset();
+        }
+    }
 
-    if (fVerbose) {
-        LOG(INFO) << "R3BNeulandDigitizer: produced "
-                  << fLandDigi->GetEntries() << " digis" << FairLogger::endl;
+    // Events are read and written in chunks by this thread (ROOT I/O is not
+    // thread-safe), the workers digitize the events of a chunk in between
+    const Long64_t chunkSize = 256 * nThreads;
+    std::vector<TClonesArray *> points(chunkSize), digis(chunkSize);
+    for (Long64_t k = 0; k < chunkSize; k++) {
+        points[k] = new TClonesArray("R3BLandPoint");
+        digis[k] = new TClonesArray("R3BLandDigi");
+    }
+    TBranch *outBranch = outTree->GetBranch("LandDigi");
+    if (!outBranch) {
+        outBranch = outTree->Branch("LandDigi", &digis[0]);
     }
+
+    for (Long64_t first = 0; first < nEvents; first += chunkSize) {
+        const Long64_t n = std::min(chunkSize, nEvents - first);
+        for (Long64_t k = 0; k < n; k++) {
+            inBranch->SetAddress(&points[k]);
+            inBranch->GetEntry(first + k);
+        }
+
+        std::atomic<Long64_t> next(0);
+        std::vector<std::thread> workers;
+        for (Int_t t = 0; t < nThreads; t++) {
+            workers.push_back(std::thread([&, t]() {
+                for (Long64_t k = next++; k < n; k = next++) {
+                    digis[k]->Clear();
+                    DigitizeEvent(points[k], first + k, engines[t], digis[k], histos[t]);
+                }
+            }));
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+
+        for (Long64_t k = 0; k < n; k++) {
+            outBranch->SetAddress(&digis[k]);
+            outTree->Fill();
+        }
+    }
+    inBranch->ResetAddress();
+    outBranch->ResetAddress();
+
+    for (Int_t t = 0; t < nThreads; t++) {
+        hPMl->Add(histos[t].pmL);
+        hPMr->Add(histos[t].pmR);
+        hMultOne->Add(histos[t].multOne);
+        hMultTwo->Add(histos[t].multTwo);
+        hRLTimeToTrig->Add(histos[t].rlTimeToTrig);
+        delete histos[t].pmL;
+        delete histos[t].pmR;
+        delete histos[t].multOne;
+        delete histos[t].multTwo;
+        delete histos[t].rlTimeToTrig;
+        delete engines[t];
+    }
+    for (Long64_t k = 0; k < chunkSize; k++) {
+        delete points[k];
+        delete digis[k];
+    }
+
+    LOG(INFO) << "R3BNeulandDigitizer: digitized " << nEvents << " events on "
+              << nThreads << " threads" << FairLogger::endl;
+    return nEvents;
 }
 
 
@@ -1,6 +1,8 @@
 #ifndef _R3B_NEULAND_DIGITIZER_H_
 #define _R3B_NEULAND_DIGITIZER_H_ 1
 
+#include <vector>
+
 #include "FairTask.h"
 
 #include "R3BLandPoint.h"
@@ -11,6 +13,7 @@
 
 class TClonesArray;
 class TH1F;
+class TTree;
 
 
 class R3BNeulandDigitizer : public FairTask {
@@ -24,7 +27,52 @@ public:
     virtual void Finish();
     virtual void Reset();
 
+    /** Base seed of the random numbers. Every event is digitized with its own
+     ** seed, derived from this one and the event number. **/
+    void SetSeed(UInt_t seed)
+    {
+        fSeed = seed;
+    }
+
+    /** Batch mode: digitize the events of inTree (LandPoint branch) into a
+     ** LandDigi branch of outTree on nThreads worker threads, instead of
+     ** being called per event by the run. The task has to be initialised
+     ** (FairRunAna::Init). Events are written in input order, and the digis
+     ** are the same as in a sequential run with the same seed starting at
+     ** entry 0. Returns the number of digitized events. **/
+    Long64_t DigitizeTree(TTree *inTree, TTree *outTree, Int_t nThreads, Long64_t nEvents = -1);
+
 protected:
+    /** Paddle geometry, cached in Init **/
+    struct PaddleGeometry {
+        Double_t centre[3];   // global position of the paddle centre [cm]
+        Double_t halfLength;  // from the geometry [cm]
+        Bool_t horizontal;    // along x, else along y
+        Bool_t valid;         // found in the geometry
+
+        PaddleGeometry() : halfLength(0.), horizontal(kFALSE), valid(kFALSE)
+        {
+            centre[0] = centre[1] = centre[2] = 0.;
+        }
+    };
+
+    /** Fill fPaddleGeometry from gGeoManager **/
+    void InitPaddleGeometry();
+
+    struct Histograms {
+        TH1F *pmL;
+        TH1F *pmR;
+        TH1F *multOne;
+        TH1F *multTwo;
+        TH1F *rlTimeToTrig;
+    };
+
+    /** Digitize one event with the given engine. Does not touch any other
+     ** state of the task, so it may run concurrently with other engines. **/
+    void DigitizeEvent(const TClonesArray *landPoints, Long64_t eventNumber,
+                       Neuland::DigitizingEngine *engine, TClonesArray *landDigis,
+                       const Histograms &histos) const;
+
     TClonesArray *fLandPoints;
     TClonesArray *fLandDigi;
 
@@ -43,10 +91,15 @@ protected:
     Int_t nplanes;
     Int_t paddle_per_plane;
 
+    std::vector<PaddleGeometry> fPaddleGeometry; //! by paddle id
+
+    UInt_t fSeed;
+    Long64_t fEventNumber;
+
 private:
     virtual void SetParContainers();
 
-    ClassDef(R3BNeulandDigitizer, 1)
+    ClassDef(R3BNeulandDigitizer, 2)
 };
 
 #endif //_R3B_NEULAND_DIGITIZER_H_
\ No newline at end of file
@@ -3,11 +3,13 @@
 #include <iostream>
 #include <string>
 
-#include "TH3D.h"
+#include "TH1D.h"
 
 #include "FairRootManager.h"
 #include "FairLogger.h"
 
+#include "R3BNeulandMonPoint.h"
+
 
 
 R3BNeulandMCMon::R3BNeulandMCMon(const Option_t *option) : FairTask("R3B NeuLAND Neuland Monte Carlo Monitor")
@@ -23,11 +25,14 @@ R3BNeulandMCMon::R3BNeulandMCMon(const Option_t *option) : FairTask("R3B NeuLAND
     } else {
         fIs3DTrackEnabled = false;
     }
+    fPoints = nullptr;
 }
 
 
 R3BNeulandMCMon::~R3BNeulandMCMon()
-{}
+{
+    delete fPoints;
+}
 
 
 InitStatus R3BNeulandMCMon::Init()
@@ -46,14 +51,9 @@ InitStatus R3BNeulandMCMon::Init()
     fhPrimaryDaughterIDs = new TH1D("hprimary_daughter_IDs", "IDs of tracks with a primary mother", 6001, -1, 6000);
 
     if (fIs3DTrackEnabled) {
-        // XYZ -> ZXY (side view)
-        fh3 = new TH3D("hMCTracks", "hMCTracks", 60, 1400, 1700, 50, -125, 125, 50, -125, 125);
-        fh3->SetTitle("NeuLAND MCTracks");
-        fh3->GetXaxis()->SetTitle("Z");
-        fh3->GetYaxis()->SetTitle("X");
-        fh3->GetZaxis()->SetTitle("Y");
-
-        rm->Register("NeulandMCMon", "MC Tracks in NeuLAND", fh3, kTRUE);
+        // Only the track start points are stored, not a 3D histogram per event
+        fPoints = new TClonesArray("R3BNeulandMonPoint");
+        rm->Register("NeulandMCMon", "MC Tracks in NeuLAND", fPoints, kTRUE);
     }
 
     return kSUCCESS;
@@ -164,15 +164,13 @@ void R3BNeulandMCMon::Exec(Option_t *)
         // For 3D Vis
         const UInt_t nTracks = fMCTracks->GetEntries();
         R3BMCTrack *mcTrack;
-        fh3->Reset("ICES");
+        fPoints->Clear();
         for (UInt_t i = 0; i < nTracks; i++) {
             mcTrack = (R3BMCTrack *)fMCTracks->At(i);
             if (mcTrack->GetMotherId() != -1) {
-                if (mcTrack->GetNPoints(kLAND) > 0) {
-                    fh3->Fill(mcTrack->GetStartZ(), mcTrack->GetStartX(), mcTrack->GetStartY(), GetKineticEnergy(mcTrack));
-                } else {
-                    fh3->Fill(mcTrack->GetStartZ(), mcTrack->GetStartX(), mcTrack->GetStartY(), -1.*GetKineticEnergy(mcTrack));
-                }
+                // Tracks without LandPoints are marked by a negative energy
+                const Double_t e = mcTrack->GetNPoints(kLAND) > 0 ? GetKineticEnergy(mcTrack) : -1.*GetKineticEnergy(mcTrack);
+                new((*fPoints)[fPoints->GetEntriesFast()]) R3BNeulandMonPoint(mcTrack->GetStartX(), mcTrack->GetStartY(), mcTrack->GetStartZ(), e);
             }
         }
     }
@@ -12,6 +12,8 @@
  *          - Total energy of non-neutron tracks in kLAND created by primary neutron interaction(s), by PID
  *          - IDs of tracks with a primary mother
  *          - Distribution of track mother IDs
+ *          With option "3DTRACK", the start points of the secondary tracks of each event as
+ *          R3BNeulandMonPoints (for R3BNeulandVisualizer).
  */
 
 #ifndef R3BNEULANDMCMON_H
@@ -24,7 +26,6 @@
 #include <map>
 
 class TH1D;
-class TH3D;
 
 class R3BNeulandMCMon : public FairTask {
 public:
@@ -51,7 +52,7 @@ private:
     std::map<Int_t, TH1D *> fhmEPdg;
     std::map<Int_t, TH1D *> fhmEtotPdg;
     std::map<Int_t, TH1D *> fhmEtotPdgRel;
-    TH3D *fh3;
+    TClonesArray *fPoints;
 
     // TODO: Thats not the business of this class, should be in R3BMCTrack
     // Note: Reference to the pointer to R3BMCTrack so it can be changed within the function
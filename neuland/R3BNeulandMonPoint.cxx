@@ -0,0 +1,3 @@
+#include "R3BNeulandMonPoint.h"
+
+ClassImp(R3BNeulandMonPoint)
@@ -0,0 +1,35 @@
+/** Neuland Monitor Point
+ *
+ *  A single point of the per-event 3D view written by R3BNeulandDigiMon
+ *  (digi position and energy) and R3BNeulandMCMon (track start position
+ *  and kinetic energy). Only the points of an event are stored, the 3D
+ *  histogram is built from them by R3BNeulandVisualizer when needed.
+ */
+
+#ifndef R3BNEULANDMONPOINT_H
+#define R3BNEULANDMONPOINT_H 1
+
+#include "TObject.h"
+
+class R3BNeulandMonPoint : public TObject {
+public:
+    R3BNeulandMonPoint() : fX(0.), fY(0.), fZ(0.), fValue(0.) {}
+    R3BNeulandMonPoint(const Double_t x, const Double_t y, const Double_t z, const Double_t value)
+        : fX(x), fY(y), fZ(z), fValue(value) {}
+
+    Double_t GetX() const { return fX; }
+    Double_t GetY() const { return fY; }
+    Double_t GetZ() const { return fZ; }
+    Double_t GetValue() const { return fValue; }
+
+private:
+    Double32_t fX;
+    Double32_t fY;
+    Double32_t fZ;
+    Double32_t fValue;
+
+    ClassDef(R3BNeulandMonPoint, 1)
+};
+
+
+#endif //R3BNEULANDMONPOINT_H
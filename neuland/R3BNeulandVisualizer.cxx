@@ -1,5 +1,6 @@
 #include "R3BNeulandVisualizer.h"
 
+#include "TClonesArray.h"
 #include "TList.h"
 #include "TF1.h"
 #include "TROOT.h"
@@ -7,6 +8,8 @@
 
 #include <iostream>
 
+#include "R3BNeulandMonPoint.h"
+
 /* This function is required to suppress boxes for empty bins - make them transparent.*/
 static Double_t gEmptyBinSupressor(const Double_t *x, const Double_t *)
 {
@@ -24,8 +27,16 @@ R3BNeulandVisualizer::R3BNeulandVisualizer(const TString &inputFileName, const T
 
     fIndex = 0;
 
-    fh3 = 0;
-    fTree->SetBranchAddress(what, &fh3);
+    fPoints = nullptr;
+    fTree->SetBranchAddress(what, &fPoints);
+
+    // XYZ -> ZXY (side view), refilled from the points of each event
+    fh3 = new TH3D("h" + what, what, 60, 1400, 1700, 50, -125, 125, 50, -125, 125);
+    fh3->SetDirectory(nullptr);
+    fh3->GetXaxis()->SetTitle("Z");
+    fh3->GetYaxis()->SetTitle("X");
+    fh3->GetZaxis()->SetTitle("Y");
+    fh3->GetListOfFunctions()->Add(new TF1("TransferFunction", gEmptyBinSupressor, 0., 1000., 0));
 
     gStyle->SetCanvasPreferGL(kTRUE);
     gStyle->SetOptStat(1111);
@@ -37,6 +48,7 @@ R3BNeulandVisualizer::R3BNeulandVisualizer(const TString &inputFileName, const T
 
 R3BNeulandVisualizer::~R3BNeulandVisualizer()
 {
+    delete fh3;
 }
 
 
@@ -48,9 +60,7 @@ void R3BNeulandVisualizer::Visualize()
     }
 
     fTree->GetEntry(fIndex);
-
-    TList *const lof = fh3->GetListOfFunctions();
-    lof->Add(new TF1("TransferFunction", gEmptyBinSupressor, 0., 1000., 0));
+    FillHistogram();
 
     fCanvas->cd(1);
     fh3->Draw("glcolz");
@@ -68,4 +78,19 @@ void R3BNeulandVisualizer::Visualize()
 }
 
 
+void R3BNeulandVisualizer::FillHistogram()
+{
+    fh3->Reset("ICES");
+    if (!fPoints) {
+        return;
+    }
+    const Int_t nPoints = fPoints->GetEntriesFast();
+    for (Int_t i = 0; i < nPoints; i++) {
+        const R3BNeulandMonPoint *point = (R3BNeulandMonPoint *)fPoints->At(i);
+        // XYZ -> ZXY (side view)
+        fh3->Fill(point->GetZ(), point->GetX(), point->GetY(), point->GetValue());
+    }
+}
+
+
 ClassImp(R3BNeulandVisualizer)
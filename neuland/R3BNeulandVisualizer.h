@@ -6,6 +6,10 @@
 #include "TH3D.h"
 #include "TCanvas.h"
 
+class TClonesArray;
+
+/** Shows the R3BNeulandMonPoints of one event (branch "NeulandDigiMon" or
+ *  "NeulandMCMon", given as what) as 3D histogram and its projections. */
 class R3BNeulandVisualizer {
 public:
     R3BNeulandVisualizer(const TString &input_file, const TString &what);
@@ -25,10 +29,12 @@ public:
 
 protected:
     void Visualize();
+    void FillHistogram();
 
 private:
     TFile *fFile;
     TTree *fTree;
+    TClonesArray *fPoints;
     TH3D *fh3;
     TCanvas *fCanvas;
     UInt_t fIndex;
@@ -32,12 +32,10 @@ if (fLandDigiPar->GetGeometryFileName().Contains("jap")) {
 }*/
 const Double_t DigitizingEngine::fTimeRes = 0.15; // ns
 
-Double_t DigitizingEngine::fPaddleHalfLength = 0.;
-
-TRandom3 *DigitizingEngine::fRnd = new TRandom3();
-
-
 DigitizingEngine::DigitizingEngine()
+    : fPaddleHalfLength(0.),
+      fRnd(),
+      hitPaddleIdsSorted(true)
 {
 }
 
@@ -49,8 +47,8 @@ DigitizingEngine::~DigitizingEngine()
 Double_t DigitizingEngine::GetTriggerTime() const
 {
     Double_t triggerTime = 1e100;
-    for (const auto &kv : paddles) {
-        const Paddle &paddle = kv.second;
+    for (const Int_t id : hitPaddleIds) {
+        const Paddle &paddle = paddles[id];
 
         // TODO: Should be easier with std::min?
         if (paddle.leftPMT.HasFired() && paddle.leftPMT.GetTDC() < triggerTime) {
@@ -68,6 +66,7 @@ Double_t DigitizingEngine::GetTriggerTime() const
 bool DigitizingEngine::PMT::HasFired() const
 {
     if (!cachedFirstHitOverThresh.valid()) {
+        SortHits();
         cachedFirstHitOverThresh.set(FindThresholdExceedingHit());
         cachedQDC.invalidate();
         cachedTDC.invalidate();
@@ -119,7 +118,7 @@ Double_t DigitizingEngine::PMT::GetTDC() const
 Double_t DigitizingEngine::PMT::BuildTDC() const
 {
     if (HasFired()) {
-        return (*cachedFirstHitOverThresh.get()).time + fRnd->Gaus(0., fTimeRes);
+        return (*cachedFirstHitOverThresh.get()).time + engine->fRnd.Gaus(0., fTimeRes);
     } else {
         return -1.;
     }
@@ -138,9 +137,9 @@ Double_t DigitizingEngine::PMT::GetEnergy() const
 Double_t DigitizingEngine::PMT::BuildEnergy() const
 {
     Double_t e;
-    e = GetQDC() * exp((2.*(fPaddleHalfLength)) * fAttenuation / 2.);
+    e = GetQDC() * exp((2.*(engine->fPaddleHalfLength)) * fAttenuation / 2.);
     e = e / (1. + fSaturationCoefficient * e);
-    e = fRnd->Gaus(e, 0.05 * e);
+    e = engine->fRnd.Gaus(e, 0.05 * e);
     return e;
 }
 
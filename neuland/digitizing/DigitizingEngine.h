@@ -17,8 +17,12 @@
  * the left and right side (leftPMT, rightPMT), forming a Paddle. The DE handles these
  * paddles independently by id, without knowledge about physical position or orientation.
  *
+ * All state (paddle length, random generator, paddles) belongs to the engine instance, so
+ * several engines can digitize different events concurrently. Seed the engine per event
+ * (SetSeed) to get results that do not depend on the order in which events are processed.
+ *
  * DigitizingEngine
- *  └ map<id,paddle> paddles
+ *  └ vector<paddle> paddles (indexed by id)
  *
  * Paddle
  *  ├ PMT leftPMT
@@ -33,6 +37,10 @@
  * PMT
  *  └ vector<PMTHit> hits;
  *
+ * All storage is kept between events: Clear() only resets the paddles that were hit, and
+ * the hit buffers keep their capacity. Hits are appended unsorted and sorted by time once,
+ * when the PMT response is first requested.
+ *
  * PMTHit
  *  ├ time
  *  └ light
@@ -40,7 +48,6 @@
  */
 
 #include <vector>
-#include <map>
 #include <algorithm>
 #include <stdexcept>
 #include <cmath>
@@ -61,8 +68,8 @@ protected:
     static const Double_t fLambda;
     static const Double_t fThresh;
     static const Double_t fTimeRes;
-    static Double_t fPaddleHalfLength;
-    static TRandom3 *fRnd;
+    Double_t fPaddleHalfLength;
+    mutable TRandom3 fRnd;
 
 public:
     struct PMTHit {
@@ -76,16 +83,19 @@ public:
 
         /* Calculate the time of arrival and the amount of light that arrives at
          * the PMT based on the deposition in the paddle */
-        PMTHit(const Double_t &mcTime, const Double_t &mcLight, const Double_t &dist)
+        PMTHit(const Double_t &mcTime, const Double_t &mcLight, const Double_t &dist, const Double_t &paddleHalfLength)
         {
-            time = mcTime + (fPaddleHalfLength + dist) / fcMedium;
-            light = mcLight * exp(-fAttenuation * (fPaddleHalfLength + dist));
+            time = mcTime + (paddleHalfLength + dist) / fcMedium;
+            light = mcLight * exp(-fAttenuation * (paddleHalfLength + dist));
         }
     };
 
     class PMT {
     private:
-        std::vector<PMTHit> hits;
+        const DigitizingEngine *engine;
+        // NOTE: Hits are sorted lazily on first read, hence mutable
+        mutable std::vector<PMTHit> hits;
+        mutable bool hitsSorted;
         // NOTE: Some expensive calculations and random distributions are cached
         // so they do not need to be recomputed every time a Getter is called
         mutable Validated<std::vector<PMTHit>::const_iterator> cachedFirstHitOverThresh;
@@ -94,12 +104,30 @@ public:
         mutable Validated<Double_t> cachedEnergy;
 
     public:
+        PMT(const DigitizingEngine *e = NULL) : engine(e), hitsSorted(true) {}
+
         void AddHit(const Double_t &mcTime, const Double_t &mcLight, const Double_t &dist)
         {
-            hits.push_back(PMTHit(mcTime, mcLight, dist));
-            // NOTE: Sorting after every hit may not be efficient, but this way
-            // FindThresholdExeeding hit can be made const
-            std::sort(hits.begin(), hits.end());
+            hits.push_back(PMTHit(mcTime, mcLight, dist, engine->fPaddleHalfLength));
+            hitsSorted = false;
+            cachedFirstHitOverThresh.invalidate();
+        }
+
+        // Remove all hits, but keep the allocated buffer for the next event
+        void Clear()
+        {
+            hits.clear();
+            hitsSorted = true;
+            cachedFirstHitOverThresh.invalidate();
+            cachedQDC.invalidate();
+            cachedTDC.invalidate();
+            cachedEnergy.invalidate();
+        }
+
+        // Forget the cached iterator into hits, e.g. after the PMT was moved
+        // or copied to a new place in memory
+        void InvalidateHitIterator()
+        {
             cachedFirstHitOverThresh.invalidate();
         }
 
@@ -109,10 +137,24 @@ public:
         Double_t GetEnergy() const;
         const std::vector<PMTHit> &GetHits() const
         {
+            SortHits();
             return hits;
         }
 
+        bool HasHits() const
+        {
+            return !hits.empty();
+        }
+
     private:
+        void SortHits() const
+        {
+            if (!hitsSorted) {
+                std::sort(hits.begin(), hits.end());
+                hitsSorted = true;
+            }
+        }
+
         std::vector<PMTHit>::const_iterator FindThresholdExceedingHit() const;
         Double_t BuildQDC() const;
         Double_t BuildTDC() const;
@@ -122,6 +164,9 @@ public:
     struct Paddle {
         PMT leftPMT;
         PMT rightPMT;
+        const DigitizingEngine *engine;
+
+        Paddle(const DigitizingEngine *e = NULL) : leftPMT(e), rightPMT(e), engine(e) {}
 
         Double_t GetPaddleEnergy() const
         {
@@ -130,7 +175,7 @@ public:
 
         Double_t GetPaddleTime() const
         {
-            return (leftPMT.GetTDC() + rightPMT.GetTDC()) / 2. - fPaddleHalfLength / fcMedium;
+            return (leftPMT.GetTDC() + rightPMT.GetTDC()) / 2. - engine->fPaddleHalfLength / fcMedium;
         }
 
         Double_t GetPosition() const
@@ -143,12 +188,45 @@ public:
             return (leftPMT.HasFired() && rightPMT.HasFired());
         }
 
+        void Clear()
+        {
+            leftPMT.Clear();
+            rightPMT.Clear();
+        }
 
+        void InvalidateHitIterators()
+        {
+            leftPMT.InvalidateHitIterator();
+            rightPMT.InvalidateHitIterator();
+        }
     };
 
-public:
-    std::map<Int_t, Paddle> paddles;
+private:
+    // Paddles by id, kept (with their hit buffers) between events
+    std::vector<Paddle> paddles;
+    // Ids of the paddles hit in the current event, sorted on first read
+    mutable std::vector<Int_t> hitPaddleIds;
+    mutable bool hitPaddleIdsSorted;
+
+    // Paddles point back to their engine, so engines must not be copied
+    DigitizingEngine(const DigitizingEngine &);
+    DigitizingEngine &operator=(const DigitizingEngine &);
+
+    // Make ids up to nPaddles - 1 valid. If the paddles are reallocated,
+    // the cached iterators of the paddles hit so far point into the old
+    // storage and have to be rebuilt on the next read.
+    void GrowPaddles(const Int_t &nPaddles)
+    {
+        const Paddle *before = paddles.empty() ? NULL : &paddles[0];
+        paddles.resize(nPaddles, Paddle(this));
+        if (&paddles[0] != before) {
+            for (std::vector<Int_t>::const_iterator it = hitPaddleIds.begin(); it != hitPaddleIds.end(); it++) {
+                paddles[*it].InvalidateHitIterators();
+            }
+        }
+    }
 
+public:
     DigitizingEngine();
     ~DigitizingEngine();
 
@@ -157,10 +235,46 @@ public:
         fPaddleHalfLength = v;
     }
 
+    // Seed the random generator of this engine, e.g. once per event
+    void SetSeed(const UInt_t &seed)
+    {
+        fRnd.SetSeed(seed);
+    }
+
+
+    // Allocate the paddles up front, ids up to nPaddles - 1
+    void SetNPaddles(const Int_t &nPaddles)
+    {
+        if (nPaddles > (Int_t)paddles.size()) {
+            GrowPaddles(nPaddles);
+        }
+    }
+
 
     void Clear()
     {
-        paddles.clear();
+        for (std::vector<Int_t>::const_iterator it = hitPaddleIds.begin(); it != hitPaddleIds.end(); it++) {
+            paddles[*it].Clear();
+        }
+        hitPaddleIds.clear();
+        hitPaddleIdsSorted = true;
+    }
+
+
+    // Ids of the paddles with at least one hit in this event, in ascending order
+    const std::vector<Int_t> &GetHitPaddleIds() const
+    {
+        if (!hitPaddleIdsSorted) {
+            std::sort(hitPaddleIds.begin(), hitPaddleIds.end());
+            hitPaddleIdsSorted = true;
+        }
+        return hitPaddleIds;
+    }
+
+
+    const Paddle &GetPaddle(const Int_t &paddle_id) const
+    {
+        return paddles.at(paddle_id);
     }
 
 
@@ -171,8 +285,19 @@ public:
         if (fPaddleHalfLength == 0.) {
             throw std::invalid_argument("Paddle Legth has not been set");
         }
-        paddles[paddle_id].leftPMT.AddHit(time, light, -1. * dist);
-        paddles[paddle_id].rightPMT.AddHit(time, light, dist);
+        if (paddle_id < 0) {
+            throw std::out_of_range("Negative paddle id");
+        }
+        if (paddle_id >= (Int_t)paddles.size()) {
+            GrowPaddles(paddle_id + 1);
+        }
+        Paddle &paddle = paddles[paddle_id];
+        if (!paddle.leftPMT.HasHits()) {
+            hitPaddleIds.push_back(paddle_id);
+            hitPaddleIdsSorted = false;
+        }
+        paddle.leftPMT.AddHit(time, light, -1. * dist);
+        paddle.rightPMT.AddHit(time, light, dist);
     }
 
 };
@@ -0,0 +1,225 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             * 
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *  
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -----------------------------------------------------------------------------
+// -----                                                                   -----
+// -----                            R3BLmdReader                           -----
+// -----                                                                   -----
+// -----------------------------------------------------------------------------
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+#include "R3BLmdReader.h"
+
+
+struct R3BLmdReader::State
+{
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable notFull;  /**< signalled when a record is released */
+    std::condition_variable notEmpty; /**< signalled when a record is written */
+};
+
+
+R3BLmdReader::R3BLmdReader(const std::vector<std::string>& fileNames, Int_t readAhead)
+  : fFileNames(fileNames),
+    fRing(readAhead < 2 ? 2 : readAhead),
+    fHead(0),
+    fTail(0),
+    fHolding(kFALSE),
+    fStop(kFALSE),
+    fChannel(NULL),
+    fInfoHeader(NULL),
+    fState(new State())
+{
+}
+
+
+R3BLmdReader::~R3BLmdReader()
+{
+  Stop();
+  delete fState;
+}
+
+
+Bool_t R3BLmdReader::Open(Int_t iFile)
+{
+  Int_t inputMode = 1;
+  fChannel = new s_evt_channel;
+  void* headptr = &fInfoHeader;
+  INTS4 status = f_evt_get_open(inputMode,
+                                const_cast<char*>(fFileNames[iFile].c_str()),
+                                fChannel,
+                                (Char_t**)headptr,
+                                1,
+                                1);
+  if(status) {
+    delete fChannel;
+    fChannel = NULL;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+
+void R3BLmdReader::Close()
+{
+  if(fChannel) {
+    f_evt_get_close(fChannel);
+    delete fChannel;
+    fChannel = NULL;
+  }
+}
+
+
+Bool_t R3BLmdReader::Start()
+{
+  if(fFileNames.empty() || ! Open(0)) {
+    return kFALSE;
+  }
+
+  // The ring is empty, the file header never waits
+  Record* record = Reserve();
+  record->type = kFileHeader;
+  record->fileIndex = 0;
+  record->data.assign((char*)fInfoHeader, (char*)fInfoHeader + sizeof(s_filhe));
+  Commit();
+
+  fState->thread = std::thread(&R3BLmdReader::Run, this);
+  return kTRUE;
+}
+
+
+void R3BLmdReader::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(fState->mutex);
+    fStop = kTRUE;
+  }
+  fState->notFull.notify_all();
+  fState->notEmpty.notify_all();
+  if(fState->thread.joinable()) {
+    fState->thread.join();
+  }
+  Close();
+}
+
+
+R3BLmdReader::Record* R3BLmdReader::Next()
+{
+  std::unique_lock<std::mutex> lock(fState->mutex);
+  if(fHolding) {
+    Record* held = &fRing[fTail % fRing.size()];
+    if(kEnd == held->type || kError == held->type) {
+      return held;
+    }
+    fTail += 1;
+    fHolding = kFALSE;
+    fState->notFull.notify_one();
+  }
+  while(fHead == fTail && ! fStop) {
+    fState->notEmpty.wait(lock);
+  }
+  if(fHead == fTail) {
+    return NULL;
+  }
+  fHolding = kTRUE;
+  return &fRing[fTail % fRing.size()];
+}
+
+
+R3BLmdReader::Record* R3BLmdReader::Reserve()
+{
+  std::unique_lock<std::mutex> lock(fState->mutex);
+  while(fHead - fTail >= (Long64_t)fRing.size() && ! fStop) {
+    fState->notFull.wait(lock);
+  }
+  if(fStop) {
+    return NULL;
+  }
+  // Not visible to the consumer before Commit(), can be filled unlocked
+  return &fRing[fHead % fRing.size()];
+}
+
+
+void R3BLmdReader::Commit()
+{
+  {
+    std::lock_guard<std::mutex> lock(fState->mutex);
+    fHead += 1;
+  }
+  fState->notEmpty.notify_one();
+}
+
+
+void R3BLmdReader::Run()
+{
+  Int_t iFile = 0;
+  s_bufhe lastBuffer;
+  memset(&lastBuffer, 0, sizeof(s_bufhe));
+
+  while(kTRUE) {
+    s_ve10_1* event = NULL;
+    s_bufhe* buffer = NULL;
+    void* evtptr = &event;
+    void* buffptr = &buffer;
+    Int_t status = f_evt_get_event(fChannel, (INTS4**)evtptr, (INTS4**)buffptr);
+
+    Record* record = Reserve();
+    if(NULL == record) {
+      return;
+    }
+    record->fileIndex = iFile;
+
+    if(GETEVT__SUCCESS == status) {
+      // Event header (l_dlen, i_type, i_subtype) plus l_dlen 16-bit words
+      size_t size = sizeof(INTS4) + 2 * sizeof(INTS2) + 2 * (size_t)event->l_dlen;
+      record->type = kEvent;
+      memcpy(&record->buffer, buffer, sizeof(s_bufhe));
+      record->data.resize(size);
+      memcpy(&record->data[0], event, size);
+      lastBuffer = record->buffer;
+      Commit();
+      continue;
+    }
+
+    if(GETEVT__NOMORE != status) {
+      cerr << "-W- R3BLmdReader::Run : error " << status << " while reading file "
+           << fFileNames[iFile] << ", skipping the rest of it." << endl;
+    }
+    record->type = kFileEnd;
+    record->buffer = lastBuffer;
+    record->data.clear();
+    Commit();
+    Close();
+
+    iFile += 1;
+    record = Reserve();
+    if(NULL == record) {
+      return;
+    }
+    record->fileIndex = iFile;
+    record->data.clear();
+    if(iFile >= (Int_t)fFileNames.size()) {
+      record->type = kEnd;
+      Commit();
+      return;
+    }
+    if(! Open(iFile)) {
+      record->type = kError;
+      Commit();
+      return;
+    }
+    record->type = kFileHeader;
+    record->data.assign((char*)fInfoHeader, (char*)fInfoHeader + sizeof(s_filhe));
+    Commit();
+  }
+}
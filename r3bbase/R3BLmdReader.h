@@ -0,0 +1,112 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             * 
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *  
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -----------------------------------------------------------------------------
+// -----                                                                   -----
+// -----                            R3BLmdReader                           -----
+// -----                                                                   -----
+// -----------------------------------------------------------------------------
+
+#ifndef R3BLmdReader_H
+#define R3BLmdReader_H
+
+extern "C"
+{
+#include "f_evt.h"
+#include "s_filhe_swap.h"
+#include "s_bufhe_swap.h"
+}
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Reads a list of LMD files on a background thread.
+ * Events are copied once from the MBS buffers into a ring of
+ * records, so that the reader can run ahead of the unpacking.
+ * The record storage is reused, no memory is allocated once
+ * the ring has reached the size of the largest events.
+ *
+ * Records are returned in file order: the file header, the
+ * events of the file, the end of the file, then the next file.
+ * A record stays valid until the next call to Next(). Its data
+ * may be swapped out by the caller to keep an event longer.
+ */
+class R3BLmdReader
+{
+  public:
+    enum ERecordType
+    {
+        kFileHeader, /**< data holds the s_filhe of a newly opened file */
+        kEvent,      /**< data holds the event (s_ve10_1 and subevents) */
+        kFileEnd,    /**< end of a file, buffer holds its last buffer header */
+        kEnd,        /**< all files are read */
+        kError       /**< a file could not be opened or read */
+    };
+
+    struct Record
+    {
+        Int_t type;
+        Int_t fileIndex;         /**< index of the file in the list */
+        s_bufhe buffer;          /**< header of the buffer containing the event */
+        std::vector<char> data;  /**< raw data, see ERecordType */
+
+        inline s_ve10_1* GetEvent() { return (s_ve10_1*)&data[0]; }
+    };
+
+    /**
+     * @param fileNames list of LMD files.
+     * @param readAhead maximum number of records read in advance.
+     */
+    R3BLmdReader(const std::vector<std::string>& fileNames, Int_t readAhead = 1024);
+    virtual ~R3BLmdReader();
+
+    /**
+     * Opens the first file and starts the background thread.
+     * @return kFALSE if the first file cannot be opened.
+     */
+    Bool_t Start();
+
+    /**
+     * Releases the previous record and waits for the next one.
+     * After kEnd or kError, the same record is returned again.
+     */
+    Record* Next();
+
+    /**
+     * Stops the background thread and closes the current file.
+     */
+    void Stop();
+
+  private:
+    struct State;
+
+    R3BLmdReader(const R3BLmdReader&);
+    R3BLmdReader& operator=(const R3BLmdReader&);
+
+    Bool_t Open(Int_t iFile);
+    void Close();
+    void Run();
+    Record* Reserve();
+    void Commit();
+
+    std::vector<std::string> fFileNames;
+    std::vector<Record> fRing;   /**< records, used as a ring buffer */
+    Long64_t fHead;              /**< number of records written */
+    Long64_t fTail;              /**< number of records released */
+    Bool_t fHolding;             /**< caller holds record fTail */
+    Bool_t fStop;                /**< stop request for the background thread */
+    s_evt_channel* fChannel;     /**< open MBS input channel or NULL */
+    s_filhe* fInfoHeader;        /**< file header of the open file */
+    State* fState;               /**< thread and synchronisation */
+};
+
+
+#endif
@@ -10,18 +10,33 @@
 // -----                            R3BLmdSource                           -----
 // -----                    Created 27.02.2015 by D.Kresan                 -----
 // -----------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
 using namespace std;
 
+#include "RVersion.h"
+
 #include "TList.h"
 #include "TObjString.h"
 #include "TClonesArray.h"
 #include "TH1F.h"
 #include "TH2F.h"
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+#include "TROOT.h"
+#else
+#include "TThread.h"
+#endif
 
 #include "FairRootManager.h"
 #include "FairRunOnline.h"
 #include "FairLogger.h"
+#include "FairUnpack.h"
 
 #include "R3BEventHeader.h"
 #include "R3BLandRawHit.h"
@@ -29,13 +44,110 @@ using namespace std;
 #include "R3BLmdSource.h"
 
 
+/**
+ * Persistent worker threads for the sub-events of one event. Run()
+ * executes all tasks, using the calling thread as well, and returns
+ * when every task is done and no worker is active anymore.
+ */
+class R3BLmdSource::UnpackPool
+{
+  public:
+    UnpackPool(Int_t nThreads)
+      : fTask(NULL), fNTasks(0), fNext(0), fDone(0), fActive(0), fGeneration(0), fQuit(kFALSE)
+    {
+      for(Int_t i = 1; i < nThreads; i++) {
+        fThreads.push_back(std::thread(&UnpackPool::Work, this));
+      }
+    }
+
+    ~UnpackPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fQuit = kTRUE;
+      }
+      fStart.notify_all();
+      for(size_t i = 0; i < fThreads.size(); i++) {
+        fThreads[i].join();
+      }
+    }
+
+    void Run(Int_t nTasks, const std::function<void(Int_t)>& task)
+    {
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fTask = &task;
+        fNTasks = nTasks;
+        fNext = 0;
+        fDone = 0;
+        fGeneration += 1;
+      }
+      fStart.notify_all();
+      Execute();
+      std::unique_lock<std::mutex> lock(fMutex);
+      while(fDone < fNTasks || fActive > 0) {
+        fFinished.wait(lock);
+      }
+      fTask = NULL;
+    }
+
+  private:
+    void Execute()
+    {
+      Int_t i;
+      while((i = fNext++) < fNTasks) {
+        (*fTask)(i);
+        std::lock_guard<std::mutex> lock(fMutex);
+        if(++fDone == fNTasks) {
+          fFinished.notify_all();
+        }
+      }
+    }
+
+    void Work()
+    {
+      Long64_t generation = 0;
+      std::unique_lock<std::mutex> lock(fMutex);
+      while(kTRUE) {
+        while(! fQuit && (generation == fGeneration || NULL == fTask)) {
+          fStart.wait(lock);
+        }
+        if(fQuit) {
+          return;
+        }
+        generation = fGeneration;
+        fActive += 1;
+        lock.unlock();
+        Execute();
+        lock.lock();
+        fActive -= 1;
+        if(0 == fActive) {
+          fFinished.notify_all();
+        }
+      }
+    }
+
+    std::vector<std::thread> fThreads;
+    std::mutex fMutex;
+    std::condition_variable fStart;
+    std::condition_variable fFinished;
+    const std::function<void(Int_t)>* fTask;
+    Int_t fNTasks;
+    std::atomic<Int_t> fNext;
+    Int_t fDone;
+    Int_t fActive;
+    Long64_t fGeneration;
+    Bool_t fQuit;
+};
+
+
 R3BLmdSource::R3BLmdSource()
   : FairMbsSource(),
     fEventHeader(NULL),
-    fNeuLandHits(NULL),
-    fCalifaHits(NULL),
-    fBufHeader(new R3BEventHeader()),
-    fBufNeuLand(new TClonesArray("R3BLandRawHit")),
+    fBuildBuffer(4096),
+    fEndOfData(kFALSE),
+    fNUnpackThreads(1),
+    fPool(NULL),
     fTSUnit(1),
     fDelayCutLower(250),
     fDelayCutUpper(380),
@@ -43,12 +155,9 @@ R3BLmdSource::R3BLmdSource()
 	fNEvent(0),
     fCurrentEvent(0),
     fFileNames(new TList()),
-    fxInputChannel(NULL),
-    fxEvent(NULL),
-    fxBuffer(NULL),
-    fxEventData(NULL),
-    fxSubEvent(NULL),
-    fxInfoHeader(NULL)
+    fReadAhead(1024),
+    fReader(NULL),
+    fRecord(NULL)
 {
 }
 
@@ -56,29 +165,29 @@ R3BLmdSource::R3BLmdSource()
 R3BLmdSource::R3BLmdSource(const R3BLmdSource& source)
   : FairMbsSource(source),
     fEventHeader(NULL),
-    fNeuLandHits(NULL),
-    fCalifaHits(NULL),
-    fBufHeader(new R3BEventHeader()),
-    fBufNeuLand(new TClonesArray("R3BLandRawHit")),
+    fStreams(source.fStreams),
+    fBuildBuffer(source.fBuildBuffer),
+    fEndOfData(kFALSE),
+    fNUnpackThreads(source.fNUnpackThreads),
+    fPool(NULL),
     fTSUnit(1),
-    fDelayCutLower(250),
-    fDelayCutUpper(380),
+    fDelayCutLower(source.fDelayCutLower),
+    fDelayCutUpper(source.fDelayCutUpper),
     fCurrentFile(source.GetCurrentFile()),
 	fNEvent(0),
     fCurrentEvent(0),
     fFileNames(new TList()),
-    fxInputChannel(NULL),
-    fxEvent(NULL),
-    fxBuffer(NULL),
-    fxEventData(NULL),
-    fxSubEvent(NULL),
-    fxInfoHeader(NULL)
+    fReadAhead(source.fReadAhead),
+    fReader(NULL),
+    fRecord(NULL)
 {
 }
 
 
 R3BLmdSource::~R3BLmdSource()
 {
+  delete fPool;
+  delete fReader;
   fFileNames->Delete();
   delete fFileNames;
 }
@@ -91,9 +200,25 @@ void R3BLmdSource::AddFile(TString fileName)
 }
 
 
+void R3BLmdSource::AddStream(TString branchName, Long64_t windowLower, Long64_t windowUpper, Bool_t required)
+{
+  Stream stream;
+  stream.branch = branchName;
+  stream.lower = windowLower;
+  stream.upper = windowUpper;
+  stream.required = required;
+  stream.subEventTime = kFALSE;
+  stream.hits = NULL;
+  stream.hDelay = NULL;
+  stream.lastTime = 0;
+  stream.unpacker = -1;
+  fStreams.push_back(stream);
+}
+
+
 Bool_t R3BLmdSource::Init()
 {
-  if(! FairMbsSource::Init()) {
+  if(! InitUnpackers()) {
     return kFALSE;
   }
 
@@ -101,12 +226,25 @@ Bool_t R3BLmdSource::Init()
     return kFALSE;
   }
 
-  TString name = ((TObjString*)fFileNames->At(fCurrentFile))->GetString();
-  if(! OpenNextFile(name)) {
+  // Start reading in the background from the current file on
+  std::vector<std::string> names;
+  for(Int_t i = fCurrentFile; i < fFileNames->GetSize(); i++) {
+    names.push_back(((TObjString*)fFileNames->At(i))->GetString().Data());
+  }
+  delete fReader;
+  fReader = new R3BLmdReader(names, fReadAhead);
+  if(! fReader->Start()) {
     return kFALSE;
   }
+  Int_t firstFile = fCurrentFile;
 
-  fCurrentFile += 1;
+  // Decode File Header
+  fRecord = fReader->Next();
+  /*Bool_t result = */Unpack((Int_t*)&fRecord->data[0], sizeof(s_filhe), -4, -4, -4, -4, -4);
+  cout << "-I- R3BLmdSource::Init : file "
+       << names[0] << " opened." << endl;
+
+  fCurrentFile = firstFile + 1;
 
  // Init Counters
   fNEvent=fCurrentEvent=0;
@@ -119,241 +257,432 @@ Bool_t R3BLmdSource::Init()
         return kFALSE;
     }
     
-    fNeuLandHits = (TClonesArray*) rootMgr->GetObject("LandRawHit");
-    if(NULL == fNeuLandHits)
+    // Default: NeuLAND as reference, CALIFA within the maximum delay
+    if(fStreams.empty())
     {
-        return kFALSE;
+        AddStream("LandRawHit");
+        AddStream("CaloRawHit", fDelayCutLower, fDelayCutUpper);
     }
     
-    fCalifaHits = (TClonesArray*) rootMgr->GetObject("CaloRawHit");
-    if(NULL == fCalifaHits)
+    for(size_t i = 0; i < fStreams.size(); i++)
     {
-        return kFALSE;
+        Stream& stream = fStreams[i];
+        stream.hits = (TClonesArray*) rootMgr->GetObject(stream.branch);
+        if(NULL == stream.hits)
+        {
+            cerr << "-E- R3BLmdSource::Init : branch " << stream.branch << " not found." << endl;
+            return kFALSE;
+        }
+        stream.subEventTime = stream.hits->GetClass()->InheritsFrom(R3BCaloRawHit::Class());
+        stream.pending.clear();
+        stream.lastTime = 0;
+        stream.unpacker = -1;
+        for(size_t u = 0; u < fOutputBranches.size() && stream.unpacker < 0; u++)
+        {
+            if(std::find(fOutputBranches[u].begin(), fOutputBranches[u].end(), stream.branch) != fOutputBranches[u].end())
+            {
+                stream.unpacker = u;
+            }
+        }
+        if(stream.unpacker < 0)
+        {
+            cerr << "-E- R3BLmdSource::Init : branch " << stream.branch << " is not registered by an unpacker." << endl;
+            return kFALSE;
+        }
+        if(i > 0)
+        {
+            stream.hDelay = new TH1F("hDelay_" + stream.branch,
+                                     "Delay between " + fStreams[0].branch + " and " + stream.branch,
+                                     1100, -1000., 10000.);
+            FairRunOnline::Instance()->AddObject(stream.hDelay);
+        }
     }
+    fSubEvents.assign(fStreams.size(), std::vector<Int_t>());
+    fStreamTimes.assign(fStreams.size(), 0);
+    fEvents.clear();
+    fFreeEvents.clear();
+    fEndOfData = kFALSE;
     
-    fhDelay = new TH1F("hDelay", "Delay between NeuLAND and CALIFA", 1100, -1000., 10000.);
-    FairRunOnline::Instance()->AddObject(fhDelay);
+    delete fPool;
+    fPool = NULL;
+    fMatchIndex.clear();
+    fMatches.clear();
+    fGroups.clear();
+    fActiveGroups.clear();
+    if(fNUnpackThreads > 1)
+    {
+        fGroups.assign(fUnpackerList.size(), UnpackGroup());
+        for(size_t u = 0; u < fGroups.size(); u++)
+        {
+            fGroups[u].unpacker = u;
+        }
+        
+        // Hits are created by several threads at once
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+        ROOT::EnableThreadSafety();
+#else
+        TThread::Initialize();
+#endif
+        fPool = new UnpackPool(fNUnpackThreads);
+    }
 
   return kTRUE;
 }
 
 
-Bool_t R3BLmdSource::OpenNextFile(TString fileName)
+Bool_t R3BLmdSource::InitUnpackers()
 {
-  Int_t inputMode = 1;
-  fxInputChannel = new s_evt_channel;  
-  void* headptr = &fxInfoHeader;
-  INTS4 status;
-  status = f_evt_get_open(inputMode,
-                          const_cast<char*>(fileName.Data()),
-                          fxInputChannel,
-                          (Char_t**)headptr,
-                          1,
-                          1);
-
-  if(status) {
-    return kFALSE;
+  // As FairMbsSource::Init(), but note the branches each unpacker registers
+  TList* branches = FairRootManager::Instance()->GetBranchNameList();
+  const TObjArray* unpackers = GetUnpackers();
+  fUnpackerList.clear();
+  fOutputBranches.clear();
+  for(Int_t i = 0; NULL != unpackers && i < unpackers->GetEntriesFast(); i++) {
+    FairUnpack* unpack = (FairUnpack*) unpackers->At(i);
+    Int_t nBefore = NULL == branches ? 0 : branches->GetSize();
+    if(! unpack->Init()) {
+      return kFALSE;
+    }
+    fUnpackerList.push_back(unpack);
+    fOutputBranches.push_back(std::vector<TString>());
+    for(Int_t j = nBefore; NULL != branches && j < branches->GetSize(); j++) {
+      fOutputBranches.back().push_back(((TObjString*)branches->At(j))->GetString());
+    }
   }
-
-
-  // Decode File Header
-  /*Bool_t result = */Unpack((Int_t*)fxInfoHeader, sizeof(s_filhe), -4, -4, -4, -4, -4);
-
-  cout << "-I- R3BLmdSource::OpenNextFile : file "
-       << fileName << " opened." << endl;
- 
-  
-
   return kTRUE;
 }
 
 
 Int_t R3BLmdSource::ReadEvent(UInt_t iev)
 {
-    ClearBuf();
-    
-    // Read next NeuLAND sub-event
-    Int_t status;
-    do
+    // Fill the reorder buffer until the oldest reference event can be built
+    while(! IsComplete())
     {
+        if(fEndOfData)
+        {
+            return 1;
+        }
         Reset();
-        status = ReadData();
-        // Check if eof reached
-        if(1 == status)
+        if(1 == ReadMbsEvent())
         {
-            return status;
+            fEndOfData = kTRUE;
+            continue;
         }
-    } while (fNeuLandHits->GetEntries() == 0);
+        BufferEvent();
+        Purge();
+    }
     
-    // Copy NeuLAND data to the internal buffer
-    CopyNeuLandToBuf();
+    return BuildEvent();
+}
 
-    
-    // Read next CALIFA sub-event
-    do
+
+void R3BLmdSource::BufferEvent()
+{
+    Int_t slot = -1;
+    for(size_t i = 0; i < fStreams.size(); i++)
     {
-        Reset();
-        status = ReadData();
-        // Check if eof reached
-        if(1 == status)
+        if(fSubEvents[i].empty())
         {
-            return status;
+            continue;
         }
-        if(fNeuLandHits->GetEntries() > 0)
+        Stream& stream = fStreams[i];
+        ULong64_t time = stream.subEventTime ? fStreamTimes[i] : fEventHeader->GetTimeStamp();
+        if(0 == time)
         {
-            // Copy NeuLAND data to the internal buffer
-            CopyNeuLandToBuf();
+            // Cannot be placed in time
             continue;
         }
+        
+        if(slot < 0)
+        {
+            if(fFreeEvents.empty())
+            {
+                fEvents.push_back(BufferedEvent());
+                fEvents.back().subEvents.resize(fStreams.size());
+                fFreeEvents.push_back(fEvents.size() - 1);
+            }
+            slot = fFreeEvents.back();
+            fFreeEvents.pop_back();
+            BufferedEvent& event = fEvents[slot];
+            for(size_t k = 0; k < event.subEvents.size(); k++)
+            {
+                event.subEvents[k].clear();
+            }
+            // Take over the raw event, the reader gets an unused buffer back
+            event.data.swap(fRecord->data);
+            event.timeStamp = fEventHeader->GetTimeStamp();
+            event.trigger = fEventHeader->GetTrigger();
+            event.nPending = 0;
+        }
+        fEvents[slot].subEvents[i].swap(fSubEvents[i]);
+        fEvents[slot].nPending += 1;
+        
+        // Keep the entries sorted, usually this appends
+        std::deque<std::pair<ULong64_t, Int_t> >::iterator it = stream.pending.end();
+        while(it != stream.pending.begin() && (it - 1)->first > time)
+        {
+            --it;
+        }
+        stream.pending.insert(it, std::make_pair(time, slot));
+        if(time > stream.lastTime)
+        {
+            stream.lastTime = time;
+        }
     }
-    while (fCalifaHits->GetEntries() == 0);
-    
-    // Get first hit from CALIFA
-    R3BCaloRawHit *caloHit = (R3BCaloRawHit*) fCalifaHits->At(0);
-    // Calculate time delay between main DAQ and CALIFA
-    Long_t tdiff = caloHit->GetTime() - fBufHeader->GetTimeStamp();
-    fhDelay->Fill(tdiff);
-    // If within the range - save all to output
-    if(tdiff >= fDelayCutLower && tdiff <= fDelayCutUpper)
+}
+
+
+Bool_t R3BLmdSource::IsComplete() const
+{
+    const Stream& ref = fStreams[0];
+    if(ref.pending.empty())
+    {
+        return kFALSE;
+    }
+    if(fEndOfData || (Int_t)(fEvents.size() - fFreeEvents.size()) >= fBuildBuffer)
     {
-        CopyNeuLandToOutput();
-        return 0;
+        return kTRUE;
     }
-    else
+    // Every stream must have passed the end of its window. A stream
+    // without any data yet only waits as long as the reference stream
+    // has not passed it either.
+    ULong64_t tRef = ref.pending.front().first;
+    for(size_t i = 1; i < fStreams.size(); i++)
     {
-        ClearBuf();
+        const Stream& stream = fStreams[i];
+        ULong64_t last = stream.lastTime > 0 ? stream.lastTime : ref.lastTime;
+        if((Long64_t)(last - tRef) <= stream.upper)
+        {
+            return kFALSE;
+        }
     }
-
-    // Do not save output
-    return 2;
+    return kTRUE;
 }
 
 
-Int_t R3BLmdSource::ReadData()
+void R3BLmdSource::Purge()
 {
-    Int_t status;
-    do
+    // Entries before the window of the oldest reference event cannot be matched anymore
+    const Stream& ref = fStreams[0];
+    if(! ref.pending.empty() || ref.lastTime > 0)
     {
-        status = ReadMbsEvent();
-        if(1 == status)
+        ULong64_t tRef = ref.pending.empty() ? ref.lastTime : ref.pending.front().first;
+        for(size_t i = 1; i < fStreams.size(); i++)
         {
-            return status;
+            Stream& stream = fStreams[i];
+            while(! stream.pending.empty() && (Long64_t)(stream.pending.front().first - tRef) < stream.lower)
+            {
+                ReleaseEntry(i);
+            }
         }
     }
-    while (fNeuLandHits->GetEntries() == 0 && fCalifaHits->GetEntries() == 0);
     
-    return 0;
+    // Full buffer without any reference event: drop the oldest entries
+    while(ref.pending.empty() && (Int_t)(fEvents.size() - fFreeEvents.size()) >= fBuildBuffer)
+    {
+        Int_t oldest = -1;
+        for(size_t i = 1; i < fStreams.size(); i++)
+        {
+            if(! fStreams[i].pending.empty() &&
+               (oldest < 0 || fStreams[i].pending.front().first < fStreams[oldest].pending.front().first))
+            {
+                oldest = i;
+            }
+        }
+        if(oldest < 0)
+        {
+            break;
+        }
+        ReleaseEntry(oldest);
+    }
 }
 
 
-void R3BLmdSource::CopyNeuLandToBuf()
+void R3BLmdSource::ReleaseEntry(Int_t iStream)
 {
-    ClearBuf();
-    
-    // Copy event header
-    fBufHeader->SetTimeStamp(fEventHeader->GetTimeStamp());
-    fBufHeader->SetTrigger(fEventHeader->GetTrigger());
-    
-    // Copy NeuLAND raw hits
-    for(Int_t i = 0; i < fNeuLandHits->GetEntries(); i++)
+    Stream& stream = fStreams[iStream];
+    BufferedEvent& event = fEvents[stream.pending.front().second];
+    event.nPending -= 1;
+    if(0 == event.nPending)
     {
-        new ((*fBufNeuLand)[i]) R3BLandRawHit(*((R3BLandRawHit*)fNeuLandHits->At(i)));
+        fFreeEvents.push_back(stream.pending.front().second);
     }
+    stream.pending.pop_front();
 }
 
 
-void R3BLmdSource::CopyNeuLandToOutput()
+Int_t R3BLmdSource::BuildEvent()
 {
-    // Copy event header
-    fEventHeader->SetTimeStamp(fBufHeader->GetTimeStamp());
-    fEventHeader->SetTrigger(fBufHeader->GetTrigger());
+    Stream& ref = fStreams[0];
+    ULong64_t tRef = ref.pending.front().first;
     
-    // Copy NeuLAND raw hits
-    fNeuLandHits->Clear();
-    for(Int_t i = 0; i < fBufNeuLand->GetEntries(); i++)
+    // Candidates are the first entries within the windows
+    Bool_t complete = kTRUE;
+    for(size_t i = 1; i < fStreams.size(); i++)
     {
-        new ((*fNeuLandHits)[i]) R3BLandRawHit(*((R3BLandRawHit*)fBufNeuLand->At(i)));
+        Stream& stream = fStreams[i];
+        while(! stream.pending.empty() && (Long64_t)(stream.pending.front().first - tRef) < stream.lower)
+        {
+            ReleaseEntry(i);
+        }
+        Bool_t matched = kFALSE;
+        if(! stream.pending.empty())
+        {
+            Long64_t tdiff = stream.pending.front().first - tRef;
+            stream.hDelay->Fill(tdiff);
+            matched = tdiff <= stream.upper;
+        }
+        if(! matched && stream.required)
+        {
+            complete = kFALSE;
+        }
+    }
+    if(! complete)
+    {
+        // Do not save output, unmatched entries stay for the next events
+        ReleaseEntry(0);
+        return 2;
     }
     
-    // Clear the buffer
-    ClearBuf();
-}
-
-
-void R3BLmdSource::ClearBuf()
-{
-    fBufNeuLand->Clear();
+    // Matched entries of the other streams
+    Int_t refSlot = ref.pending.front().second;
+    std::vector<Int_t>& match = fMatchedSlots;
+    match.assign(fStreams.size(), -1);
+    match[0] = refSlot;
+    for(size_t i = 1; i < fStreams.size(); i++)
+    {
+        Stream& stream = fStreams[i];
+        if(! stream.pending.empty() && (Long64_t)(stream.pending.front().first - tRef) <= stream.upper)
+        {
+            match[i] = stream.pending.front().second;
+        }
+    }
+    
+    // Unpack the whole reference event, as read, except for the sub-events
+    // of streams matched in other events. Those are added from there.
+    // The header and the unpackers without output branch have run when
+    // the events were read, their results are restored from the buffer.
+    Reset();
+    fSubEventList.clear();
+    const BufferedEvent& refEvent = fEvents[refSlot];
+    s_ve10_1* refData = (s_ve10_1*)&refEvent.data[0];
+    Int_t nrSubEvts = f_evt_get_subevent(refData, 0, NULL, NULL, NULL);
+    for(Int_t j = 1; j <= nrSubEvts; j++)
+    {
+        Bool_t other = kFALSE;
+        for(size_t i = 1; i < fStreams.size() && ! other; i++)
+        {
+            other = match[i] != refSlot &&
+                    std::find(refEvent.subEvents[i].begin(), refEvent.subEvents[i].end(), j) != refEvent.subEvents[i].end();
+        }
+        if(! other)
+        {
+            AddSubEvent(refData, j);
+        }
+    }
+    for(size_t i = 1; i < fStreams.size(); i++)
+    {
+        if(match[i] < 0 || match[i] == refSlot)
+        {
+            continue;
+        }
+        const BufferedEvent& event = fEvents[match[i]];
+        for(size_t j = 0; j < event.subEvents[i].size(); j++)
+        {
+            AddSubEvent((s_ve10_1*)&event.data[0], event.subEvents[i][j]);
+        }
+    }
+    UnpackSubEventList();
+    fEventHeader->SetTimeStamp(refEvent.timeStamp);
+    fEventHeader->SetTrigger(refEvent.trigger);
+    
+    for(size_t i = 1; i < fStreams.size(); i++)
+    {
+        if(match[i] >= 0)
+        {
+            ReleaseEntry(i);
+        }
+    }
+    ReleaseEntry(0);
+    
+    return 0;
 }
 
 
 Int_t R3BLmdSource::ReadMbsEvent()
 {
-  void* evtptr = &fxEvent;
-  void* buffptr = &fxBuffer;
-
-  Int_t status = f_evt_get_event(fxInputChannel, (INTS4**)evtptr,(INTS4**) buffptr);
-  //Int_t fuEventCounter = fxEvent->l_count;
-  //Int_t fCurrentMbsEventNo = fuEventCounter;
-
-  if(GETEVT__SUCCESS != status) {
-    if(fCurrentFile >= fFileNames->GetSize()) {
+  // Skip over file boundaries to the next event
+  while(kTRUE) {
+    fRecord = fReader->Next();
+    if(NULL == fRecord || R3BLmdReader::kEnd == fRecord->type) {
       return 1;
     }
-
-    if(GETEVT__NOMORE == status) {
-      Close();
-    }
-
-    TString name = ((TObjString*)fFileNames->At(fCurrentFile))->GetString();
-    if(! OpenNextFile(name)) {
+    if(R3BLmdReader::kError == fRecord->type) {
+      cerr << "-E- R3BLmdSource::ReadMbsEvent : cannot open file "
+           << ((TObjString*)fFileNames->At(fCurrentFile))->GetString() << endl;
       return 1;
-    } else {
+    }
+    if(R3BLmdReader::kFileHeader == fRecord->type) {
+      // Decode File Header
+      Unpack((Int_t*)&fRecord->data[0], sizeof(s_filhe), -4, -4, -4, -4, -4);
+      cout << "-I- R3BLmdSource::ReadMbsEvent : file "
+           << ((TObjString*)fFileNames->At(fCurrentFile))->GetString() << " opened." << endl;
       fCurrentFile += 1;
-      return ReadEvent();
+      continue;
     }
+    if(R3BLmdReader::kFileEnd == fRecord->type) {
+      Unpack((Int_t*)&fRecord->buffer, sizeof(s_bufhe), -4, -4, -4, -4, -4);
+      fCurrentEvent = 0;
+      continue;
+    }
+    break;
   }
 
  //Store Start Times
   if (fCurrentEvent==0 ) 
-      Unpack((Int_t*)fxBuffer, sizeof(s_bufhe), -4, -4, -4, -4, -4);
+      Unpack((Int_t*)&fRecord->buffer, sizeof(s_bufhe), -4, -4, -4, -4, -4);
 
+  return UnpackEvent(fRecord->GetEvent());
+}
 
-  // Decode event header
-  Bool_t result = kFALSE;
-  /*Bool_t result = */Unpack((Int_t*)fxEvent, sizeof(s_ve10_1), -2, -2, -2, -2, -2);
 
-  Int_t nrSubEvts = f_evt_get_subevent(fxEvent, 0, NULL, NULL, NULL);
-  Int_t sebuflength;
-  Short_t setype;
-  Short_t sesubtype;
-  Short_t seprocid;
-  Short_t sesubcrate;
-  Short_t secontrol;
+Int_t R3BLmdSource::UnpackEvent(s_ve10_1* event)
+{
+  // Decode event header
+  /*Bool_t result = */Unpack((Int_t*)event, sizeof(s_ve10_1), -2, -2, -2, -2, -2);
 
-  //if (fCurrentEvent%10000==0)
-  //cout << " -I- LMD_ANA:  evt# " <<  fCurrentEvent << "  n_subevt# " << nrSubEvts << " evt processed# " << fNEvent <<  " : " << fxEvent->l_count << endl;
+  for(size_t j = 0; j < fSubEvents.size(); j++) {
+    fSubEvents[j].clear();
+    fStreamTimes[j] = 0;
+  }
 
-//  Int_t* SubEventDataPtr = new Int_t;
+  // Only the unpackers without output branch run now, they fill the
+  // event header. The sub-events of the streams are found from their
+  // headers and unpacked in place when the event is built.
+  Bool_t result = kFALSE;
+  fSubEventList.clear();
+  Int_t nrSubEvts = f_evt_get_subevent(event, 0, NULL, NULL, NULL);
   for(Int_t i = 1; i <= nrSubEvts; i++) {
-    void* SubEvtptr = &fxSubEvent;
-    void* EvtDataptr = &fxEventData;
-    Int_t nrlongwords;
-    status = f_evt_get_subevent(fxEvent, i, (Int_t**)SubEvtptr, (Int_t**)EvtDataptr, &nrlongwords);
-    if(status) {
+    if(! AddSubEvent(event, i)) {
       return 1;
     }
-    sebuflength = nrlongwords;
-    setype = fxSubEvent->i_type;
-    sesubtype = fxSubEvent->i_subtype;
-    seprocid = fxSubEvent->i_procid;
-    sesubcrate = fxSubEvent->h_subcrate;
-    secontrol = fxSubEvent->h_control;
-
-    if(Unpack(fxEventData, sebuflength,
-              setype, sesubtype,
-              seprocid, sesubcrate, secontrol)) {
+    const SubEvent& item = fSubEventList.back();
+    const Match& match = fMatches[item.match];
+    for(size_t k = 0; k < match.onRead.size(); k++) {
+      if(fUnpackerList[match.onRead[k]]->DoUnpack(item.data, item.size)) {
+        result = kTRUE;
+      }
+    }
+    if(! match.onBuild.empty()) {
       result = kTRUE;
     }
+    for(size_t k = 0; k < match.streams.size(); k++) {
+      Int_t j = match.streams[k];
+      if(fSubEvents[j].empty() && fStreams[j].subEventTime) {
+        fStreamTimes[j] = GetSubEventTime(item.data, item.size);
+      }
+      fSubEvents[j].push_back(i);
+    }
   }
 
   // Increment evt counters.
@@ -369,14 +698,171 @@ Int_t R3BLmdSource::ReadMbsEvent()
 }
 
 
+Bool_t R3BLmdSource::AddSubEvent(s_ve10_1* event, Int_t index)
+{
+  s_ves10_1* subEvent;
+  Int_t* eventData;
+  void* SubEvtptr = &subEvent;
+  void* EvtDataptr = &eventData;
+  Int_t nrlongwords;
+  if(f_evt_get_subevent(event, index, (Int_t**)SubEvtptr, (Int_t**)EvtDataptr, &nrlongwords)) {
+    return kFALSE;
+  }
+  SubEvent item;
+  item.index = index;
+  item.data = eventData;
+  item.size = nrlongwords;
+  item.type = subEvent->i_type;
+  item.subType = subEvent->i_subtype;
+  item.procId = subEvent->i_procid;
+  item.subCrate = subEvent->h_subcrate;
+  item.control = subEvent->h_control;
+  // All header fields: sub-events with the same key go to the same unpackers
+  item.key = ((ULong64_t)(UShort_t)item.type << 48) | ((ULong64_t)(UShort_t)item.subType << 32) |
+             ((ULong64_t)(UShort_t)item.procId << 16) | ((ULong64_t)(UChar_t)item.subCrate << 8) |
+             (ULong64_t)(UChar_t)item.control;
+  item.match = MatchUnpackers(item);
+  fSubEventList.push_back(item);
+  return kTRUE;
+}
+
+
+Int_t R3BLmdSource::MatchUnpackers(const SubEvent& item)
+{
+  std::map<ULong64_t, Int_t>::const_iterator it = fMatchIndex.find(item.key);
+  if(it != fMatchIndex.end()) {
+    return it->second;
+  }
+  // The selection of FairMbsSource::Unpack: an unpacker with sub-crate
+  // -1 takes the sub-events of its type and sub-type from all crates
+  Match match;
+  for(size_t u = 0; u < fUnpackerList.size(); u++) {
+    const FairUnpack* unpack = fUnpackerList[u];
+    if(unpack->GetType() != item.type || unpack->GetSubType() != item.subType) {
+      continue;
+    }
+    if(unpack->GetSubCrate() >= 0 &&
+       (unpack->GetProcId() != item.procId || unpack->GetSubCrate() != item.subCrate ||
+        unpack->GetControl() != item.control)) {
+      continue;
+    }
+    if(fOutputBranches[u].empty()) {
+      match.onRead.push_back(u);
+    } else {
+      match.onBuild.push_back(u);
+    }
+    for(size_t j = 0; j < fStreams.size(); j++) {
+      if(fStreams[j].unpacker == (Int_t)u) {
+        match.streams.push_back(j);
+      }
+    }
+  }
+  fMatches.push_back(match);
+  fMatchIndex[item.key] = fMatches.size() - 1;
+  return fMatches.size() - 1;
+}
+
+
+ULong64_t R3BLmdSource::GetSubEventTime(const Int_t* data, Int_t size)
+{
+  // White-rabbit time stamp at the start of the sub-event, read like
+  // R3BCaloUnpack does for its hits: after the module id four words
+  // with 16 bits each, least significant first
+  if(size < 5) {
+    return 0;
+  }
+  ULong64_t time = 0;
+  for(Int_t k = 0; k < 4; k++) {
+    time |= (ULong64_t)(data[1 + k] & 0xffff) << (16 * k);
+  }
+  return time;
+}
+
+
+Bool_t R3BLmdSource::UnpackSubEventList()
+{
+  if(UnpackParallel()) {
+    for(size_t k = 0; k < fActiveGroups.size(); k++) {
+      if(fGroups[fActiveGroups[k]].result) {
+        return kTRUE;
+      }
+    }
+    return kFALSE;
+  }
+
+  Bool_t result = kFALSE;
+  for(size_t i = 0; i < fSubEventList.size(); i++) {
+    const SubEvent& item = fSubEventList[i];
+    const std::vector<Int_t>& onBuild = fMatches[item.match].onBuild;
+    for(size_t k = 0; k < onBuild.size(); k++) {
+      if(fUnpackerList[onBuild[k]]->DoUnpack(item.data, item.size)) {
+        result = kTRUE;
+      }
+    }
+  }
+  return result;
+}
+
+
+Bool_t R3BLmdSource::UnpackParallel()
+{
+  if(NULL == fPool || fSubEventList.size() < 2) {
+    return kFALSE;
+  }
+
+  // One group per unpacker instance. A sub-event taken by several
+  // unpackers is in each of their groups.
+  for(size_t k = 0; k < fActiveGroups.size(); k++) {
+    UnpackGroup& group = fGroups[fActiveGroups[k]];
+    group.items.clear();
+    group.result = kFALSE;
+  }
+  fActiveGroups.clear();
+  for(size_t i = 0; i < fSubEventList.size(); i++) {
+    const std::vector<Int_t>& onBuild = fMatches[fSubEventList[i].match].onBuild;
+    for(size_t k = 0; k < onBuild.size(); k++) {
+      if(fGroups[onBuild[k]].items.empty()) {
+        fActiveGroups.push_back(onBuild[k]);
+      }
+      fGroups[onBuild[k]].items.push_back(i);
+    }
+  }
+  if(fActiveGroups.size() < 2) {
+    return kFALSE;
+  }
+
+  std::function<void(Int_t)> task = [this](Int_t k) { UnpackGroupItems(fGroups[fActiveGroups[k]]); };
+  fPool->Run(fActiveGroups.size(), task);
+  return kTRUE;
+}
+
+
+void R3BLmdSource::UnpackGroupItems(UnpackGroup& group)
+{
+  // Only the unpacker of this group writes to the branches it registered
+  FairUnpack* unpack = fUnpackerList[group.unpacker];
+  for(size_t k = 0; k < group.items.size(); k++) {
+    const SubEvent& item = fSubEventList[group.items[k]];
+    if(unpack->DoUnpack(item.data, item.size)) {
+      group.result = kTRUE;
+    }
+  }
+}
+
+
 void R3BLmdSource::Close()
 {
-  f_evt_get_close(fxInputChannel);
-  Unpack((Int_t*)fxBuffer, sizeof(s_bufhe), -4, -4, -4, -4, -4);
+  if(NULL == fReader) {
+    return;
+  }
+  // Buffer of the last event, unless its file has been finished already
+  if(fCurrentEvent > 0 && NULL != fRecord && R3BLmdReader::kEvent == fRecord->type) {
+    Unpack((Int_t*)&fRecord->buffer, sizeof(s_bufhe), -4, -4, -4, -4, -4);
+  }
+  fReader->Stop();
+  fRecord = NULL;
   fCurrentEvent=0;
 }
 
 
 ClassImp(R3BLmdSource)
-
-
@@ -25,14 +25,44 @@ extern "C"
 
 #include "FairMbsSource.h"
 
+#include "R3BLmdReader.h"
+
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
 
 class TList;
 class TClonesArray;
 class TH1F;
 class TH2F;
 class R3BEventHeader;
+class FairUnpack;
 
 
+/**
+ * MBS event source for LMD files with an event builder, which merges
+ * the events of several DAQ streams by their time stamps.
+ *
+ * A stream is identified by the output branch its unpacker registers.
+ * The first stream is the reference: one output event is built per
+ * reference event. Events of the other streams are matched to it if
+ * their time stamp lies within [t_ref + lower, t_ref + upper]. Events
+ * wait in a bounded reorder buffer until the windows of all streams
+ * have been passed, then the reference event is unpacked completely,
+ * together with the matched sub-events of the other streams.
+ *
+ * Every sub-event is unpacked once. When an event is read, only the
+ * unpackers without output branch run (event header, time stamp), the
+ * sub-events of the streams are found from their headers. All other
+ * unpackers run in place on the buffered event when it is built.
+ *
+ * The time stamp of an event is the white-rabbit time stamp of the
+ * event header, for CALIFA the one at the start of its sub-event, which
+ * its hits carry. Without AddStream(), NeuLAND is merged with CALIFA
+ * (see SetMaxDelay()).
+ */
 class R3BLmdSource : public FairMbsSource
 {
   public:
@@ -51,41 +81,139 @@ class R3BLmdSource : public FairMbsSource
     inline void SetTimeStampUnit(Int_t unit) { fTSUnit = unit; }
     inline void SetMaxDelay(Int_t delayLower, Int_t delayUpper)
     { fDelayCutLower = delayLower; fDelayCutUpper = delayUpper; }
+
+    /** Number of MBS events the background reader may read in advance */
+    inline void SetReadAhead(Int_t nEvents) { fReadAhead = nEvents; }
+
+    /**
+     * Adds a stream to the event builder. The first stream added is
+     * the reference, its window is ignored.
+     * @param branchName name of the TClonesArray filled by the stream.
+     * @param windowLower lower limit of t - t_ref.
+     * @param windowUpper upper limit of t - t_ref.
+     * @param required drop reference events without a match.
+     */
+    void AddStream(TString branchName, Long64_t windowLower = 0, Long64_t windowUpper = 0, Bool_t required = kTRUE);
+
+    /** Maximum number of MBS events waiting in the event builder */
+    inline void SetBuildBuffer(Int_t nEvents) { fBuildBuffer = nEvents; }
+
+    /**
+     * Number of threads unpacking the sub-events of an event in parallel.
+     * Each unpacker gets the sub-events FairMbsSource would give it (by
+     * type, sub-type, procid, crate and control, an unpacker with
+     * sub-crate -1 takes all crates) and runs on one thread at a time,
+     * different unpackers run concurrently. The event is complete when
+     * all of them are done. Each unpacker must only fill the branches it
+     * registers. Default 1: serial.
+     */
+    inline void SetNUnpackThreads(Int_t nThreads) { fNUnpackThreads = nThreads; }
     
   private:
-    Int_t ReadData();
+    class UnpackPool;
+
+    struct SubEvent
+    {
+        Int_t index;                 // number of the sub-event in its event
+        Int_t* data;
+        Int_t size;
+        Short_t type;
+        Short_t subType;
+        Short_t procId;
+        Short_t subCrate;
+        Short_t control;
+        ULong64_t key;               // all header fields
+        Int_t match;                 // unpackers of the sub-event, index in fMatches
+    };
+
+    // Unpackers and streams of one sub-event header
+    struct Match
+    {
+        std::vector<Int_t> onRead;   // unpackers without output branch, run when the event is read
+        std::vector<Int_t> onBuild;  // unpackers with output branches, run when it is built
+        std::vector<Int_t> streams;  // streams filled from the sub-event
+    };
+
+    // Sub-events of one unpacker, unpacked in order by one thread
+    struct UnpackGroup
+    {
+        Int_t unpacker;              // index in fUnpackerList
+        std::vector<Int_t> items;    // indices in fSubEventList
+        Bool_t result;
+    };
+
+    struct Stream
+    {
+        TString branch;
+        Long64_t lower;
+        Long64_t upper;
+        Bool_t required;
+        Bool_t subEventTime;         // time stamp from its own sub-event
+        TClonesArray* hits;
+        TH1F* hDelay;
+        std::deque<std::pair<ULong64_t, Int_t> > pending; // (time stamp, buffered event), sorted
+        ULong64_t lastTime;          // latest time stamp seen
+        Int_t unpacker;              // unpacker registering the branch, index in fUnpackerList
+    };
+
+    struct BufferedEvent
+    {
+        std::vector<char> data;                      // raw event, taken over from the reader
+        std::vector<std::vector<Int_t> > subEvents;  // sub-events (numbers in data) per stream
+        ULong_t timeStamp;
+        Int_t trigger;
+        Int_t nPending;                              // stream entries referring to it
+    };
+
+    Bool_t InitUnpackers();
     Int_t ReadMbsEvent();
-    
-    void CopyNeuLandToBuf();
-    void CopyNeuLandToOutput();
-    void ClearBuf();
+    Int_t UnpackEvent(s_ve10_1* event);
+    Bool_t AddSubEvent(s_ve10_1* event, Int_t index);
+    Int_t MatchUnpackers(const SubEvent& item);
+    static ULong64_t GetSubEventTime(const Int_t* data, Int_t size);
+    Bool_t UnpackSubEventList();
+    Bool_t UnpackParallel();
+    void UnpackGroupItems(UnpackGroup& group);
+
+    void BufferEvent();
+    Int_t BuildEvent();
+    Bool_t IsComplete() const;
+    void Purge();
+    void ReleaseEntry(Int_t iStream);
     
     R3BEventHeader *fEventHeader;
-    TClonesArray *fNeuLandHits;
-    TClonesArray *fCalifaHits;
-    
-    R3BEventHeader *fBufHeader;
-    TClonesArray *fBufNeuLand;
+
+    std::vector<Stream> fStreams;
+    std::vector<BufferedEvent> fEvents;           // slots of the reorder buffer
+    std::vector<Int_t> fFreeEvents;               // unused slots
+    std::vector<std::vector<Int_t> > fSubEvents;  // sub-events per stream of the current event
+    std::vector<ULong64_t> fStreamTimes;          // time stamps of the own sub-events per stream
+    std::vector<Int_t> fMatchedSlots;             // buffered event matched per stream, -1 if none
+    Int_t fBuildBuffer;
+    Bool_t fEndOfData;
+
+    std::vector<SubEvent> fSubEventList;          // sub-events to unpack
+    std::vector<FairUnpack*> fUnpackerList;       // unpackers of FairMbsSource, in its order
+    std::vector<std::vector<TString> > fOutputBranches; // branches registered per unpacker
+    std::map<ULong64_t, Int_t> fMatchIndex;       // sub-event header -> index in fMatches
+    std::vector<Match> fMatches;                  // unpackers taking a sub-event header
+    std::vector<UnpackGroup> fGroups;             // sub-events to unpack, per unpacker
+    std::vector<Int_t> fActiveGroups;             // groups with sub-events in this event
+    Int_t fNUnpackThreads;
+    UnpackPool* fPool;
     
     Int_t fTSUnit;
     Int_t fDelayCutLower;
     Int_t fDelayCutUpper;
-    
-    TH1F *fhDelay;
 
   protected:
-    Bool_t OpenNextFile(TString fileName);
-
     Int_t fCurrentFile;
 	Int_t fNEvent;
 	Int_t fCurrentEvent;
     TList* fFileNames;
-    s_evt_channel* fxInputChannel;
-    s_ve10_1* fxEvent;
-    s_bufhe* fxBuffer;
-    Int_t* fxEventData;
-    s_ves10_1* fxSubEvent;
-	s_filhe* fxInfoHeader;
+    Int_t fReadAhead;
+    R3BLmdReader* fReader;
+    R3BLmdReader::Record* fRecord;  // Current record of the reader
 
     ClassDef(R3BLmdSource, 0)
 };
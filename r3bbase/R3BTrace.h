@@ -0,0 +1,77 @@
+// -------------------------------------------------------------------------
+// -----                       R3BTrace header file                    -----
+// -------------------------------------------------------------------------
+
+/** R3BTrace.h
+ **
+ ** Logging for the per-word and per-hit loops of unpackers and
+ ** calibrators.
+ **
+ ** R3B_TRACE(level) << ... << FairLogger::endl;
+ **   Same as LOG(level), but only compiled if R3B_HOT_LOGGING is
+ **   defined (CMake option R3B_HOT_LOGGING, default OFF). Otherwise the
+ **   statement is still syntax-checked, but the logger is never asked
+ **   and the operands are never evaluated; the compiler drops it.
+ **
+ ** R3B_LOG_SAMPLED(level, counter) << ... << FairLogger::endl;
+ **   Always compiled. The R3BLogCounter counts every occurrence, but the
+ **   message is only formatted for the first ones and then for every
+ **   n-th. Use one counter per detector and kind of problem, and print
+ **   GetCount() as a summary at the end of the run.
+ **
+ ** Both expand to an if/else, so they are safe inside unbraced if/else.
+ **/
+
+
+#ifndef R3BTRACE_H
+#define R3BTRACE_H 1
+
+
+#include "FairLogger.h"
+
+
+#ifdef R3B_HOT_LOGGING
+#define R3B_TRACE(level) LOG(level)
+#else
+#define R3B_TRACE(level) if (true) {} else LOG(level)
+#endif
+
+#define R3B_LOG_SAMPLED(level, counter) if (!(counter).Sample()) {} else LOG(level)
+
+
+class R3BLogCounter
+{
+
+ public:
+
+  /** Constructor
+   ** @param nFirst  Number of occurrences which are all logged
+   ** @param every   Afterwards log every n-th occurrence, 0 for none
+   **/
+  R3BLogCounter(ULong64_t nFirst = 10, ULong64_t every = 10000)
+    : fCount(0), fFirst(nFirst), fEvery(every) { }
+
+  /** Count an occurrence
+   ** @value kTRUE if this one is to be logged
+   **/
+  inline Bool_t Sample()
+  {
+    fCount++;
+    return fCount <= fFirst || (fEvery > 0 && fCount % fEvery == 0);
+  }
+
+  /** Total number of occurrences **/
+  inline ULong64_t GetCount() const { return fCount; }
+
+  inline void Reset() { fCount = 0; }
+
+ private:
+
+  ULong64_t fCount;   // Number of occurrences
+  ULong64_t fFirst;   // Log all of the first fFirst occurrences
+  ULong64_t fEvery;   // then every fEvery-th
+
+};
+
+
+#endif
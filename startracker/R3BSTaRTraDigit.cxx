@@ -30,163 +30,19 @@
 #include "R3BSTaRTraPoint.h"
 #include "R3BSTaRTrackerDigitHit.h"
 
+#include <cmath>
+
 using std::cout;
 using std::endl;
 
 
-R3BSTaRTraDigit::R3BSTaRTraDigit() : FairTask("R3B STaRTracker Hit Raw Sim data ") { 
-	fThreshold=0.;	   //no threshold
-	fTrackerResolution=0.; //perfect resolution
-}
-
-
-R3BSTaRTraDigit::~R3BSTaRTraDigit() {
-}
-
-
-void R3BSTaRTraDigit::SetParContainers() {
-
-  // Get run and runtime database
-  FairRunAna* run = FairRunAna::Instance();
-  if ( ! run ) Fatal("SetParContainers", "No analysis run");
-
-  FairRuntimeDb* rtdb = run->GetRuntimeDb();
-  if ( ! rtdb ) Fatal("SetParContainers", "No runtime database");
-
-  fSTaRTraDigiPar = (R3BSTaRTraDigiPar*)(rtdb->getContainer("R3BSTaRTraDigiPar"));
-
-  if ( fSTaRTraDigiPar ) {
-      LOG(INFO) << "-I- R3BSTaRTraDigit::SetParContainers() "<< FairLogger::endl;
-      LOG(INFO) << "-I- Container R3BSTaRTraDigiPar  loaded " << FairLogger::endl;
-  }
+namespace {
 
-}
-
-
-
-// -----   Public method Init   --------------------------------------------
-InitStatus R3BSTaRTraDigit::Init() {
-	FairRootManager* ioManager = FairRootManager::Instance();
-	if ( !ioManager ) Fatal("Init", "No FairRootManager");
-	fSTaRTrackerHitCA = (TClonesArray*) ioManager->GetObject("STaRTraPoint");
-	
-	
-	// Register output array STaRTraDigitHit
-	fSTaRTraHitCA = new TClonesArray("R3BSTaRTrackerDigitHit",1000);
-	ioManager->Register("STaRTrackerDigitHit", "STaRTracker Hit", fSTaRTraHitCA, kTRUE);	
-	
-	return kSUCCESS;
-	
-}
-
-
-
-// -----   Public method ReInit   --------------------------------------------
-InitStatus R3BSTaRTraDigit::ReInit() {
-	
-	
-	return kSUCCESS;
-	
-}
-
-
-// -----   Public method Exec   --------------------------------------------
-void R3BSTaRTraDigit::Exec(Option_t* opt) {
-	
-	Reset();
-	
-	Double_t pi= 3.141592653589793238;
-	// Si Geometrical parameter:
-	// Inner layer
-	//Double_t Length1  = 19.03 ; // cm
-	Double_t Length1  = 21.794 ; // cm
-	//Double_t WidthMax1  = 7.945 ; // cm
-	Double_t WidthMax1  = 8.1912 ; // cm
-	//Double_t WidthMin1  = 2.25 ; // cm
-	Double_t WidthMin1  = 1.971 ; // cm
-	//Double_t StripPitch1= 0.00515 ; // = 51.5 um
-	Double_t StripPitch1= 0.00385 + 0.0012 + 0.0001 + 0.000127+ 2e-6 ; // 
-	//Double_t InclAng1=14.9;
-	Double_t InclAng1=14.3;
-	Double_t Rmin1=1.75;    // cm
-	//Double_t AngRangeMin1=7.;    
-	Double_t AngRangeMin1=5.26;    
-	Double_t AngTrap1=atan((WidthMax1/2 -WidthMin1/2)/Length1);
-//	Double_t WidthHalf1=WidthMax1 - (Length1/cos(AngTrap1))*sin(AngTrap1);
-	Double_t StepZ1= StripPitch1/sin(AngTrap1) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX1= StripPitch1/cos(AngTrap1) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip1   = int(WidthMax1/StepX1); //
-	//cout << "NbStrip1= " << NbStrip1 << endl;
-	Double_t Xlab1, Ylab1, Zlab1;  // see trunk/tracker/R3BSTaRTra.cxx
-	Xlab1=0.;
-	Ylab1=-((Length1/2)*sin(InclAng1*pi/180.)+ Rmin1);
-	Zlab1=-Length1*cos(InclAng1*pi/180.)/2 + (Rmin1/tan(AngRangeMin1*pi/180.));
-
-	Double_t ShiftalongZ;
-	Double_t Proj ; // cm
-	Double_t ProjStrip ; // cm
-	Int_t strip=0;
-	Int_t StripA_Id=0;
-	Int_t StripB_Id=0;
-	Double_t SlopA,SlopB,OffsetA,OffsetB;
-	
-
-	Int_t ChipA=-1;
-	Int_t StripFront=-1;
-	Int_t ChipB=-1;
-	Int_t StripBack=-1;
-
-
-	// Middle layer
-	//Double_t Length2  = 30.06 ; // cm
-	Double_t Length2  = 33.83875 ; // cm
-	//Double_t WidthMax2  = 10.4 ; // cm
-	Double_t WidthMax2  = 10.80295 ; // cm
-	//Double_t WidthMin2  = 1.3 ; // cm
-	Double_t WidthMin2  = 1.1406 ; // cm
-	//Double_t StripPitch2= 0.00515 ; // = 51.5 um
-	Double_t StripPitch2= 0.00385 + 0.0012 + 0.0001 + 0.00007; // 
-	Double_t InclAng2=32.155; // deg    
-	Double_t Rmin2=2.22;    // cm
-	Double_t AngRangeMin2=5.3;// deg    
-	//Double_t AngTrap2= 0.14853 ; // in rad = 17/2 degrees
-	Double_t AngTrap2= atan((WidthMax2 /2 - WidthMin2 /2)/Length2); // (rad) ;
-	Double_t StepZ2= StripPitch2/sin(AngTrap2) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX2= StripPitch2/cos(AngTrap2) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip2   = int(WidthMax2/StepX2); //
-	//cout << "NbStrip2= " << NbStrip2 << endl;
-	Double_t Xlab2, Ylab2, Zlab2;  // see trunk/tracker/R3BSTaRTra.cxx
-	Xlab2=0;
-	Ylab2=-((Length2/2)*sin(InclAng2*pi/180.)+ Rmin2);
-	Zlab2=-Length2*cos(InclAng2*pi/180.)/2 + (Rmin2/tan(AngRangeMin2*pi/180.));
-	
-    // Outer layer
-	//Double_t Length3  = 30.06 ; // cm
-	Double_t Length3  = 33.838753 ; // cm
-	//Double_t WidthMax3  = 10.4 ; // cm
-	Double_t WidthMax3  = 10.80295 ; // cm
-	//Double_t WidthMin3  = 1.3 ; // cm
-	Double_t WidthMin3  = 1.1406 ; // cm
-	//Double_t StripPitch3= 0.005 ; // = 50 um
-	Double_t StripPitch3= 0.00385 + 0.0012 + 0.0001 + 0.00007; // = 51.5 um
-        Double_t InclAng3=32.155; // deg    
-        Double_t Rmin3=2.95;    // cm
-        Double_t AngRangeMin3=6.76; // deg   
-	//Double_t AngTrap3= 0.14853 ; // in rad = 17/2 degrees
-	Double_t AngTrap3= atan((WidthMax3 /2 - WidthMin3 /2)/Length3); // (rad)
-	Double_t StepZ3= StripPitch3/sin(AngTrap3) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX3= StripPitch3/cos(AngTrap3) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip3   = int(WidthMax3/StepX3); //
-	//cout << "NbStrip3= " << NbStrip3 << endl;
-        Double_t Xlab3, Ylab3, Zlab3;  // see trunk/tracker/R3BSTaRTra.cxx
-        Xlab3=0;
-        Ylab3=-((Length3/2)*sin(InclAng3*pi/180.)+ Rmin3);
-        Zlab3=-Length3*cos(InclAng3*pi/180.)/2 + (Rmin3/tan(AngRangeMin3*pi/180.));
-    
+  // Transformations lab -> ladder frame (rows 0-3, columns x y z 1)
 
 	//For v15:
    // Inner layer:
-  Double_t M_Inner[6][4][4]=
+  const Double_t M_Inner[6][4][4]=
     {
 
       {
@@ -241,7 +97,7 @@ void R3BSTaRTraDigit::Exec(Option_t* opt) {
   */
 
    // Middle layer:
-     Double_t M_Mid[12][4][4]=
+     const Double_t M_Mid[12][4][4]=
     {
       {
 	{0.965925826,	-0.258819045,             0,            0},  // Matrice 1 row 0
@@ -331,7 +187,7 @@ void R3BSTaRTraDigit::Exec(Option_t* opt) {
   
 
      // Outer layer:
-     Double_t M_Out[12][4][4]=  
+     const Double_t M_Out[12][4][4]=  
     {
       {
 	{0.965925826,	-0.258819045,             0,            0},  // Matrice 1 row 0
@@ -657,6 +513,228 @@ void R3BSTaRTraDigit::Exec(Option_t* opt) {
      };
 	
  */      
+
+}
+
+
+R3BSTaRTraDigit::R3BSTaRTraDigit() : FairTask("R3B STaRTracker Hit Raw Sim data ") { 
+	fThreshold=0.;	   //no threshold
+	fTrackerResolution=0.; //perfect resolution
+}
+
+
+R3BSTaRTraDigit::~R3BSTaRTraDigit() {
+}
+
+
+void R3BSTaRTraDigit::SetParContainers() {
+
+  // Get run and runtime database
+  FairRunAna* run = FairRunAna::Instance();
+  if ( ! run ) Fatal("SetParContainers", "No analysis run");
+
+  FairRuntimeDb* rtdb = run->GetRuntimeDb();
+  if ( ! rtdb ) Fatal("SetParContainers", "No runtime database");
+
+  fSTaRTraDigiPar = (R3BSTaRTraDigiPar*)(rtdb->getContainer("R3BSTaRTraDigiPar"));
+
+  if ( fSTaRTraDigiPar ) {
+      LOG(INFO) << "-I- R3BSTaRTraDigit::SetParContainers() "<< FairLogger::endl;
+      LOG(INFO) << "-I- Container R3BSTaRTraDigiPar  loaded " << FairLogger::endl;
+  }
+
+}
+
+
+
+// -----   Public method Init   --------------------------------------------
+InitStatus R3BSTaRTraDigit::Init() {
+	FairRootManager* ioManager = FairRootManager::Instance();
+	if ( !ioManager ) Fatal("Init", "No FairRootManager");
+	fSTaRTrackerHitCA = (TClonesArray*) ioManager->GetObject("STaRTraPoint");
+	
+	
+	// Register output array STaRTraDigitHit
+	fSTaRTraHitCA = new TClonesArray("R3BSTaRTrackerDigitHit",1000);
+	ioManager->Register("STaRTrackerDigitHit", "STaRTracker Hit", fSTaRTraHitCA, kTRUE);	
+	
+	InitGeometry();
+	
+	return kSUCCESS;
+	
+}
+
+
+
+// -----   Public method ReInit   --------------------------------------------
+InitStatus R3BSTaRTraDigit::ReInit() {
+	
+	
+	return kSUCCESS;
+	
+}
+
+
+// -----   Private method InitGeometry   --------------------------------------
+// Everything Exec needs from the geometry: the x and z rows of the
+// transformation of each ladder and, per layer, the projection at x=0 of
+// the middle line of every strip.
+void R3BSTaRTraDigit::InitGeometry() {
+	
+	Double_t pi= 3.141592653589793238;
+	// Si Geometrical parameter:
+	// Inner layer
+	//Double_t Length1  = 19.03 ; // cm
+	Double_t Length1  = 21.794 ; // cm
+	//Double_t WidthMax1  = 7.945 ; // cm
+	Double_t WidthMax1  = 8.1912 ; // cm
+	//Double_t WidthMin1  = 2.25 ; // cm
+	Double_t WidthMin1  = 1.971 ; // cm
+	//Double_t StripPitch1= 0.00515 ; // = 51.5 um
+	Double_t StripPitch1= 0.00385 + 0.0012 + 0.0001 + 0.000127+ 2e-6 ; // 
+	//Double_t InclAng1=14.9;
+	Double_t InclAng1=14.3;
+	Double_t Rmin1=1.75;    // cm
+	//Double_t AngRangeMin1=7.;    
+	Double_t AngRangeMin1=5.26;    
+	Double_t AngTrap1=atan((WidthMax1/2 -WidthMin1/2)/Length1);
+//	Double_t WidthHalf1=WidthMax1 - (Length1/cos(AngTrap1))*sin(AngTrap1);
+	Double_t StepZ1= StripPitch1/sin(AngTrap1) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX1= StripPitch1/cos(AngTrap1) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip1   = int(WidthMax1/StepX1); //
+	//cout << "NbStrip1= " << NbStrip1 << endl;
+	Double_t Xlab1, Ylab1, Zlab1;  // see trunk/tracker/R3BSTaRTra.cxx
+	Xlab1=0.;
+	Ylab1=-((Length1/2)*sin(InclAng1*pi/180.)+ Rmin1);
+	Zlab1=-Length1*cos(InclAng1*pi/180.)/2 + (Rmin1/tan(AngRangeMin1*pi/180.));
+
+
+	// Middle layer
+	//Double_t Length2  = 30.06 ; // cm
+	Double_t Length2  = 33.83875 ; // cm
+	//Double_t WidthMax2  = 10.4 ; // cm
+	Double_t WidthMax2  = 10.80295 ; // cm
+	//Double_t WidthMin2  = 1.3 ; // cm
+	Double_t WidthMin2  = 1.1406 ; // cm
+	//Double_t StripPitch2= 0.00515 ; // = 51.5 um
+	Double_t StripPitch2= 0.00385 + 0.0012 + 0.0001 + 0.00007; // 
+	Double_t InclAng2=32.155; // deg    
+	Double_t Rmin2=2.22;    // cm
+	Double_t AngRangeMin2=5.3;// deg    
+	//Double_t AngTrap2= 0.14853 ; // in rad = 17/2 degrees
+	Double_t AngTrap2= atan((WidthMax2 /2 - WidthMin2 /2)/Length2); // (rad) ;
+	Double_t StepZ2= StripPitch2/sin(AngTrap2) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX2= StripPitch2/cos(AngTrap2) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip2   = int(WidthMax2/StepX2); //
+	//cout << "NbStrip2= " << NbStrip2 << endl;
+	Double_t Xlab2, Ylab2, Zlab2;  // see trunk/tracker/R3BSTaRTra.cxx
+	Xlab2=0;
+	Ylab2=-((Length2/2)*sin(InclAng2*pi/180.)+ Rmin2);
+	Zlab2=-Length2*cos(InclAng2*pi/180.)/2 + (Rmin2/tan(AngRangeMin2*pi/180.));
+	
+    // Outer layer
+	//Double_t Length3  = 30.06 ; // cm
+	Double_t Length3  = 33.838753 ; // cm
+	//Double_t WidthMax3  = 10.4 ; // cm
+	Double_t WidthMax3  = 10.80295 ; // cm
+	//Double_t WidthMin3  = 1.3 ; // cm
+	Double_t WidthMin3  = 1.1406 ; // cm
+	//Double_t StripPitch3= 0.005 ; // = 50 um
+	Double_t StripPitch3= 0.00385 + 0.0012 + 0.0001 + 0.00007; // = 51.5 um
+        Double_t InclAng3=32.155; // deg    
+        Double_t Rmin3=2.95;    // cm
+        Double_t AngRangeMin3=6.76; // deg   
+	//Double_t AngTrap3= 0.14853 ; // in rad = 17/2 degrees
+	Double_t AngTrap3= atan((WidthMax3 /2 - WidthMin3 /2)/Length3); // (rad)
+	Double_t StepZ3= StripPitch3/sin(AngTrap3) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX3= StripPitch3/cos(AngTrap3) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip3   = int(WidthMax3/StepX3); //
+	//cout << "NbStrip3= " << NbStrip3 << endl;
+        Double_t Xlab3, Ylab3, Zlab3;  // see trunk/tracker/R3BSTaRTra.cxx
+        Xlab3=0;
+        Ylab3=-((Length3/2)*sin(InclAng3*pi/180.)+ Rmin3);
+        Zlab3=-Length3*cos(InclAng3*pi/180.)/2 + (Rmin3/tan(AngRangeMin3*pi/180.));
+	
+	Double_t Length[3]= {Length1, Length2, Length3};
+	Double_t WidthMax[3]= {WidthMax1, WidthMax2, WidthMax3};
+	Double_t WidthMin[3]= {WidthMin1, WidthMin2, WidthMin3};
+	Double_t StepZ[3]= {StepZ1, StepZ2, StepZ3};
+	Double_t StepX[3]= {StepX1, StepX2, StepX3};
+	Int_t    NbStrip[3]= {NbStrip1, NbStrip2, NbStrip3};
+	
+	// shift along z axis (z lab coordinate of the center of the detector after inverse transformation, 0.03 is an extra shift thought to be coinciding with the middle line of a strip: to be checked !! ).
+	Double_t ShiftalongZ[3];
+	ShiftalongZ[0]= ( Xlab1*M_Inner[0][2][0] + Ylab1*M_Inner[0][2][1] + Zlab1*M_Inner[0][2][2] + 1*M_Inner[0][2][3])+ 0.03;
+	ShiftalongZ[1]= ( Xlab2*M_Mid[0][2][0] + Ylab2*M_Mid[0][2][1] + Zlab2*M_Mid[0][2][2] + 1*M_Mid[0][2][3])+ 0.03;
+	ShiftalongZ[2]= ( Xlab3*M_Out[0][2][0] + Ylab3*M_Out[0][2][1] + Zlab3*M_Out[0][2][2] + 1*M_Out[0][2][3])+ 0.03;
+	
+	for(Int_t det=0; det<kNbDet; det++){
+		const Double_t (*M)[4];
+		if(det<6) M= M_Inner[det];
+		else if(det<18) M= M_Mid[det-6];
+		else M= M_Out[det-18];
+		for(Int_t k=0; k<4; k++){
+			fTrans[det][0][k]= M[0][k];
+			fTrans[det][1][k]= M[2][k];
+		}
+	}
+	
+	for(Int_t layer=0; layer<3; layer++){
+		fSlopA[layer]= (2*Length[layer])/(WidthMin[layer]-WidthMax[layer]);
+		fHalfStepZ[layer]= StepZ[layer]/2;
+		// Front (A) and back (B) strips have the same projection at x=0,
+		// with SlopB= -SlopA the side B formula reduces to the side A one.
+		fProjStrip[layer].resize(NbStrip[layer]);
+		for(Int_t strip=0; strip<NbStrip[layer]; strip++){
+			fProjStrip[layer][strip]= (-Length[layer]/2 + ShiftalongZ[layer]) - fSlopA[layer]*(WidthMax[layer]/2 - (StepX[layer]/2)*(2*strip+1));
+		}
+		fStepProj[layer]= NbStrip[layer]>1 ?
+		  (fProjStrip[layer][0] - fProjStrip[layer][NbStrip[layer]-1])/(NbStrip[layer]-1) : 0.;
+	}
+	
+}
+
+
+// -----   Private method FindStrip   --------------------------------------
+// The projections decrease with the strip number, so the strips with
+// ProjStrip - Proj <= StepZ/2 are those from some strip on. Its number is
+// estimated from the mean step and corrected on the table, then checked
+// against -StepZ/2: the result is the same as scanning all strips, in a
+// few comparisons.
+Int_t R3BSTaRTraDigit::FindStrip(Int_t layer, Double_t Proj) const {
+	
+	const std::vector<Double_t>& ProjStrip= fProjStrip[layer];
+	Int_t NbStrip= ProjStrip.size();
+	Double_t HalfStepZ= fHalfStepZ[layer];
+	
+	Int_t strip=0;
+	if(fStepProj[layer]>0){
+		Double_t est= (ProjStrip[0] - Proj - HalfStepZ)/fStepProj[layer];
+		if(est>=NbStrip) strip= NbStrip;
+		else if(est>0) strip= Int_t(ceil(est));
+	}
+	while(strip>0 && (ProjStrip[strip-1] - Proj)<= HalfStepZ) strip--;
+	while(strip<NbStrip && !((ProjStrip[strip] - Proj)<= HalfStepZ)) strip++;
+	
+	if(strip==NbStrip || !((ProjStrip[strip] - Proj)> -HalfStepZ)) return -1;
+	return strip;
+	
+}
+
+
+// -----   Public method Exec   --------------------------------------------
+void R3BSTaRTraDigit::Exec(Option_t* opt) {
+	
+	Reset();
+	
+	Int_t strip;
+	Int_t StripA_Id=0;
+	Int_t StripB_Id=0;
+	
+	Int_t ChipA=-1;
+	Int_t StripFront=-1;
+	Int_t ChipB=-1;
+	Int_t StripBack=-1;
 	
 	Double_t Energy = 0.;
 	Double_t Time = 0.;
@@ -664,378 +742,69 @@ void R3BSTaRTraDigit::Exec(Option_t* opt) {
 	Double_t Y_track= 0;
 	Double_t Z_track= 0;
 	Double_t X_track_det= 0;
-	Double_t Y_track_det= 0;
 	Double_t Z_track_det= 0;
 	
-	
 	Int_t Detector;
+	Int_t Layer;
 	
-	R3BSTaRTraPoint** traHit;
-	
-	Int_t traHitsPerEvent = 0;
-	traHitsPerEvent = fSTaRTrackerHitCA->GetEntries();
-	
-	//cout << " NEW EVENT " << endl;
-
-	
-	//cout << traHitsPerEvent <<endl;
+	Int_t traHitsPerEvent = fSTaRTrackerHitCA->GetEntries();
 	
-	//cout << "" << endl;
-
-	
-	if(traHitsPerEvent>0){
-
-		traHit = new R3BSTaRTraPoint*[traHitsPerEvent];
-		for(Int_t i=0;i<traHitsPerEvent;i++){
-			traHit[i] = new R3BSTaRTraPoint;
-			traHit[i] = (R3BSTaRTraPoint*) fSTaRTrackerHitCA->At(i);
-			Energy = ExpResSmearing(traHit[i]->GetEnergyLoss());
-			//Energy = traHit[i]->GetEnergyLoss();
-			Detector = traHit[i]->GetDetCopyID();
-			
-			X_track = traHit[i]->GetXIn();
-			Y_track = traHit[i]->GetYIn();
-			Z_track = traHit[i]->GetZIn();
-			
-			Time=traHit[i]->GetTime();       
-            
-			if(Detector<=6){  // = inner layer
-				
-				//cout << Detector << " " << j << " " << k << endl;
-				
-				//cout <<  X_track << " " <<   Y_track << " " <<  Z_track << " " << endl;
-				
-				// apply Matrix transformation
-				X_track_det=  X_track*M_Inner[Detector-1][0][0] 
-				            + Y_track*M_Inner[Detector-1][0][1]
-				            + Z_track*M_Inner[Detector-1][0][2]
-				            +         M_Inner[Detector-1][0][3];
-				
-				//cout << M_Inner[Detector-1][0][0] << " " << M_Inner[Detector-1][0][1] << " " << M_Inner[Detector-1][0][2] << " " << M_Inner[Detector-1][0][3] << endl ;
-				
-				Y_track_det=  X_track*M_Inner[Detector-1][1][0] 
-				            + Y_track*M_Inner[Detector-1][1][1]
-				            + Z_track*M_Inner[Detector-1][1][2]
-				            +         M_Inner[Detector-1][1][3];
-				
-				//cout << M_Inner[Detector-1][1][0] << " " << M_Inner[Detector-1][1][1] << " " << M_Inner[Detector-1][1][2] << " " << M_Inner[Detector-1][1][3] << endl ;
-
-				Z_track_det=  X_track*M_Inner[Detector-1][2][0] 
-				            + Y_track*M_Inner[Detector-1][2][1]
-				            + Z_track*M_Inner[Detector-1][2][2]
-				            +         M_Inner[Detector-1][2][3];
-				
-				//cout << M_Inner[Detector-1][2][0] << " " << M_Inner[Detector-1][2][1] << " " << M_Inner[Detector-1][2][2] << " " << M_Inner[Detector-1][2][3] << endl ;
-
-				//cout <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " << endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				//SlopA= (2*Length1)/(WidthMax1-WidthMin1);
-				SlopA= (2*Length1)/(WidthMin1-WidthMax1);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopA*(-WidthMax1/2);  // 1st strip proj at z=0
-			        ShiftalongZ= ( Xlab1*M_Inner[0][2][0] 
-					       + Ylab1*M_Inner[0][2][1] 
-					       + Zlab1*M_Inner[0][2][2] 
-					       +     1*M_Inner[0][2][3])+ 0.03; // shift along z axis (-1.35855= z lab coordinate of the center of the detector after inverse transformation, 0.03 is an extra shift thought to be coinciding with the middle line of a strip: to be checked !! ).
-				ProjStrip= (-Length1/2 + ShiftalongZ) - SlopA*(WidthMax1/2 - (StepX1/2)*(2*strip+1));  // 1st strip proj at x=0
-				//ProjStrip= (-Length1/2 -1.1) - SlopA*(WidthMax1/2 - (StepX1/2)*(2*strip+1));  // 1st strip proj at x=0. -1.1 is a shift along z axis (TODO: find analytic formula).
-				
-				//cout << "SlopA= " << SlopA << " Length1= " << Length1 << " WidthMax1= " << WidthMax1 << " WidthMin1= " << WidthMin1 << endl;
-				//cout << "Proj= " << Proj  << " ProjStrip= " << ProjStrip << endl;
-				//cout << "StepZ1/2 = " << StepZ1/2  << " ProjStrip - Proj= " << ProjStrip-Proj << endl;
-				
-				while(strip<NbStrip1)
-				{
-				  if( (ProjStrip -Proj)<= StepZ1/2 && 
-				      (ProjStrip -Proj)> -StepZ1/2)
-				    {
-				      // first strip hit is:
-				      StripA_Id=strip+1;  // strip starts at #1
-				      OffsetA= ProjStrip;
-				      strip=NbStrip1;  // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length1/2 + ShiftalongZ) - SlopA*(WidthMax1/2 - (StepX1/2)*(2*strip+1));
-				    }
-
-				}
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopB*(WidthMax1/2);  // 1st strip proj at z=0
-				//ProjStrip= (-Length1/2 -1.1) - SlopB*(-WidthMax1/2 + (StepX1/2)*(2*strip+1)); 
-				ProjStrip= (-Length1/2 + ShiftalongZ) - SlopB*(-WidthMax1/2 + (StepX1/2)*(2*strip+1));  // 1st strip proj at x=0
-				
-				//cout << "SlopB= " << SlopB << " Length1= " << Length1 << " WidthMax1= " << WidthMax1 << " WidthMin1= " << WidthMin1 << endl;
-				//cout << "Proj= " << Proj  << " ProjStrip= " << ProjStrip << endl;
-				//cout << "StepZ1/2 = " << StepZ1/2  << " ProjStrip - Proj= " << ProjStrip-Proj << endl;
-				
-				while(strip<NbStrip1)
-				{
-
-				  if( (ProjStrip - Proj)<= StepZ1/2 && 
-				      (ProjStrip - Proj)> -StepZ1/2)
-				    {
-				      // 2nd strip hit:
-				      StripB_Id=strip+1;
-				      OffsetB= ProjStrip;
-				      strip=NbStrip1; // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length1/2 + ShiftalongZ) - SlopB*(-WidthMax1/2 + (StepX1/2)*(2*strip+1));
-				    }
-
-				}
-				
-				ChipA=int((StripA_Id-1)/128);
-				StripFront=(StripA_Id-1) - (ChipA*128);
-				ChipB=int((StripB_Id-1)/128);
-				StripBack=(StripB_Id-1) - (ChipB*128);			
-				
-				
-			}   // end of Det=7 ( inner layer)
-			
-			if(Detector>=7 && Detector<=18){  // = Middle layer
-				
-				//cout << Detector << endl;
-				
-				// apply Matrix transformation 
-				X_track_det=  X_track*M_Mid[Detector-7][0][0] 
-				+ Y_track*M_Mid[Detector-7][0][1]
-				+ Z_track*M_Mid[Detector-7][0][2]
-				+               M_Mid[Detector-7][0][3];
-				Y_track_det=  X_track*M_Mid[Detector-7][1][0] 
-				+ Y_track*M_Mid[Detector-7][1][1]
-				+ Z_track*M_Mid[Detector-7][1][2]
-				+               M_Mid[Detector-7][1][3];
-				Z_track_det=  X_track*M_Mid[Detector-7][2][0] 
-				+ Y_track*M_Mid[Detector-7][2][1]
-				+ Z_track*M_Mid[Detector-7][2][2]
-				+               M_Mid[Detector-7][2][3];
-				
-				//cout <<  X_track << " " <<   Y_track << " " <<  Z_track << " " << endl;
-				//cout <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " << endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				//SlopA= (2*Length2)/(WidthMax2-WidthMin2);
-				SlopA= (2*Length2)/(WidthMin2-WidthMax2);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopA*(-WidthMax2/2);  // 1st strip proj at z=0
-				ShiftalongZ= ( Xlab2*M_Mid[0][2][0] 
-					       + Ylab2*M_Mid[0][2][1] 
-					       + Zlab2*M_Mid[0][2][2] 
-					       +     1*M_Mid[0][2][3])+ 0.03; // shift along z axis (z lab coordinate of the center of the detector after inverse transformation, 0.03 is an extra shift thought to be coinciding with the middle line of a strip: to be checked !! ).
-				ProjStrip= (-Length2/2 + ShiftalongZ) - SlopA*(WidthMax2/2 -(StepX2/2)*(2*strip+1));  // 1st strip proj at x=0 
-
-				//ProjStrip= (-Length2/2 -5.5) - SlopA*(WidthMax2/2 -(StepX2/2)*(2*strip+1));  // 1st strip proj at x=0, -5.5 ia a shift along Z axis (TODO: find the analytic formula)
-				
-				//cout << "SlopA= " << SlopA << " Length2= " << Length2 << " WidthMax2= " << WidthMax2 << " WidthMin2= " << WidthMin2 << endl;
-				//cout << "Proj= " << Proj  << " ProjStrip= " << ProjStrip << endl;
-				//cout << "StepZ2/2 = " << StepZ2/2  << " ProjStrip - Proj= " << ProjStrip-Proj << endl;
-				
-				while(strip<NbStrip2)
-				{
-
-				  if( (ProjStrip - Proj)<=StepZ2/2 &&
-				      (ProjStrip - Proj)>-StepZ2/2)
-				    {
-				      // first strip hit is:
-				      StripA_Id=strip+1;
-				      //cout << "StripA_Id= " << StripA_Id << endl;
-				      OffsetA= ProjStrip;
-				      strip=NbStrip2;  // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length2/2 + ShiftalongZ) - SlopA*(WidthMax2/2 -(StepX2/2)*(2*strip+1));
-				    }
-
-				}
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopB*(WidthMax2/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length2/2 + ShiftalongZ) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-				//ProjStrip= (-Length2/2 -5.5) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-				
-				while(strip<NbStrip2)
-				{
-				  if( (ProjStrip - Proj)<=StepZ2/2 &&
-				      (ProjStrip - Proj)>-StepZ2/2)
-				    {
-				      // 2nd strip hit:
-				      StripB_Id=strip+1;
-				      OffsetB= ProjStrip;
-				      strip=NbStrip2; // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length2/2 +ShiftalongZ) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-				    }
-
-				  /*
-					if( (ProjStrip-Proj)<StepZ2/2 ){
-						// 2nd strip hit:
-						StripB_Id=strip;
-						//cout << "StripB_Id= " << StripB_Id << endl;
-						OffsetB= ProjStrip;
-						strip=NbStrip2; // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopB*(WidthMax2/2);
-						ProjStrip= (-Length2/2 -5.5) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-					}
-				  */
-				}
-
-
-				ChipA=int((StripA_Id-1)/128);
-				StripFront=(StripA_Id-1) - (ChipA*128);
-				ChipB=int((StripB_Id-1)/128);
-				StripBack=(StripB_Id-1) - (ChipB*128);			
-				
-				
-			} 
-			
-			if(Detector>=19){  // = outer layer
-				
-				
-				// apply Matrix transformation M_Out[x][4][4] 
-				X_track_det=  X_track*M_Out[Detector-19][0][0] 
-				+ Y_track*M_Out[Detector-19][0][1]
-				+ Z_track*M_Out[Detector-19][0][2]
-				+               M_Out[Detector-19][0][3];
-				Y_track_det=  X_track*M_Out[Detector-18][1][0] 
-				+ Y_track*M_Out[Detector-19][1][1]
-				+ Z_track*M_Out[Detector-19][1][2]
-				+               M_Out[Detector-19][1][3];
-				Z_track_det=  X_track*M_Out[Detector-19][2][0] 
-				+ Y_track*M_Out[Detector-19][2][1]
-				+ Z_track*M_Out[Detector-19][2][2]
-				+               M_Out[Detector-19][2][3];
-				
-				//cout <<  X_track << " " <<   Y_track << " " <<  Z_track << " " << endl;
-				//cout <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " << endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopA= (2*Length3)/(WidthMin3-WidthMax3);
-				//SlopA= (2*Length3)/(WidthMax3-WidthMin3);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopA*(-WidthMax3/2);  // 1st strip proj at z=0
-				ShiftalongZ= ( Xlab3*M_Out[0][2][0] 
-					       + Ylab3*M_Out[0][2][1] 
-					       + Zlab3*M_Out[0][2][2] 
-					       +     1*M_Out[0][2][3])+ 0.03; // shift along z axis (z lab coordinate of the center of the detector after inverse transformation, 0.03 is an extra shift thought to be coinciding with the middle line of a strip: to be checked !! ).
-				ProjStrip= (-Length3/2 + ShiftalongZ) - SlopA*(WidthMax3/2 -(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				//ProjStrip= (-Length3/2 -5) - SlopA*(WidthMax3/2 -(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				
-				//cout << "SlopA= " << SlopA << " Length3= " << Length3 << " WidthMax3= " << WidthMax3 << " WidthMin3= " << WidthMin3 << endl;
-				//cout << "Proj= " << Proj  << " ProjStrip= " << ProjStrip << endl;
-				//cout << "StepZ3/2 = " << StepZ3/2  << " ProjStrip - Proj= " << ProjStrip-Proj << endl;
-				
-				while(strip<NbStrip3)
-				{
-			    
-				  if( (ProjStrip - Proj)<=StepZ3/2 &&
-				      (ProjStrip - Proj)> -StepZ3/2)
-				    {
-				      // first strip hit is:
-				      StripA_Id=strip+1;
-				      OffsetA= ProjStrip;
-				      strip=NbStrip3;  // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length3/2 + ShiftalongZ) - SlopA*(WidthMax3/2 -(StepX3/2)*(2*strip+1));
-				    }
-
-				}
-
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopB*(WidthMax3/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length3/2 + ShiftalongZ) - SlopB*(-WidthMax3/2 +(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				//ProjStrip= (-Length3/2 -5) - SlopB*(-WidthMax3/2 +(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				
-				
-				while(strip<NbStrip3)
-				{
-				  if( (ProjStrip - Proj)<=StepZ3/2 &&
-				      (ProjStrip - Proj)> -StepZ3/2)
-				    {
-				      // 2nd strip hit:
-				      StripB_Id=strip+1;
-				      OffsetB= ProjStrip;
-				      strip=NbStrip3; // to end the loop
-				    }else
-				    {
-				      strip++;
-				      ProjStrip= (-Length3/2 + ShiftalongZ) - SlopB*(-WidthMax3/2 + (StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				    }
-
-				}
-
-
-				ChipA=int((StripA_Id-1)/128);
-				StripFront=(StripA_Id-1) - (ChipA*128);
-				ChipB=int((StripB_Id-1)/128);
-				StripBack=(StripB_Id-1) - (ChipB*128);			
-				
-			}
-            
-				
-
-			//if(Energy >= fThreshold) AddHit(Energy, Detector, StripA_Id, StripB_Id, Time);
-			if(Energy >= fThreshold)
-			  {
-			    AddHit(Detector, ChipA, 0, StripFront, Energy, Time);
-			    AddHit(Detector, ChipB, 1, StripBack, Energy, Time);
-			  }
-				
-			}
+	for(Int_t i=0;i<traHitsPerEvent;i++){
+		R3BSTaRTraPoint* traHit = (R3BSTaRTraPoint*) fSTaRTrackerHitCA->At(i);
+		Energy = ExpResSmearing(traHit->GetEnergyLoss());
+		Detector = traHit->GetDetCopyID();
+		
+		if(Detector<1 || Detector>kNbDet){
+			LOG(WARNING) << "R3BSTaRTraDigit::Exec: unknown ladder " << Detector << ", point ignored" << FairLogger::endl;
+			continue;
 		}
 		
+		X_track = traHit->GetXIn();
+		Y_track = traHit->GetYIn();
+		Z_track = traHit->GetZIn();
 		
-		//cout << " " << endl;
+		Time=traHit->GetTime();
+		
+		if(Detector<=6) Layer=0;        // inner layer
+		else if(Detector<=18) Layer=1;  // middle layer
+		else Layer=2;                   // outer layer
+		
+		// apply Matrix transformation
+		const Double_t (*M)[4]= fTrans[Detector-1];
+		X_track_det=  X_track*M[0][0] 
+		            + Y_track*M[0][1]
+		            + Z_track*M[0][2]
+		            +         M[0][3];
+		Z_track_det=  X_track*M[1][0] 
+		            + Y_track*M[1][1]
+		            + Z_track*M[1][2]
+		            +         M[1][3];
+		
+		// find 1st strip hit: projection parallel to the 1st longitudinal side of the detector (SlopA)
+		// If no strip matches, the strip Id of the previous point is kept.
+		strip= FindStrip(Layer, Z_track_det - fSlopA[Layer]*X_track_det);
+		if(strip>=0) StripA_Id=strip+1;  // strip starts at #1
+		
+		// find 2nd strip hit: projection parallel to the 2nd longitudinal side (SlopB= -SlopA)
+		strip= FindStrip(Layer, Z_track_det + fSlopA[Layer]*X_track_det);
+		if(strip>=0) StripB_Id=strip+1;
+		
+		ChipA=int((StripA_Id-1)/128);
+		StripFront=(StripA_Id-1) - (ChipA*128);
+		ChipB=int((StripB_Id-1)/128);
+		StripBack=(StripB_Id-1) - (ChipB*128);
+		
+		if(Energy >= fThreshold)
+		  {
+		    AddHit(Detector, ChipA, 0, StripFront, Energy, Time);
+		    AddHit(Detector, ChipB, 1, StripBack, Energy, Time);
+		  }
 		
 	}
 	
-	
+}
+
+
 // ---- Public method Reset   --------------------------------------------------
 void R3BSTaRTraDigit::Reset(){
 	// Clear the CA structure
@@ -15,6 +15,8 @@
 
 #include "R3BSTaRTraDigiPar.h"
 
+#include <vector>
+
 class TClonesArray;
 
 class R3BSTaRTraDigit : public FairTask
@@ -84,6 +86,28 @@ private:
 	
 
         virtual void SetParContainers();
+
+	/** Private method InitGeometry
+	 **
+	 ** Fills the ladder transformations and the strip projections used in Exec
+	 **
+	 **/
+	void InitGeometry();
+
+	/** Private method FindStrip
+	 **
+	 ** First strip (from 0) of the layer whose middle line projection at x=0 is within StepZ/2 of Proj, -1 if none
+	 **
+	 **/
+	Int_t FindStrip(Int_t layer, Double_t Proj) const;
+
+	static const Int_t kNbDet = 30;  // 6 inner, 12 middle and 12 outer ladders
+
+	Double_t fTrans[kNbDet][2][4];        //! x and z rows of the lab -> ladder transformation
+	Double_t fSlopA[3];                   //! slope of the 1st longitudinal side, per layer
+	Double_t fHalfStepZ[3];               //! half strip step along z, per layer
+	Double_t fStepProj[3];                //! mean projection step between two strips, per layer
+	std::vector<Double_t> fProjStrip[3];  //! projection at x=0 of the middle line of each strip, per layer
 	
 	ClassDef(R3BSTaRTraDigit,1);
 	
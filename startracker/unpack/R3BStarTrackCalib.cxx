@@ -23,7 +23,7 @@
 //R3BStarTrackCalib: Constructor
 R3BStarTrackCalib::R3BStarTrackCalib() : FairTask("R3B STaRTracker Calibrator"),
 			       fRawHitCA(0),
-			       fSiDetHitCA(new TClonesArray("R3BSTaRTrackHit")), 
+			       fSiDetHitCA(new TClonesArray("R3BSTaRTrackerDigitHit")), 
 			       fStarTrackCalibPar(0)
 {
 }
@@ -93,8 +93,9 @@ void R3BStarTrackCalib::Exec(Option_t* opt)
 {
   
   LOG(DEBUG) << "Calibring StarTracker Raw Data" << FairLogger::endl;
+
+  Reset();
   
-  R3BStarTrackRawHit**    rawHit;
   Int_t module_id=0;  
   Int_t side=0;  
   Int_t asic_id=0;  
@@ -105,22 +106,18 @@ void R3BStarTrackCalib::Exec(Option_t* opt)
 
   Int_t rawHits;        // Nb of RawHits in current event
   rawHits = fRawHitCA->GetEntries();
-  if (rawHits>0) {
-    rawHit = new R3BStarTrackRawHit*[rawHits];
-    for (Int_t i=0; i<rawHits; i++) {
-      rawHit[i] = new R3BStarTrackRawHit;
-      rawHit[i] = (R3BStarTrackRawHit*) fSiDetHitCA->At(i);
-      
-      module_id = MapModuleID(rawHit[i]);
-      side = MapSide(rawHit[i]);
-      asic_id = MapAsicID(rawHit[i]);
-      strip_id = MapStripID(rawHit[i]);
-      energy = CalibrateEnergy(rawHit[i]);
-      time = CalibrateTime(rawHit[i]);
-      
-      new ((*fSiDetHitCA)[i]) R3BSTaRTrackerDigitHit(module_id, asic_id, side, strip_id, energy, time);
-      
-    }  
+  for (Int_t i=0; i<rawHits; i++) {
+    R3BStarTrackRawHit* rawHit = (R3BStarTrackRawHit*) fRawHitCA->At(i);
+    
+    module_id = MapModuleID(rawHit);
+    side = MapSide(rawHit);
+    asic_id = MapAsicID(rawHit);
+    strip_id = MapStripID(rawHit);
+    energy = CalibrateEnergy(rawHit);
+    time = CalibrateTime(rawHit);
+    
+    new ((*fSiDetHitCA)[i]) R3BSTaRTrackerDigitHit(module_id, asic_id, side, strip_id, energy, time);
+    
   }
   
   return;
@@ -35,7 +35,9 @@ R3BStarTrackUnpack::R3BStarTrackUnpack(char *strTraDir,
                              Short_t subCrate, Short_t control)
 : FairUnpack(type, subType, procId, subCrate, control),
 fRawData(new TClonesArray("R3BStarTrackRawHit")),
-fNHits(0)
+fNHits(0),
+fNUnknownWords(),
+fNBadWordType()
 {
 }
 
@@ -45,6 +47,10 @@ fNHits(0)
 R3BStarTrackUnpack::~R3BStarTrackUnpack()
 {
   LOG(INFO) << "R3BStarTrackUnpack: Delete instance" << FairLogger::endl;
+  if(fNUnknownWords.GetCount() || fNBadWordType.GetCount()) {
+    LOG(WARNING) << "R3BStarTrackUnpack: " << fNUnknownWords.GetCount() << " words not recognised, "
+                 << fNBadWordType.GetCount() << " words of unexpected type" << FairLogger::endl;
+  }
   delete fRawData;
 }
 
@@ -80,7 +86,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack(Int_t *data, Int_t size)  // used for Mbs fo
    
   // TODO: adapt it for Tracker when  data format is known for tracker
   
-  LOG(INFO) << "R3BSTaRTrackUnpack : Unpacking... size = "  << size << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "R3BSTaRTrackUnpack : Unpacking... size = "  << size << FairLogger::endl;
 
   UInt_t l_s = 0;
   //Int_t nInfo4 = 0;
@@ -232,7 +238,9 @@ Bool_t R3BStarTrackUnpack::DoUnpack(Int_t *data, Int_t size)  // used for Mbs fo
 		  
 		  // wordtype=11;
 		  wordtype = (pl_data[l_s] >> 30) & 0x3; // bit 31:30
-		  if(wordtype!=3) cout << wordtype << endl;
+		  if(wordtype!=3) {
+		    R3B_LOG_SAMPLED(WARNING, fNBadWordType) << "R3BSTaRTrackUnpack : unexpected word type " << wordtype << FairLogger::endl;
+		  }
 		  
 		  hitbit= (pl_data[l_s] >> 29) & 0x01;
 		  
@@ -296,16 +304,15 @@ Bool_t R3BStarTrackUnpack::DoUnpack(Int_t *data, Int_t size)  // used for Mbs fo
 
 		} else
 		{
-		  LOG(INFO) << " Warning:  Word not recognised !!!  :" << FairLogger::endl;
-		  
-		    LOG(INFO) << " pl_data[l_s-2]: " <<  ((pl_data[l_s-2] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s-1]: " <<  ((pl_data[l_s-1] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s]: " <<  ((pl_data[l_s] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s+1]: " <<  ((pl_data[l_s+1] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s+2]: " <<  ((pl_data[l_s+2] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s+3]: " <<  ((pl_data[l_s+3] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s+14]: " <<  ((pl_data[l_s+14] ) & 0xFFFFFFFF)  << FairLogger::endl;
-		  LOG(INFO) << " pl_data[l_s+15]: " <<  ((pl_data[l_s+15] ) & 0xFFFFFFFF)  << FairLogger::endl;
+		  R3B_LOG_SAMPLED(WARNING, fNUnknownWords) << "R3BSTaRTrackUnpack : Word not recognised !!!  :"
+		    << " pl_data[l_s-2]: " <<  ((pl_data[l_s-2] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s-1]: " <<  ((pl_data[l_s-1] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s]: " <<  ((pl_data[l_s] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s+1]: " <<  ((pl_data[l_s+1] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s+2]: " <<  ((pl_data[l_s+2] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s+3]: " <<  ((pl_data[l_s+3] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s+14]: " <<  ((pl_data[l_s+14] ) & 0xFFFFFFFF)
+		    << " pl_data[l_s+15]: " <<  ((pl_data[l_s+15] ) & 0xFFFFFFFF)  << FairLogger::endl;
 		  
 		  l_s++;  // move to next word	  
 		}
@@ -321,7 +328,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack(Int_t *data, Int_t size)  // used for Mbs fo
 	
       }
     
-    LOG(INFO) << "R3BSTaRTrackUnpack : Number of hits in STarTracker: " << fNHits << FairLogger::endl;
+    R3B_TRACE(DEBUG) << "R3BSTaRTrackUnpack : Number of hits in STarTracker: " << fNHits << FairLogger::endl;
     return kTRUE;    
 }
 
@@ -333,7 +340,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack(Int_t *data, Int_t size)  // used for Mbs fo
 Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t size)   
 {
   
-  LOG(INFO) << "R3BSTaRTrackUnpack2 : Unpacking... size = " << size << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "R3BSTaRTrackUnpack2 : Unpacking... size = " << size << FairLogger::endl;
 
   UInt_t l_s = 0;
 
@@ -362,12 +369,12 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
   
 
   //LOG(INFO) << "Unpacking Startracker data" << FairLogger::endl;
-  LOG(DEBUG) << "Unpacking Startracker data" << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "Unpacking Startracker data" << FairLogger::endl;
  
 
   wordtype = (*data_word0 >> 30) & 0x3; // bit 31:30
 
-  if(wordtype==2) LOG(INFO) << "Words type 2(10) or 3(11)=" << wordtype << FairLogger::endl;
+  if(wordtype==2) R3B_TRACE(DEBUG) << "Words type 2(10) or 3(11)=" << wordtype << FairLogger::endl;
 
   // Check if word_0 begins with:
   // - 10 then is type A word. 
@@ -379,7 +386,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
       // A (10):
       if ( (*data_word0 & 0xC0000000)==0x80000000 && ( ((*data_word0 & 0xFFFFFFFF) != 0xFFFFFFFF) && ((*data_word1 & 0xFFFFFFFF) != 0xFFFFFFFF)) ){
 	//cout << "Words type A (msb=10)." << std::endl;
-	LOG(DEBUG) << "Words type A (msb=10)." << FairLogger::endl;
+	R3B_TRACE(DEBUG) << "Words type A (msb=10)." << FairLogger::endl;
 	word_0A=*pl_data_word0;
 	word_1A=*pl_data_word1;
 	
@@ -413,8 +420,8 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
 
       // B (11):
       if ( (*data_word0 & 0xC0000000)==0xC0000000 && ( ((*data_word0 & 0xFFFFFFFF) != 0xFFFFFFFF) && ((*data_word1 & 0xFFFFFFFF) != 0xFFFFFFFF)) ){
-	//cout << "Words type B (msb=11)."<< std::endl;
-	LOG(DEBUG) << "Words type B (msb=11)."<< std::endl;
+	//cout << "Words type B (msb=11)."<< FairLogger::endl;
+	R3B_TRACE(DEBUG) << "Words type B (msb=11)."<< FairLogger::endl;
 	word_0B=*pl_data_word0;
 	word_1B=*pl_data_word1;
 	
@@ -434,7 +441,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
 	//  }
 	
 	
-	LOG(DEBUG) << "At GOSIP memory" << FairLogger::endl;
+	R3B_TRACE(DEBUG) << "At GOSIP memory" << FairLogger::endl;
         
 	// Real R3B Si Tracker data channel
 	
@@ -477,7 +484,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
       } // end of B word case
    
 	    //LOG(INFO) << " --------- event " << FairLogger::endl
-    LOG(DEBUG) << " --------- event " << FairLogger::endl
+    R3B_TRACE(DEBUG) << " --------- event " << FairLogger::endl
     << "        hitbit " << hitbit << FairLogger::endl
     << "        Channel_id " << channel_id << FairLogger::endl
     << "        ASIC_id " << asic_id << FairLogger::endl
@@ -495,8 +502,8 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
  
   
   
-  LOG(DEBUG) << "End of memory" << FairLogger::endl;
-  LOG(DEBUG) << "R3BStarTrackUnpack: Number of Si Tracker raw hits: " << fNHits << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "End of memory" << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "R3BStarTrackUnpack: Number of Si Tracker raw hits: " << fNHits << FairLogger::endl;
   //LOG(INFO) << "R3BStarTrackUnpack: Number of Si Tracker raw hits: " << fNHits << FairLogger::endl;
   
   
@@ -508,7 +515,7 @@ Bool_t R3BStarTrackUnpack::DoUnpack2(Int_t *data_word0, Int_t *data_word1, Int_t
 //Reset: Public method
 void R3BStarTrackUnpack::Reset()
 {
-  LOG(DEBUG) << "Clearing Data Structure" << FairLogger::endl;
+  R3B_TRACE(DEBUG) << "Clearing Data Structure" << FairLogger::endl;
   fRawData->Clear();
   fNHits = 0;
 }
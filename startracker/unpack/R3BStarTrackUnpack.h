@@ -11,6 +11,8 @@
 
 #include "FairUnpack.h"
 
+#include "R3BTrace.h"
+
 class TClonesArray;
 
 
@@ -80,6 +82,9 @@ class R3BStarTrackUnpack : public FairUnpack {
     UInt_t asic_id;    // Chip id, real values are 0 to 15
     UInt_t strip_id;   // strip id, real values are 0 to 127
     UInt_t adcData;  // adc value for energy loss in Si
+
+    R3BLogCounter fNUnknownWords; //! words not recognised, logged sampled
+    R3BLogCounter fNBadWordType;  //! type B words with unexpected word type
     
 
 
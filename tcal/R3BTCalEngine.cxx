@@ -1,5 +1,8 @@
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
 
 #include "TH1F.h"
 #include "TMath.h"
@@ -9,171 +12,248 @@
 #include "R3BTCalPar.h"
 #include "R3BTCalEngine.h"
 
-R3BTCalEngine::R3BTCalEngine(R3BTCalPar* param, Int_t nModules, Int_t minStats)
-    : fMinStats(minStats)
-    , fNModules(nModules)
-    , fhData(new TH1F*[nModules])
-    , fhTime(new TH1F*[nModules])
-    , fCal_Par(param)
-    , fClockFreq(0.)
+// Bins of a raw TDC distribution: underflow, TDC values 1 ... 4096, overflow
+#define TCAL_NBINS 4096
+#define TCAL_NBINS_TOTAL (TCAL_NBINS + 2)
+
+/**
+ * Read-only view of the raw TDC distribution of a module with
+ * prefix sums, so that any integral costs two lookups. The
+ * accessors follow TH1F with 4096 bins from 0.5 to 4096.5,
+ * including the clamping of the bin limits in Integral().
+ */
+class R3BTCalEngine::Distribution
 {
-    char strName[255];
-    for (Int_t i = 0; i < fNModules; i++)
+  public:
+    Distribution(const std::vector<UInt_t>& counts, Long64_t entries)
+        : fCounts(counts)
+        , fPrefix(TCAL_NBINS_TOTAL + 1, 0)
+        , fEntries(entries)
+        , fMean(0.)
     {
-        sprintf(strName, "%s_tcaldata_%d", fCal_Par->GetName(), i);
-        fhData[i] = new TH1F(strName, "", 4096, 0.5, 4096.5);
-        sprintf(strName, "%s_time_%d", fCal_Par->GetName(), i);
-        fhTime[i] = new TH1F(strName, "", 4096, 0.5, 4096.5);
+        Long64_t sumw = 0, sumwx = 0;
+        for (Int_t i = 0; i < TCAL_NBINS_TOTAL; i++)
+        {
+            fPrefix[i + 1] = fPrefix[i] + fCounts[i];
+            if (i >= 1 && i <= TCAL_NBINS)
+            {
+                sumw += fCounts[i];
+                sumwx += (Long64_t)i * fCounts[i];
+            }
+        }
+        if (sumw > 0)
+        {
+            fMean = (Double_t)sumwx / (Double_t)sumw;
+        }
     }
-}
 
-R3BTCalEngine::~R3BTCalEngine()
-{
-    for (Int_t i = 0; i < fNModules; i++)
+    inline Double_t Integral(Int_t binx1, Int_t binx2) const
     {
-        if (fhData[i])
+        if (binx1 < 0)
         {
-            delete fhData[i];
+            binx1 = 0;
         }
-        if (fhTime[i])
+        if (binx2 >= TCAL_NBINS_TOTAL || binx2 < binx1)
         {
-            delete fhTime[i];
+            binx2 = TCAL_NBINS_TOTAL - 1;
         }
+        if (binx1 > binx2)
+        {
+            return 0.;
+        }
+        return (Double_t)(fPrefix[binx2 + 1] - fPrefix[binx1]);
     }
-    delete fhData;
-    delete fhTime;
-}
 
-void R3BTCalEngine::Fill(Int_t iModule, Int_t tdc)
+    inline Double_t GetBinContent(Int_t bin) const
+    {
+        if (bin < 0 || bin >= TCAL_NBINS_TOTAL)
+        {
+            return 0.;
+        }
+        return (Double_t)fCounts[bin];
+    }
+
+    inline Double_t GetEntries() const
+    {
+        return (Double_t)fEntries;
+    }
+
+    inline Double_t GetMean() const
+    {
+        return fMean;
+    }
+
+  private:
+    const std::vector<UInt_t>& fCounts;
+    std::vector<Long64_t> fPrefix;
+    Long64_t fEntries;
+    Double_t fMean;
+};
+
+/**
+ * Calibration of a single module, filled by CalibrateModule().
+ */
+struct R3BTCalEngine::Result
 {
-    if (iModule < fNModules && iModule >= 0)
+    struct Segment
+    {
+        Int_t binLow;
+        Int_t binUp;
+        Double_t slope;
+        Double_t offset;
+    };
+
+    Result()
+        : calibrated(kFALSE)
+        , ic(0)
+        , iMin(-1)
+        , iMax(TCAL_NBINS_TOTAL - 1)
     {
-        fhData[iModule]->Fill(tdc);
     }
+
+    Bool_t calibrated; /**< Enough statistics, range and segments are valid. */
+    Int_t ic;
+    Int_t iMin;
+    Int_t iMax;
+    std::vector<Segment> segments;
+};
+
+R3BTCalEngine::R3BTCalEngine(R3BTCalPar* param, Int_t nModules, Int_t minStats)
+    : fMinStats(minStats)
+    , fNModules(nModules)
+    , fCounts(nModules)
+    , fEntries(nModules, 0)
+    , fCal_Par(param)
+    , fClockFreq(0.)
+    , fNThreads(0)
+    , fWriteHistograms(kTRUE)
+{
 }
 
-void R3BTCalEngine::CalculateParamTacquila()
+R3BTCalEngine::~R3BTCalEngine()
 {
-    fClockFreq = 1. / TACQUILA_CLOCK_MHZ * 1000.;
+}
 
-    for (Int_t iModule = 0; iModule < fNModules; iModule++)
+void R3BTCalEngine::Fill(Int_t iModule, Int_t tdc)
+{
+    if (iModule < fNModules && iModule >= 0)
     {
-        if (fhData[iModule]->GetEntries() < fMinStats)
+        std::vector<UInt_t>& counts = fCounts[iModule];
+        if (counts.empty())
         {
-            continue;
+            counts.resize(TCAL_NBINS_TOTAL, 0);
         }
-
-        // Define range of channels
-        Int_t ic, iMin, iMax;
-        FindRange(fhData[iModule], ic, iMin, iMax);
-        if (iMin < 0 || iMax > 4095)
+        if (tdc < 1)
         {
-            return;
+            tdc = 0;
         }
-        LOG(INFO) << "R3BTCalEngine::CalculateParamTacquila() : Range of channels: " << iMin << " - " << iMax
-                  << FairLogger::endl;
-        
-        Double_t total = fhData[iModule]->Integral(iMin, iMax);
-        for(Int_t i = iMin; i <= iMax; i++)
+        else if (tdc > TCAL_NBINS)
         {
-            fhTime[iModule]->SetBinContent(i, fhData[iModule]->Integral(iMin, i) / total * fClockFreq);
+            tdc = TCAL_NBINS_TOTAL - 1;
         }
+        counts[tdc] += 1;
+        fEntries[iModule] += 1;
+    }
+}
 
-        Int_t nparam = 0;
-
-        R3BTCalModulePar* pTCal = NULL;
-        pTCal = new R3BTCalModulePar();
-        pTCal->SetModuleId(iModule);
+void R3BTCalEngine::CalculateParamTacquila()
+{
+    fClockFreq = 1. / TACQUILA_CLOCK_MHZ * 1000.;
+    CalculateParam(kFALSE, "CalculateParamTacquila");
+}
 
-        Int_t il = ic - 10 + 1;
-        Int_t ih = ic;
-        while (il > iMin)
-        {
-            Double_t slope = 0, offset = 0;
-            LinearDown(fhData[iModule], iMin, iMax, il, ih, slope, offset);
+void R3BTCalEngine::CalculateParamVFTX()
+{
+    fClockFreq = 1. / VFTX_CLOCK_MHZ * 1000.;
+    CalculateParam(kTRUE, "CalculateParamVFTX");
+}
 
-            pTCal->SetBinLowAt(il, nparam);
-            pTCal->SetBinUpAt(ih, nparam);
-            pTCal->SetSlopeAt(slope, nparam);
-            pTCal->SetOffsetAt(offset, nparam);
-            pTCal->IncrementNofChannels();
+void R3BTCalEngine::CalculateParam(Bool_t vftx, const char* method)
+{
+    // Calibrate all modules with enough statistics in parallel
+    std::vector<Result> results(fNModules);
 
-            nparam += 1;
+    Int_t nThreads = fNThreads;
+    if (nThreads <= 0)
+    {
+        nThreads = std::max(1, (Int_t)std::thread::hardware_concurrency());
+    }
+    nThreads = std::max(1, std::min(nThreads, fNModules));
 
-            ih = il;
-            il = ih - 10 + 1;
+    std::atomic<Int_t> nextModule(0);
+    auto worker = [&]() {
+        Int_t iModule;
+        while ((iModule = nextModule++) < fNModules)
+        {
+            CalibrateModule(iModule, vftx, results[iModule]);
         }
+    };
 
-        if (ih > iMin)
+    if (nThreads == 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for (Int_t i = 0; i < nThreads; i++)
         {
-            Double_t slope = 0, offset = 0;
-            Double_t tot = fhData[iModule]->Integral(iMin, iMax);
-            Double_t t1 = 0.;
-            Double_t t2 = fhData[iModule]->Integral(iMin, ih) / tot * fClockFreq;
-            slope = (t2 - t1) / (Double_t)(ih - iMin);
-            offset = t1;
-
-            pTCal->SetBinLowAt(iMin, nparam);
-            pTCal->SetBinUpAt(ih, nparam);
-            pTCal->SetSlopeAt(slope, nparam);
-            pTCal->SetOffsetAt(offset, nparam);
-            pTCal->IncrementNofChannels();
-
-            nparam += 1;
+            threads.push_back(std::thread(worker));
+        }
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
         }
+    }
 
-        il = ic;
-        ih = ic + 10 - 1;
-        while (ih <= iMax)
+    // Store the parameters in module order
+    for (Int_t iModule = 0; iModule < fNModules; iModule++)
+    {
+        const Result& result = results[iModule];
+        if (fEntries[iModule] < fMinStats)
         {
-            Double_t slope = 0, offset = 0;
-            LinearUp(fhData[iModule], iMin, iMax, il, ih, slope, offset);
+            continue;
+        }
 
-            pTCal->SetBinLowAt(il, nparam);
-            pTCal->SetBinUpAt(ih, nparam);
-            pTCal->SetSlopeAt(slope, nparam);
-            pTCal->SetOffsetAt(offset, nparam);
-            pTCal->IncrementNofChannels();
+        if (!result.calibrated)
+        {
+            LOG(ERROR) << "R3BTCalEngine::" << method << "() : Module: " << iModule
+                       << " has no valid range of channels: " << result.iMin << " - " << result.iMax
+                       << FairLogger::endl;
+            return;
+        }
+        LOG(INFO) << "R3BTCalEngine::" << method << "() : Range of channels: " << result.iMin << " - "
+                  << result.iMax << FairLogger::endl;
 
-            nparam += 1;
+        R3BTCalModulePar* pTCal = new R3BTCalModulePar();
+        pTCal->SetModuleId(iModule);
 
-            il = ih;
-            if ((iMax - ih) < 100)
-            {
-                ih = il + 5 - 1;
-            }
-            else
+        Int_t nparam = 0;
+        for (size_t i = 0; i < result.segments.size(); i++)
+        {
+            const Result::Segment& segment = result.segments[i];
+            pTCal->SetBinLowAt(segment.binLow, nparam);
+            if (!vftx)
             {
-                ih = il + 10 - 1;
+                pTCal->SetBinUpAt(segment.binUp, nparam);
+                pTCal->SetSlopeAt(segment.slope, nparam);
             }
-        }
-
-        if (il < iMax)
-        {
-            Double_t slope = 0, offset = 0;
-            Double_t tot = fhData[iModule]->Integral(iMin, iMax);
-            Double_t t1 = fhData[iModule]->Integral(iMin, il) / tot * fClockFreq;
-            Double_t t2 = fClockFreq;
-            slope = (t2 - t1) / (Double_t)(iMax - il);
-            offset = t1;
-
-            pTCal->SetBinLowAt(il, nparam);
-            pTCal->SetBinUpAt(iMax, nparam);
-            pTCal->SetSlopeAt(slope, nparam);
-            pTCal->SetOffsetAt(offset, nparam);
+            pTCal->SetOffsetAt(segment.offset, nparam);
             pTCal->IncrementNofChannels();
-
             nparam += 1;
         }
 
         fCal_Par->AddModulePar(pTCal);
 
-        LOG(INFO) << "R3BTCalEngine::CalculateParamTacquila() : Number of parameters: " << nparam << FairLogger::endl;
+        LOG(INFO) << "R3BTCalEngine::" << method << "() : Number of parameters: " << nparam << FairLogger::endl;
 
-        fhData[iModule]->Write();
-        fhTime[iModule]->Write();
+        if (fWriteHistograms)
+        {
+            Distribution h1(fCounts[iModule], fEntries[iModule]);
+            WriteHistograms(iModule, h1, result.iMin, result.iMax);
+        }
 
-        LOG(INFO) << "R3BTCalEngine::CalculateParamTacquila() : Module: " << iModule << " is calibrated."
+        LOG(INFO) << "R3BTCalEngine::" << method << "() : Module: " << iModule << " is calibrated."
                   << FairLogger::endl
                   << FairLogger::endl;
     }
@@ -181,80 +261,167 @@ void R3BTCalEngine::CalculateParamTacquila()
     fCal_Par->setChanged();
 }
 
-void R3BTCalEngine::CalculateParamVFTX()
+void R3BTCalEngine::CalibrateModule(Int_t iModule, Bool_t vftx, Result& result) const
 {
-    fClockFreq = 1. / VFTX_CLOCK_MHZ * 1000.;
-    
-    for (Int_t iModule = 0; iModule < fNModules; iModule++)
+    if (fEntries[iModule] < fMinStats)
     {
-        if (fhData[iModule]->GetEntries() < fMinStats)
-        {
-            continue;
-        }
-        
-        // Define range of channels
-        Int_t ic, iMin, iMax;
-        FindRange(fhData[iModule], ic, iMin, iMax);
-        if (iMin < 0 || iMax > 4095)
+        return;
+    }
+
+    Distribution h1(fCounts[iModule], fEntries[iModule]);
+
+    // Define range of channels
+    Int_t ic, iMin, iMax;
+    FindRange(h1, ic, iMin, iMax);
+    result.ic = ic;
+    result.iMin = iMin;
+    result.iMax = iMax;
+    if (iMin < 0 || iMax > 4095)
+    {
+        return;
+    }
+
+    Double_t total = h1.Integral(iMin, iMax);
+    Result::Segment segment;
+
+    if (vftx)
+    {
+        result.segments.reserve(iMax - iMin + 1);
+        for (Int_t ibin = iMin; ibin <= iMax; ibin++)
         {
-            return;
+            Double_t time = h1.Integral(iMin, ibin) / total;
+            if (time > 1.)
+            {
+                FairLogger::GetLogger()->Fatal(MESSAGE_ORIGIN, "Integration error.");
+            }
+            segment.binLow = ibin;
+            segment.binUp = 0;
+            segment.slope = 0.;
+            segment.offset = time * fClockFreq;
+            result.segments.push_back(segment);
         }
-        LOG(INFO) << "R3BTCalEngine::CalculateParamVFTX() : Range of channels: " << iMin << " - " << iMax
-        << FairLogger::endl;
-        
-        Double_t total = fhData[iModule]->Integral(iMin, iMax);
-        for(Int_t i = iMin; i <= iMax; i++)
+        result.calibrated = kTRUE;
+        return;
+    }
+
+    Int_t il = ic - 10 + 1;
+    Int_t ih = ic;
+    while (il > iMin)
+    {
+        Double_t slope = 0, offset = 0;
+        LinearDown(h1, iMin, iMax, il, ih, slope, offset);
+
+        segment.binLow = il;
+        segment.binUp = ih;
+        segment.slope = slope;
+        segment.offset = offset;
+        result.segments.push_back(segment);
+
+        ih = il;
+        il = ih - 10 + 1;
+    }
+
+    if (ih > iMin)
+    {
+        Double_t t1 = 0.;
+        Double_t t2 = h1.Integral(iMin, ih) / total * fClockFreq;
+
+        segment.binLow = iMin;
+        segment.binUp = ih;
+        segment.slope = (t2 - t1) / (Double_t)(ih - iMin);
+        segment.offset = t1;
+        result.segments.push_back(segment);
+    }
+
+    il = ic;
+    ih = ic + 10 - 1;
+    while (ih <= iMax)
+    {
+        Double_t slope = 0, offset = 0;
+        LinearUp(h1, iMin, iMax, il, ih, slope, offset);
+
+        segment.binLow = il;
+        segment.binUp = ih;
+        segment.slope = slope;
+        segment.offset = offset;
+        result.segments.push_back(segment);
+
+        il = ih;
+        if ((iMax - ih) < 100)
         {
-            fhTime[iModule]->SetBinContent(i, fhData[iModule]->Integral(iMin, i) / total * fClockFreq);
+            ih = il + 5 - 1;
         }
-        
-        Int_t nparam = 0;
-        
-        R3BTCalModulePar* pTCal = NULL;
-        pTCal = new R3BTCalModulePar();
-        pTCal->SetModuleId(iModule);
-        
-        for(Int_t ibin = iMin; ibin <= iMax; ibin++)
+        else
         {
-            Double_t time = fhData[iModule]->Integral(iMin, ibin) / total;
-            if(time > 1.)
-            {
-                FairLogger::GetLogger()->Fatal(MESSAGE_ORIGIN, "Integration error.");
-            }
-            time *= fClockFreq;
-            
-            pTCal->SetBinLowAt(ibin, nparam);
-            pTCal->SetOffsetAt(time, nparam);
-            pTCal->IncrementNofChannels();
-            nparam += 1;
+            ih = il + 10 - 1;
         }
-        
-        fCal_Par->AddModulePar(pTCal);
-        
-        LOG(INFO) << "R3BTCalEngine::CalculateParamVFTX() : Number of parameters: " << nparam << FairLogger::endl;
-
-        fhData[iModule]->Write();
-        fhTime[iModule]->Write();
-        
-        LOG(INFO) << "R3BTCalEngine::CalculateParamVFTX() : Module: " << iModule << " is calibrated."
-        << FairLogger::endl
-        << FairLogger::endl;
     }
 
-    fCal_Par->setChanged();
+    if (il < iMax)
+    {
+        Double_t t1 = h1.Integral(iMin, il) / total * fClockFreq;
+        Double_t t2 = fClockFreq;
+
+        segment.binLow = il;
+        segment.binUp = iMax;
+        segment.slope = (t2 - t1) / (Double_t)(iMax - il);
+        segment.offset = t1;
+        result.segments.push_back(segment);
+    }
+
+    result.calibrated = kTRUE;
 }
 
-void R3BTCalEngine::FindRange(TH1F* h1, Int_t& ic, Int_t& iMin, Int_t& iMax)
+void R3BTCalEngine::WriteHistograms(Int_t iModule, const Distribution& h1, Int_t iMin, Int_t iMax) const
 {
-    Double_t mean = h1->GetMean();
+    char strName[255];
+    sprintf(strName, "%s_tcaldata_%d", fCal_Par->GetName(), iModule);
+    TH1F hData(strName, "", TCAL_NBINS, 0.5, TCAL_NBINS + 0.5);
+    sprintf(strName, "%s_time_%d", fCal_Par->GetName(), iModule);
+    TH1F hTime(strName, "", TCAL_NBINS, 0.5, TCAL_NBINS + 0.5);
+    hData.SetDirectory(0);
+    hTime.SetDirectory(0);
+
+    for (Int_t i = 0; i < TCAL_NBINS_TOTAL; i++)
+    {
+        hData.SetBinContent(i, h1.GetBinContent(i));
+    }
+    // Restore the statistics of the filled histogram
+    Double_t stats[4];
+    stats[0] = stats[1] = h1.Integral(1, TCAL_NBINS);
+    stats[2] = stats[0] * h1.GetMean();
+    stats[3] = 0.;
+    for (Int_t i = 1; i <= TCAL_NBINS; i++)
+    {
+        stats[3] += h1.GetBinContent(i) * i * i;
+    }
+    hData.PutStats(stats);
+    hData.SetEntries(h1.GetEntries());
+
+    Double_t total = h1.Integral(iMin, iMax);
+    for (Int_t i = iMin; i <= iMax; i++)
+    {
+        hTime.SetBinContent(i, h1.Integral(iMin, i) / total * fClockFreq);
+    }
+
+    hData.Write();
+    hTime.Write();
+}
+
+void R3BTCalEngine::FindRange(const Distribution& h1, Int_t& ic, Int_t& iMin, Int_t& iMax) const
+{
+    iMin = -1;
+    iMax = TCAL_NBINS_TOTAL - 1;
+
+    Double_t mean = h1.GetMean();
     ic = (Int_t)(mean + 0.5);
-    Double_t top = h1->Integral(ic - 4, ic + 5) / 10.;
+    Double_t top = h1.Integral(ic - 4, ic + 5) / 10.;
 
     for (Int_t i = ic; i >= 1; i--)
     {
-        if (h1->GetBinContent(i) < 0.1 * top)
+        if (h1.GetBinContent(i) < 0.1 * top)
         {
-            if (h1->Integral(i - 9, i) / 10. < 0.1 * top)
+            if (h1.Integral(i - 9, i) / 10. < 0.1 * top)
             {
                 iMin = i - 1;
                 break;
@@ -262,11 +429,11 @@ void R3BTCalEngine::FindRange(TH1F* h1, Int_t& ic, Int_t& iMin, Int_t& iMax)
         }
     }
 
-    for (Int_t i = ic + 1; i <= 4096; i++)
+    for (Int_t i = ic + 1; i <= TCAL_NBINS; i++)
     {
-        if (h1->GetBinContent(i) < 0.1 * top)
+        if (h1.GetBinContent(i) < 0.1 * top)
         {
-            if (h1->Integral(i, i + 9) / 10. < 0.1 * top)
+            if (h1.Integral(i, i + 9) / 10. < 0.1 * top)
             {
                 //iMax = i - 1;
                 iMax = i;
@@ -276,11 +443,17 @@ void R3BTCalEngine::FindRange(TH1F* h1, Int_t& ic, Int_t& iMin, Int_t& iMax)
     }
 }
 
-void R3BTCalEngine::LinearUp(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t& ih, Double_t& slope, Double_t& offset)
+void R3BTCalEngine::LinearUp(const Distribution& h1,
+                             Int_t iMin,
+                             Int_t iMax,
+                             Int_t& il,
+                             Int_t& ih,
+                             Double_t& slope,
+                             Double_t& offset) const
 {
-    Double_t tot = h1->Integral(iMin, iMax);
-    Double_t t1 = h1->Integral(iMin, il) / tot; // * fClockFreq;
-    Double_t t2 = h1->Integral(iMin, ih) / tot; // * fClockFreq;
+    Double_t tot = h1.Integral(iMin, iMax);
+    Double_t t1 = h1.Integral(iMin, il) / tot; // * fClockFreq;
+    Double_t t2 = h1.Integral(iMin, ih) / tot; // * fClockFreq;
     if (t1 > 1. || t2 > 1.)
     {
         Fatal("LinearUp", "Integration error");
@@ -290,7 +463,7 @@ void R3BTCalEngine::LinearUp(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t&
     slope = (t2 - t1) / (Double_t)(ih - il);
     offset = t1;
 
-    Double_t prec = 3. / TMath::Sqrt(h1->GetEntries());
+    Double_t prec = 3. / TMath::Sqrt(h1.GetEntries());
 
     Double_t slope1;
 
@@ -302,7 +475,7 @@ void R3BTCalEngine::LinearUp(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t&
         {
             break;
         }
-        Double_t t21 = h1->Integral(iMin, ih_next) / tot * fClockFreq;
+        Double_t t21 = h1.Integral(iMin, ih_next) / tot * fClockFreq;
         slope1 = (t21 - t1) / (Double_t)(ih_next - il);
 
         Double_t dev = TMath::Abs(slope1 - slope) / TMath::Abs(slope);
@@ -318,21 +491,21 @@ void R3BTCalEngine::LinearUp(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t&
     }
 }
 
-void R3BTCalEngine::LinearDown(TH1F* h1,
+void R3BTCalEngine::LinearDown(const Distribution& h1,
                                Int_t iMin,
                                Int_t iMax,
                                Int_t& il,
                                Int_t& ih,
                                Double_t& slope,
-                               Double_t& offset)
+                               Double_t& offset) const
 {
-    Double_t tot = h1->Integral(iMin, iMax);
-    Double_t t1 = h1->Integral(iMin, il) / tot * fClockFreq;
-    Double_t t2 = h1->Integral(iMin, ih) / tot * fClockFreq;
+    Double_t tot = h1.Integral(iMin, iMax);
+    Double_t t1 = h1.Integral(iMin, il) / tot * fClockFreq;
+    Double_t t2 = h1.Integral(iMin, ih) / tot * fClockFreq;
     slope = (t2 - t1) / (Double_t)(ih - il);
     offset = t1;
 
-    Double_t prec = 3. / TMath::Sqrt(h1->GetEntries());
+    Double_t prec = 3. / TMath::Sqrt(h1.GetEntries());
 
     Double_t slope1;
     Double_t offset1;
@@ -345,8 +518,8 @@ void R3BTCalEngine::LinearDown(TH1F* h1,
         {
             break;
         }
-        Double_t t11 = h1->Integral(iMin, il_next) / tot * fClockFreq;
-        Double_t t21 = h1->Integral(iMin, ih_next) / tot * fClockFreq;
+        Double_t t11 = h1.Integral(iMin, il_next) / tot * fClockFreq;
+        Double_t t21 = h1.Integral(iMin, ih_next) / tot * fClockFreq;
         slope1 = (t21 - t11) / (Double_t)(ih_next - il_next);
         offset1 = t11;
 
@@ -7,6 +7,8 @@
 
 #include "TObject.h"
 
+#include <vector>
+
 class TH1F;
 class R3BTCalPar;
 
@@ -17,6 +19,9 @@ class R3BTCalPar;
  * clock cycle in ns is calculated from it.
  * Recommended value of minimum statistics per module is
  * 10000 entries.
+ * Raw TDC distributions are kept as plain integer counts per
+ * module, allocated on first use. Modules are calibrated in
+ * parallel, the parameters are stored in module order.
  * @author D. Kresan
  * @since September 4, 2015
  */
@@ -61,20 +66,60 @@ class R3BTCalEngine : public TObject
      */
     void CalculateParamVFTX();
 
+    /**
+     * Sets the number of threads used to calibrate the modules.
+     * @param nThreads a number of threads, 0 (default) uses all cores.
+     */
+    inline void SetNThreads(Int_t nThreads)
+    {
+        fNThreads = nThreads;
+    }
+
+    /**
+     * Enables or disables writing of the raw TDC distribution and
+     * of the bin-by-bin calibration of each calibrated module as
+     * histograms to the current output file (QA). Enabled by default.
+     * @param write kTRUE to write the histograms.
+     */
+    inline void SetWriteHistograms(Bool_t write)
+    {
+        fWriteHistograms = write;
+    }
+
   protected:
+    class Distribution;
+    struct Result;
+
+    /**
+     * A method to calibrate a single module. Does not modify the
+     * engine and can be called from several threads at once.
+     * @param iModule an index of a module.
+     * @param vftx kTRUE for VFTX, kFALSE for Tacquila electronics.
+     * @param result output: range and calibration segments.
+     */
+    void CalibrateModule(Int_t iModule, Bool_t vftx, Result& result) const;
+
+    /**
+     * A method to calculate calibration parameters of all modules
+     * and store them in the parameter container.
+     * @param vftx kTRUE for VFTX, kFALSE for Tacquila electronics.
+     * @param method name of the calling method, used in log messages.
+     */
+    void CalculateParam(Bool_t vftx, const char* method);
+
     /**
      * A method to determine the range of a TDC distribution.
-     * @param h1 a pointer to the histogram with data.
+     * @param h1 a raw TDC distribution.
      * @param ic output: center of distribution.
-     * @param iMin output: lower bound.
-     * @param iMax output: upper bound.
+     * @param iMin output: lower bound, -1 if not found.
+     * @param iMax output: upper bound, 4097 if not found.
      */
-    void FindRange(TH1F* h1, Int_t& ic, Int_t& iMin, Int_t& iMax);
+    void FindRange(const Distribution& h1, Int_t& ic, Int_t& iMin, Int_t& iMax) const;
 
     /**
      * A method to interpolate a section of the raw TDC distribution
      * starting from the middle towards the lower bound.
-     * @param h1 a pointer to the histogram with data.
+     * @param h1 a raw TDC distribution.
      * @param iMin a lower bound.
      * @param iMax an upper bound.
      * @param il an initial value and output of a lower bound of the section.
@@ -82,12 +127,18 @@ class R3BTCalEngine : public TObject
      * @param slope output: a slope of linear interpolation.
      * @param offset output: an offset of linear interpolation (value at il).
      */
-    void LinearUp(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t& ih, Double_t& slope, Double_t& offset);
+    void LinearUp(const Distribution& h1,
+                  Int_t iMin,
+                  Int_t iMax,
+                  Int_t& il,
+                  Int_t& ih,
+                  Double_t& slope,
+                  Double_t& offset) const;
 
     /**
      * A method to interpolate a section of the raw TDC distribution
      * starting from the middle towards the upper bound.
-     * @param h1 a pointer to the histogram with data.
+     * @param h1 a raw TDC distribution.
      * @param iMin a lower bound.
      * @param iMax an upper bound.
      * @param il an initial value and output of a lower bound of the section.
@@ -95,18 +146,37 @@ class R3BTCalEngine : public TObject
      * @param slope output: a slope of linear interpolation.
      * @param offset output: an offset of linear interpolation (value at il).
      */
-    void LinearDown(TH1F* h1, Int_t iMin, Int_t iMax, Int_t& il, Int_t& ih, Double_t& slope, Double_t& offset);
+    void LinearDown(const Distribution& h1,
+                    Int_t iMin,
+                    Int_t iMax,
+                    Int_t& il,
+                    Int_t& ih,
+                    Double_t& slope,
+                    Double_t& offset) const;
+
+    /**
+     * A method to write the raw TDC distribution and the bin-by-bin
+     * calibration of a module as histograms.
+     * @param iModule an index of a module.
+     * @param h1 a raw TDC distribution.
+     * @param iMin a lower bound.
+     * @param iMax an upper bound.
+     */
+    void WriteHistograms(Int_t iModule, const Distribution& h1, Int_t iMin, Int_t iMax) const;
 
   private:
-    Int_t fMinStats;      /**< Minimum number of entries in raw TDC distribution per module */
-    Int_t fNModules;      /**< Number of detector modules. */
-    TH1F** fhData;        /**< An array of histograms to store raw TDC distributions. */
-    TH1F** fhTime;        /**< An array of histograms to store unparametrized bin-by-bin calibration. */
-    R3BTCalPar* fCal_Par; /**< A pointer to the parameter container. */
-    Double_t fClockFreq;  /**< A clock cycle in [ns]. */
+    Int_t fMinStats;                       /**< Minimum number of entries in raw TDC distribution per module */
+    Int_t fNModules;                       /**< Number of detector modules. */
+    std::vector<std::vector<UInt_t> > fCounts; /**< Raw TDC distributions: counts per TDC value with under- and
+                                                    overflow, empty for modules without data. */
+    std::vector<Long64_t> fEntries;        /**< Number of fills per module. */
+    R3BTCalPar* fCal_Par;                  /**< A pointer to the parameter container. */
+    Double_t fClockFreq;                   /**< A clock cycle in [ns]. */
+    Int_t fNThreads;                       /**< Number of threads for calibration, 0 for all cores. */
+    Bool_t fWriteHistograms;               /**< Write QA histograms of calibrated modules. */
 
   public:
-    ClassDef(R3BTCalEngine, 1)
+    ClassDef(R3BTCalEngine, 2)
 };
 
 #endif
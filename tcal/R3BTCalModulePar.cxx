@@ -3,6 +3,8 @@
 #include "FairParamList.h" // for FairParamList
 #include "FairLogger.h"
 
+#include <algorithm>
+
 using namespace std;
 
 ClassImp(R3BTCalModulePar);
@@ -12,6 +14,12 @@ R3BTCalModulePar::R3BTCalModulePar(const char* name, const char* title, const ch
     , fModuleId(0)
     , fSide(0)
     , fNofChannels(0)
+    , fLookup(kLookupLinear)
+    , fNoOverlap(kFALSE)
+    , fSorted()
+    , fTableVFTX(kFALSE)
+    , fTableMin(0)
+    , fTable()
 {
     // Reset all parameters
     clear();
@@ -39,6 +47,7 @@ void R3BTCalModulePar::putParams(FairParamList* list)
 
 Bool_t R3BTCalModulePar::getParams(FairParamList* list)
 {
+    fLookup = kLookupLinear;
     if (!list)
     {
         return kFALSE;
@@ -78,6 +87,7 @@ Bool_t R3BTCalModulePar::getParams(FairParamList* list)
 void R3BTCalModulePar::clear()
 {
     fModuleId = fSide = fNofChannels = 0;
+    fLookup = kLookupLinear;
     // <DB> Not so much overhead here.
     for (Int_t i = 0; i < NCHMAX; i++)
     {
@@ -103,6 +113,19 @@ void R3BTCalModulePar::printParams()
 
 Double_t R3BTCalModulePar::GetTimeTacquila(Int_t tdc)
 {
+    if (fLookup == kLookupTable && !fTableVFTX)
+    {
+        if (tdc < fTableMin || tdc >= fTableMin + (Int_t)fTable.size())
+        {
+            return -10000.;
+        }
+        return fTable[tdc - fTableMin];
+    }
+    if (fLookup != kLookupLinear && fNoOverlap)
+    {
+        return FindTacquila(tdc);
+    }
+
     for (Int_t i = 0; i < fNofChannels; i++)
     {
         if (tdc >= fBinLow[i] && tdc <= fBinUp[i])
@@ -116,6 +139,19 @@ Double_t R3BTCalModulePar::GetTimeTacquila(Int_t tdc)
 
 Double_t R3BTCalModulePar::GetTimeVFTX(Int_t tdc)
 {
+    if (fLookup == kLookupTable && fTableVFTX)
+    {
+        if (tdc < fTableMin || tdc >= fTableMin + (Int_t)fTable.size())
+        {
+            return -10000.;
+        }
+        return fTable[tdc - fTableMin];
+    }
+    if (fLookup != kLookupLinear)
+    {
+        return FindVFTX(tdc);
+    }
+
     for (Int_t i = 0; i < fNofChannels; i++)
     {
         if (tdc == fBinLow[i])
@@ -126,3 +162,136 @@ Double_t R3BTCalModulePar::GetTimeVFTX(Int_t tdc)
     }
     return -10000.;
 }
+
+namespace
+{
+    // Orders segment indices by lower TDC, then by index
+    struct SegmentLess
+    {
+        const Int_t* low;
+        bool operator()(Int_t a, Int_t b) const
+        {
+            return low[a] < low[b] || (low[a] == low[b] && a < b);
+        }
+    };
+}
+
+Long64_t R3BTCalModulePar::BuildLookup(Int_t mode, Bool_t vftx, Long64_t maxTableBytes)
+{
+    fLookup = kLookupLinear;
+    fSorted.clear();
+    fTable.clear();
+    if (mode == kLookupLinear || fNofChannels <= 0 || fNofChannels > NCHMAX)
+    {
+        return 0;
+    }
+
+    for (Int_t i = 0; i < fNofChannels; i++)
+    {
+        fSorted.push_back(i);
+    }
+    SegmentLess less = { fBinLow };
+    std::sort(fSorted.begin(), fSorted.end(), less);
+    // Empty segments (upper < lower TDC) count as covering their lower TDC,
+    // so that they cannot hide an earlier segment from the binary search
+    fNoOverlap = kTRUE;
+    for (size_t k = 1; k < fSorted.size(); k++)
+    {
+        if (fBinLow[fSorted[k]] <= std::max(fBinLow[fSorted[k - 1]], fBinUp[fSorted[k - 1]]))
+        {
+            fNoOverlap = kFALSE;
+            break;
+        }
+    }
+    fLookup = kLookupBinary;
+    if (mode != kLookupTable || fSorted.empty())
+    {
+        return 0;
+    }
+
+    // Table over the TDC range of the segments. Filling in reverse order
+    // lets the first matching segment win, as in the linear scan.
+    Int_t tdcMin = fBinLow[fSorted.front()];
+    Int_t tdcMax = tdcMin;
+    for (size_t k = 0; k < fSorted.size(); k++)
+    {
+        tdcMax = std::max(tdcMax, vftx ? fBinLow[fSorted[k]] : fBinUp[fSorted[k]]);
+    }
+    Long64_t nBytes = ((Long64_t)tdcMax - tdcMin + 1) * (Long64_t)sizeof(Double_t);
+    if (nBytes > maxTableBytes)
+    {
+        return 0;
+    }
+    fTable.assign(tdcMax - tdcMin + 1, -10000.);
+    fTableMin = tdcMin;
+    fTableVFTX = vftx;
+    for (Int_t i = fNofChannels - 1; i >= 0; i--)
+    {
+        if (vftx)
+        {
+            fTable[fBinLow[i] - tdcMin] = fOffset[i];
+        }
+        else
+        {
+            for (Int_t tdc = fBinLow[i]; tdc <= fBinUp[i]; tdc++)
+            {
+                fTable[tdc - tdcMin] = fOffset[i] + fSlope[i] * (Double_t)(tdc - fBinLow[i]);
+            }
+        }
+    }
+    fLookup = kLookupTable;
+    return nBytes;
+}
+
+Double_t R3BTCalModulePar::FindTacquila(Int_t tdc) const
+{
+    // Last segment starting at or below tdc, the only candidate if segments do not overlap
+    Int_t lo = 0;
+    Int_t hi = fSorted.size();
+    while (lo < hi)
+    {
+        Int_t mid = (lo + hi) / 2;
+        if (fBinLow[fSorted[mid]] <= tdc)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo == 0)
+    {
+        return -10000.;
+    }
+    Int_t i = fSorted[lo - 1];
+    if (tdc > fBinUp[i])
+    {
+        return -10000.;
+    }
+    return fOffset[i] + fSlope[i] * (Double_t)(tdc - fBinLow[i]);
+}
+
+Double_t R3BTCalModulePar::FindVFTX(Int_t tdc) const
+{
+    // First segment (lowest index) with this lower TDC
+    Int_t lo = 0;
+    Int_t hi = fSorted.size();
+    while (lo < hi)
+    {
+        Int_t mid = (lo + hi) / 2;
+        if (fBinLow[fSorted[mid]] < tdc)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo == (Int_t)fSorted.size() || fBinLow[fSorted[lo]] != tdc)
+    {
+        return -10000.;
+    }
+    return fOffset[fSorted[lo]];
+}
@@ -3,6 +3,8 @@
 
 #include "FairParGenericSet.h"
 
+#include <vector>
+
 #define NCHMAX 5000
 
 class FairParamList;
@@ -19,6 +21,17 @@ class FairParamList;
 class R3BTCalModulePar : public FairParGenericSet
 {
   public:
+    /**
+     * Lookup strategies of GetTimeTacquila() and GetTimeVFTX(),
+     * see BuildLookup().
+     */
+    enum ELookup
+    {
+        kLookupLinear = 0, /**< Scan all segments (default). */
+        kLookupBinary = 1, /**< Binary search in the segments sorted by TDC. */
+        kLookupTable = 2   /**< Dense TDC -> time table. */
+    };
+
     /**
      * Standard constructor.
      * @param name a name of container.
@@ -77,6 +90,29 @@ class R3BTCalModulePar : public FairParGenericSet
      */
     Double_t GetTimeVFTX(Int_t tdc);
 
+    /**
+     * Prepare a faster lookup for GetTimeTacquila() and GetTimeVFTX(). Has to be
+     * called after the parameters are read, any setter falls back to kLookupLinear.
+     * kLookupBinary sorts the segments by TDC (O(log n) per lookup). kLookupTable
+     * in addition precomputes the time of every TDC value in the range of the
+     * segments for one electronics type (the other one uses binary search), unless
+     * the table would exceed maxTableBytes. Gives the same times as the linear scan.
+     * @param mode one of ELookup.
+     * @param vftx kTRUE to build the table for VFTX, else for TACQUILA.
+     * @param maxTableBytes memory limit for the table.
+     * @return memory used by the table in bytes.
+     */
+    Long64_t BuildLookup(Int_t mode, Bool_t vftx = kFALSE, Long64_t maxTableBytes = 1 << 20);
+
+    /**
+     * Accessor to the lookup strategy in use.
+     * @return one of ELookup.
+     */
+    Int_t GetLookup() const
+    {
+        return fLookup;
+    }
+
     /** Accessor functions **/
     Int_t GetModuleId() const
     {
@@ -117,22 +153,27 @@ class R3BTCalModulePar : public FairParGenericSet
     void IncrementNofChannels()
     {
         fNofChannels += 1;
+        fLookup = kLookupLinear;
     }
     void SetBinLowAt(Int_t ch, Int_t i)
     {
         fBinLow[i] = ch;
+        fLookup = kLookupLinear;
     }
     void SetBinUpAt(Int_t ch, Int_t i)
     {
         fBinUp[i] = ch;
+        fLookup = kLookupLinear;
     }
     void SetSlopeAt(Double_t slope, Int_t i)
     {
         fSlope[i] = slope;
+        fLookup = kLookupLinear;
     }
     void SetOffsetAt(Double_t offset, Int_t i)
     {
         fOffset[i] = offset;
+        fLookup = kLookupLinear;
     }
 
   private:
@@ -144,6 +185,16 @@ class R3BTCalModulePar : public FairParGenericSet
     Double_t fSlope[NCHMAX];  /**< Slope of liear interpolation. */
     Double_t fOffset[NCHMAX]; /**< Offset of linear interpolation [ns]. */
 
+    Int_t fLookup;                //! Lookup strategy in use, see ELookup.
+    Bool_t fNoOverlap;            //! Sorted segments do not overlap (binary search valid for TACQUILA).
+    std::vector<Int_t> fSorted;   //! Valid segments, sorted by lower TDC.
+    Bool_t fTableVFTX;            //! Table is for VFTX, else for TACQUILA.
+    Int_t fTableMin;              //! TDC value of the first table entry.
+    std::vector<Double_t> fTable; //! Time [ns] per TDC value, -10000 if not calibrated.
+
+    Double_t FindTacquila(Int_t tdc) const;
+    Double_t FindVFTX(Int_t tdc) const;
+
     ClassDef(R3BTCalModulePar, 1);
 };
 
@@ -8,6 +8,8 @@ ClassImp(R3BTCalPar);
 R3BTCalPar::R3BTCalPar(const char* name, const char* title, const char* context, Bool_t own)
     : FairParGenericSet(name, title, context, own)
     , fTCalParams(new TObjArray(NMODULEMAX))
+    , fLookupMode(R3BTCalModulePar::kLookupTable)
+    , fMaxTableBytes(64 << 20)
 {
 }
 
@@ -63,3 +65,24 @@ void R3BTCalPar::printParams()
         }
     }
 }
+
+void R3BTCalPar::BuildLookup(Bool_t vftx)
+{
+    Long64_t budget = fMaxTableBytes;
+    Int_t nTables = 0;
+    for (Int_t i = 0; i < fTCalParams->GetEntriesFast(); i++)
+    {
+        R3BTCalModulePar* t_par = (R3BTCalModulePar*)fTCalParams->At(i);
+        if (!t_par)
+        {
+            continue;
+        }
+        budget -= t_par->BuildLookup(fLookupMode, vftx, budget);
+        if (t_par->GetLookup() == R3BTCalModulePar::kLookupTable)
+        {
+            nTables += 1;
+        }
+    }
+    LOG(INFO) << "R3BTCalPar::BuildLookup : " << GetName() << ", " << nTables << " modules with lookup table ("
+              << (fMaxTableBytes - budget) / 1024 << " kB)" << FairLogger::endl;
+}
@@ -104,11 +104,32 @@ class R3BTCalPar : public FairParGenericSet
         return (R3BTCalModulePar*)fTCalParams->At(idx);
     }
 
+    /**
+     * Method to select the TDC lookup of the modules, used by BuildLookup().
+     * @param mode one of R3BTCalModulePar::ELookup, default kLookupTable.
+     * @param maxTableBytes total memory for dense tables of all modules,
+     * modules beyond this limit use binary search. Default 64 MB.
+     */
+    void SetLookup(Int_t mode, Long64_t maxTableBytes = 64 << 20)
+    {
+        fLookupMode = mode;
+        fMaxTableBytes = maxTableBytes;
+    }
+
+    /**
+     * Method to prepare the selected TDC lookup in all modules.
+     * To be called by the calibration tasks after the parameters are read.
+     * @param vftx kTRUE for VFTX electronics, kFALSE for TACQUILA.
+     */
+    void BuildLookup(Bool_t vftx);
+
   private:
     const R3BTCalPar& operator=(const R3BTCalPar&); /**< an assignment operator */
     R3BTCalPar(const R3BTCalPar&);                  /**< a copy constructor */
 
     TObjArray* fTCalParams; /**< an array with parameter containers of all modules */
+    Int_t fLookupMode;      //! TDC lookup of the modules
+    Long64_t fMaxTableBytes; //! memory limit for the lookup tables
 
     ClassDef(R3BTCalPar, 1);
 };
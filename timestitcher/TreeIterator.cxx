@@ -1,3 +1,6 @@
+
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "TreeIterator.h"
@@ -6,49 +9,93 @@ using namespace std;
 
 namespace R3BCalifaTimestitcher
 {
-   TreeIterator::TreeIterator(vector<TreeWrapper*> &_trees) : trees(_trees)
+   // Min-heap on (time stamp, index): equal time stamps are taken in
+   // the order of the trees
+   typedef greater<pair<uint64_t, unsigned int> > heapcompare_t;
+
+   TreeIterator::TreeIterator(vector<TreeWrapper*> &_trees) : trees(_trees), tsMax(0), iMax(0)
    {
    }
 
    TreeWrapper* TreeIterator::first()
    {
-      TreeWrapper *t_min = NULL;
-      uint64_t ts_min = 0, cts;
+      heap.clear();
+      tsMax = 0;
+      iMax = 0;
 
       for(unsigned int i = 0; i < trees.size(); i++)
       {
          if(!trees[i]->next())
             return NULL;
 
-         cts = trees[i]->getTS();
-         if(ts_min == 0 || cts < ts_min)
+         uint64_t cts = trees[i]->getTS();
+         heap.push_back(heapentry_t(cts, i));
+         if(i == 0 || cts > tsMax)
          {
-            ts_min = cts;
-            t_min = trees[i];
+            tsMax = cts;
+            iMax = i;
          }
       }
 
-      return t_min;
+      if(heap.empty())
+         return NULL;
+
+      make_heap(heap.begin(), heap.end(), heapcompare_t());
+      return trees[heap.front().second];
    }
 
    TreeWrapper* TreeIterator::next()
    {
-      TreeWrapper *t_min = NULL;
-      uint64_t ts_min = 0, cts;
+      if(heap.empty())
+         return NULL;
 
-      for(unsigned int i = 0; i < trees.size(); i++)
+      // Advance the tree with the smallest time stamp
+      pop_heap(heap.begin(), heap.end(), heapcompare_t());
+      unsigned int i = heap.back().second;
+      TreeWrapper *t_min = trees[i];
+      if(!t_min->next())
+      {
+         heap.clear();
+         return NULL;
+      }
+
+      uint64_t cts = t_min->getTS();
+      heap.back().first = cts;
+      push_heap(heap.begin(), heap.end(), heapcompare_t());
+      updateMax(i, cts);
+
+      return t_min;
+   }
+
+   void TreeIterator::updateMax(unsigned int i, uint64_t ts)
+   {
+      if(ts >= tsMax)
+      {
+         tsMax = ts;
+         iMax = i;
+      }
+      else if(i == iMax)
       {
-         cts = trees[i]->getTS();
-         if(ts_min == 0 || cts < ts_min)
+         // Only if a tree goes back in time: search again
+         tsMax = ts;
+         for(unsigned int j = 0; j < heap.size(); j++)
          {
-            ts_min = cts;
-            t_min = trees[i];
+            if(heap[j].first > tsMax)
+            {
+               tsMax = heap[j].first;
+               iMax = heap[j].second;
+            }
          }
       }
+   }
 
-      if(!t_min || !t_min->next())
-         return NULL;
+   uint64_t TreeIterator::getMinTS() const
+   {
+      return heap.empty() ? 0 : heap.front().first;
+   }
 
-      return t_min;
+   uint64_t TreeIterator::getMaxTS() const
+   {
+      return tsMax;
    }
 }
@@ -2,25 +2,40 @@
 #define TREEITERATOR_H_
 
 #include <vector>
+#include <utility>
 
 #include "TreeWrapper.h"
 
 namespace R3BCalifaTimestitcher
 {
 
+   // Merges the entries of all trees in time stamp order. The trees
+   // are kept in a binary min-heap on their current time stamp, so
+   // each step costs O(log n) for n trees.
    class TreeIterator
    {
    protected:
+      typedef std::pair<uint64_t, unsigned int> heapentry_t; // (time stamp, index in trees)
+
       std::vector<TreeWrapper*> &trees;
+      std::vector<heapentry_t> heap;
+
+      uint64_t tsMax;       // largest current time stamp
+      unsigned int iMax;    // tree with the largest current time stamp
+
+      void updateMax(unsigned int i, uint64_t ts);
 
    public:
       TreeIterator(std::vector<TreeWrapper*> &trees);
       TreeWrapper *first();
       TreeWrapper* next();
 
+      // Smallest and largest current time stamp of all trees
+      uint64_t getMinTS() const;
+      uint64_t getMaxTS() const;
+
    };
 
 }
 
 #endif
-
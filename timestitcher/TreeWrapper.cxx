@@ -2,6 +2,9 @@
 
 #include "TreeWrapper.h"
 
+// Size of the read cache of each input tree
+#define TREEWRAPPER_CACHE_SIZE 64000000
+
 using namespace std;
 
 namespace R3BCalifaTimestitcher
@@ -10,6 +13,12 @@ namespace R3BCalifaTimestitcher
    TreeWrapper::TreeWrapper(TTree *_tree, uint32_t _id) : tree(_tree), idx(0), id(_id)
    {
       this->nEntries = tree->GetEntries();
+
+      // Read the baskets of all branches through a TTreeCache. With
+      // parallel unzipping enabled (see Timestitch), the cache also
+      // decompresses them ahead of GetEntry in a separate thread.
+      tree->SetCacheSize(TREEWRAPPER_CACHE_SIZE);
+      tree->AddBranchToCache("*", kTRUE);
    }
 
    uint64_t TreeWrapper::getTS()
@@ -19,94 +19,14 @@
 #include "R3BTraPoint.h"
 #include "R3BTrackerHit.h"
 
-
-R3BTraHitFinder::R3BTraHitFinder() : FairTask("R3B Tracker Hit Finder ") { 
-	fThreshold=0.;	   //no threshold
-	fTrackerResolution=0.; //perfect resolution
-}
-
-
-R3BTraHitFinder::~R3BTraHitFinder() {
-}
-
-
-// -----   Public method Init   --------------------------------------------
-InitStatus R3BTraHitFinder::Init() {
-	FairRootManager* ioManager = FairRootManager::Instance();
-	if ( !ioManager ) Fatal("Init", "No FairRootManager");
-	fTrackerHitCA = (TClonesArray*) ioManager->GetObject("TraPoint");
-	
-	
-	// Register output array TraHit
-	fTraHitCA = new TClonesArray("R3BTrackerHit",1000);
-	ioManager->Register("TrackerHit", "Tracker Hit", fTraHitCA, kTRUE);	
-	
-	return kSUCCESS;
-	
-}
+#include <cmath>
 
 
+namespace {
 
-// -----   Public method ReInit   --------------------------------------------
-InitStatus R3BTraHitFinder::ReInit() {
-	
-	
-	return kSUCCESS;
-	
-}
+	// Transformation matrices: (ie transformation from lab to det coord. system)
 
-
-// -----   Public method Exec   --------------------------------------------
-void R3BTraHitFinder::Exec(Option_t* opt) {
-	
-	Reset();
-	
-	// Si Geometrical parameter:
-	// Inner layer
-	Double_t Length1  = 19.03 ; // cm
-	Double_t WidthMax1  = 7.945 ; // cm
-	Double_t WidthMin1  = 2.25 ; // cm
-	Double_t StripPitch1= 0.005 ; // = 50 um
-	//Double_t AngRangeMin1=7.;
-	//Double_t InclAng1=14.9;
-	Double_t AngTrap1=atan((WidthMax1/2 -WidthMin1/2)/Length1);
-	//Double_t WidthHalf1=WidthMax1 - (Length1/cos(AngTrap1))*sin(AngTrap1);
-	Double_t StepZ1= StripPitch1/sin(AngTrap1) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX1= StripPitch1/cos(AngTrap1) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip1   = int(WidthMax1/StepX1); //
-	//LOG(INFO) << "NbStrip1= " << NbStrip1 <<FairLogger::endl;
-	//Double_t ShiftalongZ;
-	Double_t Proj ; // cm
-	Double_t ProjStrip ; // cm
-	Int_t strip=0;
-	Int_t StripA_Id=0;
-	Int_t StripB_Id=0;
-	Double_t SlopA,SlopB,OffsetA,OffsetB;
-	
-	// Middle layer
-	Double_t Length2  = 30.06 ; // cm
-	Double_t WidthMax2  = 10.4 ; // cm
-	Double_t WidthMin2  = 1.3 ; // cm
-	Double_t StripPitch2= 0.005 ; // = 50 um
-	Double_t AngTrap2= 0.14853 ; // in rad = 17/2 degrees
-	Double_t StepZ2= StripPitch2/sin(AngTrap2) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX2= StripPitch2/cos(AngTrap2) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip2   = int(WidthMax2/StepX2); //
-	//LOG(INFO) << "NbStrip2= " << NbStrip2 <<FairLogger::endl;
-	
-    // Outer layer
-	Double_t Length3  = 30.06 ; // cm
-	Double_t WidthMax3  = 10.4 ; // cm
-	Double_t WidthMin3  = 1.3 ; // cm
-	Double_t StripPitch3= 0.005 ; // = 50 um
-	Double_t AngTrap3= 0.14853 ; // in rad = 17/2 degrees
-	Double_t StepZ3= StripPitch3/sin(AngTrap3) ; // step along the z axis of the detector (in xz plan)
-	Double_t StepX3= StripPitch3/cos(AngTrap3) ; // step along the x axis of the detector (in xz plan)
-	Int_t    NbStrip3   = int(WidthMax3/StepX3); //
-	//LOG(INFO) << "NbStrip3= " << NbStrip3 <<FairLogger::endl;
-    
-	
-	Double_t M_Inner[6][4][4]=
+	const Double_t M_Inner[6][4][4]=
     {
 		{
 			{1,           0,             0,            0},  // Matrice 1 row 0
@@ -159,7 +79,7 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 	 */
 	
 	// Middle layer:
-	Double_t M_Mid[12][4][4]=
+	const Double_t M_Mid[12][4][4]=
     {
 		{
 			{1,           0,             0,            0},  // Matrice 1 row 0
@@ -250,7 +170,7 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 	
 	
 	// Outer layer:
-	Double_t M_Out[12][4][4]=  
+	const Double_t M_Out[12][4][4]=  
     {
 		{
 			{1,           0,             0,            0},  // Matrice 1 row 0
@@ -344,7 +264,7 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 	// Transformation inverse matrices: (ie transformation from det coord. system to lab)
 	
 	// Inner layer:
-	Double_t M_INV_Inner[6][4][4]=
+	const Double_t M_INV_Inner[6][4][4]=
     {
 		{
 			{1,             0,            0,            0},  // Matrice 1 row 0
@@ -391,7 +311,7 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
     };
 	
 	// Middle layer:
-	Double_t M_INV_Mid[12][4][4]=
+	const Double_t M_INV_Mid[12][4][4]=
     {
 		{
 			{1,            0,             0,            0},  // Matrice 1 row 0
@@ -481,7 +401,7 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 	
 	
 	// Outer layer:
-	Double_t M_INV_Out[12][4][4]=
+	const Double_t M_INV_Out[12][4][4]=
     {
 		{
 			{1,            0,             0,            0},  // Matrice 1 row 0
@@ -567,7 +487,170 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 			{           0,             0,             0,              1}    // Matrice 12 row 3
 		}
     };
+
+}
+
+
+R3BTraHitFinder::R3BTraHitFinder() : FairTask("R3B Tracker Hit Finder ") { 
+	fThreshold=0.;	   //no threshold
+	fTrackerResolution=0.; //perfect resolution
+}
+
+
+R3BTraHitFinder::~R3BTraHitFinder() {
+}
+
+
+// -----   Public method Init   --------------------------------------------
+InitStatus R3BTraHitFinder::Init() {
+	FairRootManager* ioManager = FairRootManager::Instance();
+	if ( !ioManager ) Fatal("Init", "No FairRootManager");
+	fTrackerHitCA = (TClonesArray*) ioManager->GetObject("TraPoint");
+	
 	
+	// Register output array TraHit
+	fTraHitCA = new TClonesArray("R3BTrackerHit",1000);
+	ioManager->Register("TrackerHit", "Tracker Hit", fTraHitCA, kTRUE);	
+	
+	InitGeometry();
+	
+	return kSUCCESS;
+	
+}
+
+
+
+// -----   Public method ReInit   --------------------------------------------
+InitStatus R3BTraHitFinder::ReInit() {
+	
+	
+	return kSUCCESS;
+	
+}
+
+
+// -----   Private method InitGeometry   --------------------------------------
+// Everything Exec needs from the geometry: the transformations of each
+// ladder and, per layer, the projection at x=0 of the middle line of
+// every strip.
+void R3BTraHitFinder::InitGeometry() {
+	
+	// Si Geometrical parameter:
+	// Inner layer
+	Double_t Length1  = 19.03 ; // cm
+	Double_t WidthMax1  = 7.945 ; // cm
+	Double_t WidthMin1  = 2.25 ; // cm
+	Double_t StripPitch1= 0.005 ; // = 50 um
+	//Double_t AngRangeMin1=7.;
+	//Double_t InclAng1=14.9;
+	Double_t AngTrap1=atan((WidthMax1/2 -WidthMin1/2)/Length1);
+	//Double_t WidthHalf1=WidthMax1 - (Length1/cos(AngTrap1))*sin(AngTrap1);
+	Double_t StepZ1= StripPitch1/sin(AngTrap1) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX1= StripPitch1/cos(AngTrap1) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip1   = int(WidthMax1/StepX1); //
+	
+	// Middle layer
+	Double_t Length2  = 30.06 ; // cm
+	Double_t WidthMax2  = 10.4 ; // cm
+	Double_t WidthMin2  = 1.3 ; // cm
+	Double_t StripPitch2= 0.005 ; // = 50 um
+	Double_t AngTrap2= 0.14853 ; // in rad = 17/2 degrees
+	Double_t StepZ2= StripPitch2/sin(AngTrap2) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX2= StripPitch2/cos(AngTrap2) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip2   = int(WidthMax2/StepX2); //
+	//LOG(INFO) << "NbStrip2= " << NbStrip2 <<FairLogger::endl;
+	
+    // Outer layer
+	Double_t Length3  = 30.06 ; // cm
+	Double_t WidthMax3  = 10.4 ; // cm
+	Double_t WidthMin3  = 1.3 ; // cm
+	Double_t StripPitch3= 0.005 ; // = 50 um
+	Double_t AngTrap3= 0.14853 ; // in rad = 17/2 degrees
+	Double_t StepZ3= StripPitch3/sin(AngTrap3) ; // step along the z axis of the detector (in xz plan)
+	Double_t StepX3= StripPitch3/cos(AngTrap3) ; // step along the x axis of the detector (in xz plan)
+	Int_t    NbStrip3   = int(WidthMax3/StepX3); //
+	
+	Double_t Length[3]= {Length1, Length2, Length3};
+	Double_t WidthMax[3]= {WidthMax1, WidthMax2, WidthMax3};
+	Double_t WidthMin[3]= {WidthMin1, WidthMin2, WidthMin3};
+	Double_t StepZ[3]= {StepZ1, StepZ2, StepZ3};
+	Double_t StepX[3]= {StepX1, StepX2, StepX3};
+	Int_t    NbStrip[3]= {NbStrip1, NbStrip2, NbStrip3};
+	// shift along z axis (TODO: find analytic formula)
+	Double_t ShiftalongZ[3]= {-1.1, -5.5, -5};
+	
+	for(Int_t det=0; det<kNbDet; det++){
+		const Double_t (*M)[4];
+		const Double_t (*M_INV)[4];
+		if(det<6){
+			M= M_Inner[det];
+			M_INV= M_INV_Inner[det];
+		}else if(det<18){
+			M= M_Mid[det-6];
+			M_INV= M_INV_Mid[det-6];
+		}else{
+			M= M_Out[det-18];
+			M_INV= M_INV_Out[det-18];
+		}
+		for(Int_t row=0; row<3; row++){
+			for(Int_t k=0; k<4; k++){
+				fTrans[det][row][k]= M[row][k];
+				fTransInv[det][row][k]= M_INV[row][k];
+			}
+		}
+	}
+	
+	for(Int_t layer=0; layer<3; layer++){
+		fSlopA[layer]= (2*Length[layer])/(WidthMin[layer]-WidthMax[layer]);
+		fHalfStepZ[layer]= StepZ[layer]/2;
+		// Front (A) and back (B) strips have the same projection at x=0,
+		// with SlopB= -SlopA the side B formula reduces to the side A one.
+		fProjStrip[layer].resize(NbStrip[layer]);
+		for(Int_t strip=0; strip<NbStrip[layer]; strip++){
+			fProjStrip[layer][strip]= (-Length[layer]/2 + ShiftalongZ[layer]) - fSlopA[layer]*(WidthMax[layer]/2 - (StepX[layer]/2)*(2*strip+1));
+		}
+		fStepProj[layer]= NbStrip[layer]>1 ?
+		  (fProjStrip[layer][0] - fProjStrip[layer][NbStrip[layer]-1])/(NbStrip[layer]-1) : 0.;
+	}
+	
+}
+
+
+// -----   Private method FindStrip   --------------------------------------
+// The projections decrease with the strip number, so the strips with
+// ProjStrip - Proj < StepZ/2 are those from some strip on. Its number is
+// estimated from the mean step and corrected on the table: the result is
+// the same as scanning all strips, in a few comparisons.
+Int_t R3BTraHitFinder::FindStrip(Int_t layer, Double_t Proj) const {
+	
+	const std::vector<Double_t>& ProjStrip= fProjStrip[layer];
+	Int_t NbStrip= ProjStrip.size();
+	Double_t HalfStepZ= fHalfStepZ[layer];
+	
+	Int_t strip=0;
+	if(fStepProj[layer]>0){
+		Double_t est= (ProjStrip[0] - Proj - HalfStepZ)/fStepProj[layer];
+		if(est>=NbStrip) strip= NbStrip;
+		else if(est>0) strip= Int_t(ceil(est));
+	}
+	while(strip>0 && (ProjStrip[strip-1] - Proj)< HalfStepZ) strip--;
+	while(strip<NbStrip && !((ProjStrip[strip] - Proj)< HalfStepZ)) strip++;
+	
+	if(strip==NbStrip) return -1;
+	return strip;
+	
+}
+
+
+// -----   Public method Exec   --------------------------------------------
+void R3BTraHitFinder::Exec(Option_t* opt) {
+	
+	Reset();
+	
+	Int_t strip;
+	Double_t SlopA,SlopB;
+	Double_t OffsetA=0.;
+	Double_t OffsetB=0.;
 	
 	Double_t Energy = 0.;
 	Double_t X_track= 0;
@@ -585,407 +668,93 @@ void R3BTraHitFinder::Exec(Option_t* opt) {
 	Double_t X_intersect = 0.;   // Position X in Detector frame
 	Double_t Y_intersect = 0.;   // Position Y in Detector frame
 	Double_t Z_intersect = 0.;   // Position Z in Detector frame
-    Double_t Theta = 0.; // Theta from (0,0,0)
-    Double_t Phi = 0.; // Phi (0,0,0)
-	
+	Double_t Theta = 0.; // Theta from (0,0,0)
+	Double_t Phi = 0.; // Phi (0,0,0)
 	
 	Int_t Detector;
+	Int_t Layer;
 	
-	R3BTraPoint** traHit;
-	
-	Int_t traHitsPerEvent = 0;
-	traHitsPerEvent = fTrackerHitCA->GetEntries();
-	
-	//LOG(INFO) << " NEW EVENT " <<FairLogger::endl;
-
-	
-	//LOG(INFO) << traHitsPerEvent FairLogger::endl;
-	
-	//LOG(INFO) << "" <<FairLogger::endl;
-
+	Int_t traHitsPerEvent = fTrackerHitCA->GetEntries();
 	
-	if(traHitsPerEvent>0){
-		traHit = new R3BTraPoint*[traHitsPerEvent];
-		for(Int_t i=0;i<traHitsPerEvent;i++){
-			traHit[i] = new R3BTraPoint;
-			traHit[i] = (R3BTraPoint*) fTrackerHitCA->At(i);
-			Energy = ExpResSmearing(traHit[i]->GetEnergyLoss());
-			//Energy = traHit[i]->GetEnergyLoss();
-			Detector = traHit[i]->GetDetCopyID();
-			
-			X_track = traHit[i]->GetXIn();
-			Y_track = traHit[i]->GetYIn();
-			Z_track = traHit[i]->GetZIn();
-			
-			Px = traHit[i]->GetPxOut();
-			Py = traHit[i]->GetPyOut();
-			Pz = traHit[i]->GetPzOut();
-            
-            
-			if(Detector<=6){  // = inner layer
-				
-				//LOG(INFO) << Detector << " " << j << " " << k <<FairLogger::endl;
-				
-				//LOG(INFO) <<  X_track << " " <<   Y_track << " " <<  Z_track << " " <<FairLogger::endl;
-				
-				// apply transformation M_INV_inner[x][4][4] 
-				X_track_det=  X_track*M_Inner[Detector-1][0][0] 
-				+ Y_track*M_Inner[Detector-1][0][1]
-				+ Z_track*M_Inner[Detector-1][0][2]
-				+               M_Inner[Detector-1][0][3];
-				
-				//LOG(INFO) << M_Inner[Detector-1][0][0] << " " << M_Inner[Detector-1][0][1] << " " << M_Inner[Detector-1][0][2] << " " << M_Inner[Detector-1][0][3] <<FairLogger::endl ;
-				
-				Y_track_det=  X_track*M_Inner[Detector-1][1][0] 
-				+ Y_track*M_Inner[Detector-1][1][1]
-				+ Z_track*M_Inner[Detector-1][1][2]
-				+               M_Inner[Detector-1][1][3];
-				
-				//LOG(INFO) << M_Inner[Detector-1][1][0] << " " << M_Inner[Detector-1][1][1] << " " << M_Inner[Detector-1][1][2] << " " << M_Inner[Detector-1][1][3] <<FairLogger::endl ;
-
-				Z_track_det=  X_track*M_Inner[Detector-1][2][0] 
-				+ Y_track*M_Inner[Detector-1][2][1]
-				+ Z_track*M_Inner[Detector-1][2][2]
-				+               M_Inner[Detector-1][2][3];
-				
-				//LOG(INFO) << M_Inner[Detector-1][2][0] << " " << M_Inner[Detector-1][2][1] << " " << M_Inner[Detector-1][2][2] << " " << M_Inner[Detector-1][2][3] <<FairLogger::endl ;
-
-				//LOG(INFO) <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " <<FairLogger::endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				//SlopA= (2*Length1)/(WidthMax1-WidthMin1);
-				SlopA= (2*Length1)/(WidthMin1-WidthMax1);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopA*(-WidthMax1/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length1/2 -1.1) - SlopA*(WidthMax1/2 - (StepX1/2)*(2*strip+1));  // 1st strip proj at x=0. -1.1 is a shift along z axis (TODO: find analytic formula).
-				
-				//LOG(INFO) << "SlopA= " << SlopA << " Length1= " << Length1 << " WidthMax1= " << WidthMax1 << " WidthMin1= " << WidthMin1 <<FairLogger::endl;
-				//LOG(INFO) << "Proj= " << Proj  << " ProjStrip= " << ProjStrip <<FairLogger::endl;
-				//LOG(INFO) << "StepZ1/2 = " << StepZ1/2  << " ProjStrip - Proj= " << ProjStrip-Proj <<FairLogger::endl;
-				
-				while(strip<NbStrip1)
-				{
-					if( (ProjStrip - Proj)<StepZ1/2 ){
-						// first strip hit is:
-						StripA_Id=strip;
-						//LOG(INFO) << "StripA_Id= " << StripA_Id <<FairLogger::endl;
-						OffsetA= ProjStrip;
-						strip=NbStrip1;  // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopA*(-WidthMax1/2);
-						ProjStrip= (-Length1/2 -1.1) - SlopA*(WidthMax1/2 - (StepX1/2)*(2*strip+1));
-						
-					}
-				}
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopB*(WidthMax1/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length1/2 -1.1) - SlopB*(-WidthMax1/2 + (StepX1/2)*(2*strip+1)); 
-				
-				//LOG(INFO) << "SlopB= " << SlopB << " Length1= " << Length1 << " WidthMax1= " << WidthMax1 << " WidthMin1= " << WidthMin1 <<FairLogger::endl;
-				//LOG(INFO) << "Proj= " << Proj  << " ProjStrip= " << ProjStrip <<FairLogger::endl;
-				//LOG(INFO) << "StepZ1/2 = " << StepZ1/2  << " ProjStrip - Proj= " << ProjStrip-Proj <<FairLogger::endl;
-				
-				while(strip<NbStrip1)
-				{
-					if( (ProjStrip-Proj)<StepZ1/2 ){
-						// 2nd strip hit:
-						StripB_Id=strip;
-						//LOG(INFO) << "StripB_Id= " << StripB_Id <<FairLogger::endl;
-						OffsetB= ProjStrip;
-						strip=NbStrip1; // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length1/2-(StepZ1/2)*(2*strip+1)) - SlopB*(WidthMax1/2);
-						ProjStrip= (-Length1/2 -1.1) - SlopB*(-WidthMax1/2 + (StepX1/2)*(2*strip+1));
-					}
-				}
-				
-				// find intersection of the 2 hit strips:
-				X_intersect= (OffsetB-OffsetA)/(SlopA-SlopB);
-				//X_intersect= X_track_det[j];  
-				Y_intersect= Y_track_det;  
-				Z_intersect= SlopA*X_intersect+OffsetA;  
-				//Z_intersect= Z_track_det[j];
-				
-				// then transform back in Lab frame:
-				
-				X_Hit=   X_intersect*M_INV_Inner[Detector-1][0][0] 
-				+ Y_intersect*M_INV_Inner[Detector-1][0][1]
-				+ Z_intersect*M_INV_Inner[Detector-1][0][2]
-				+             M_INV_Inner[Detector-1][0][3];
-				Y_Hit=   X_intersect*M_INV_Inner[Detector-1][1][0] 
-				+ Y_intersect*M_INV_Inner[Detector-1][1][1]
-				+ Z_intersect*M_INV_Inner[Detector-1][1][2]
-				+             M_INV_Inner[Detector-1][1][3];
-				Z_Hit=   X_intersect*M_INV_Inner[Detector-1][2][0] 
-				+ Y_intersect*M_INV_Inner[Detector-1][2][1]
-				+ Z_intersect*M_INV_Inner[Detector-1][2][2]
-				+             M_INV_Inner[Detector-1][2][3];
-				
-				//LOG(INFO) <<  X_Hit << " " <<   Y_Hit << " " <<  Z_Hit << " " <<FairLogger::endl;
-				
-				
-			}   // end of Det=7 ( inner layer)
-			
-			if(Detector>=7 && Detector<=18){  // = Middle layer
-				
-				//LOG(INFO) << Detector <<FairLogger::endl;
-				
-				// apply transformation M_INV_Mid[x][4][4] 
-				X_track_det=  X_track*M_Mid[Detector-7][0][0] 
-				+ Y_track*M_Mid[Detector-7][0][1]
-				+ Z_track*M_Mid[Detector-7][0][2]
-				+               M_Mid[Detector-7][0][3];
-				Y_track_det=  X_track*M_Mid[Detector-7][1][0] 
-				+ Y_track*M_Mid[Detector-7][1][1]
-				+ Z_track*M_Mid[Detector-7][1][2]
-				+               M_Mid[Detector-7][1][3];
-				Z_track_det=  X_track*M_Mid[Detector-7][2][0] 
-				+ Y_track*M_Mid[Detector-7][2][1]
-				+ Z_track*M_Mid[Detector-7][2][2]
-				+               M_Mid[Detector-7][2][3];
-				
-				//LOG(INFO) <<  X_track << " " <<   Y_track << " " <<  Z_track << " " <<FairLogger::endl;
-				//LOG(INFO) <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " <<FairLogger::endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				//SlopA= (2*Length2)/(WidthMax2-WidthMin2);
-				SlopA= (2*Length2)/(WidthMin2-WidthMax2);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopA*(-WidthMax2/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length2/2 -5.5) - SlopA*(WidthMax2/2 -(StepX2/2)*(2*strip+1));  // 1st strip proj at x=0, -5.5 ia a shift along Z axis (TODO: find the analytic formula)
-				
-				//LOG(INFO) << "SlopA= " << SlopA << " Length2= " << Length2 << " WidthMax2= " << WidthMax2 << " WidthMin2= " << WidthMin2 <<FairLogger::endl;
-				//LOG(INFO) << "Proj= " << Proj  << " ProjStrip= " << ProjStrip <<FairLogger::endl;
-				//LOG(INFO) << "StepZ2/2 = " << StepZ2/2  << " ProjStrip - Proj= " << ProjStrip-Proj <<FairLogger::endl;
-				
-				while(strip<NbStrip2)
-				{
-					if( (ProjStrip - Proj)<StepZ2/2 ){
-						// first strip hit is:
-						StripA_Id=strip;
-						//LOG(INFO) << "StripA_Id= " << StripA_Id <<FairLogger::endl;
-						OffsetA= ProjStrip;
-						strip=NbStrip2;  // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopA*(-WidthMax2/2);
-						ProjStrip= (-Length2/2 -5.5) - SlopA*(WidthMax2/2 -(StepX2/2)*(2*strip+1));
-					}
-				}
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopB*(WidthMax2/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length2/2 -5.5) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-				
-				while(strip<NbStrip2)
-				{
-					if( (ProjStrip-Proj)<StepZ2/2 ){
-						// 2nd strip hit:
-						StripB_Id=strip;
-						//LOG(INFO) << "StripB_Id= " << StripB_Id <<FairLogger::endl;
-						OffsetB= ProjStrip;
-						strip=NbStrip2; // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length2/2-(StepZ2/2)*(2*strip+1)) - SlopB*(WidthMax2/2);
-						ProjStrip= (-Length2/2 -5.5) - SlopB*(-WidthMax2/2 + (StepX2/2)*(2*strip+1));
-					}
-				}
-				
-				// find intersection of the 2 hit strips:
-				X_intersect= (OffsetB-OffsetA)/(SlopA-SlopB);
-				//X_intersect= X_track_det[j];  
-				Y_intersect= Y_track_det;  
-				Z_intersect= SlopA*X_intersect+OffsetA;  
-				//Z_intersect= Z_track_det[j];
-				
-				// then transform back in Lab frame:
-				
-				X_Hit=   X_intersect*M_INV_Mid[Detector-7][0][0] 
-				+ Y_intersect*M_INV_Mid[Detector-7][0][1]
-				+ Z_intersect*M_INV_Mid[Detector-7][0][2]
-				+             M_INV_Mid[Detector-7][0][3];
-				Y_Hit=   X_intersect*M_INV_Mid[Detector-7][1][0] 
-				+ Y_intersect*M_INV_Mid[Detector-7][1][1]
-				+ Z_intersect*M_INV_Mid[Detector-7][1][2]
-				+             M_INV_Mid[Detector-7][1][3];
-				Z_Hit=   X_intersect*M_INV_Mid[Detector-7][2][0] 
-				+ Y_intersect*M_INV_Mid[Detector-7][2][1]
-				+ Z_intersect*M_INV_Mid[Detector-7][2][2]
-				+             M_INV_Mid[Detector-7][2][3];
-				
-				//LOG(INFO) <<  X_Hit << " " <<   Y_Hit << " " <<  Z_Hit << " " <<FairLogger::endl;
-				
-				
-			} 
-			
-			if(Detector>=19){  // = outer layer
-				
-				//LOG(INFO) << Detector <<FairLogger::endl;
-				
-				// apply transformation M_INV_Out[x][4][4] 
-				X_track_det=  X_track*M_Out[Detector-19][0][0] 
-				+ Y_track*M_Out[Detector-19][0][1]
-				+ Z_track*M_Out[Detector-19][0][2]
-				+               M_Out[Detector-19][0][3];
-				Y_track_det=  X_track*M_Out[Detector-18][1][0] 
-				+ Y_track*M_Out[Detector-19][1][1]
-				+ Z_track*M_Out[Detector-19][1][2]
-				+               M_Out[Detector-19][1][3];
-				Z_track_det=  X_track*M_Out[Detector-19][2][0] 
-				+ Y_track*M_Out[Detector-19][2][1]
-				+ Z_track*M_Out[Detector-19][2][2]
-				+               M_Out[Detector-19][2][3];
-				
-				//LOG(INFO) <<  X_track << " " <<   Y_track << " " <<  Z_track << " " <<FairLogger::endl;
-				//LOG(INFO) <<  X_track_det << " " <<   Y_track_det << " " <<  Z_track_det << " " <<FairLogger::endl;
-				
-				// find 1st strip hit:
-				// step 1 : projection parallel to the 1st longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopA= (2*Length3)/(WidthMin3-WidthMax3);
-				//SlopA= (2*Length3)/(WidthMax3-WidthMin3);
-				Proj=  Z_track_det - SlopA*X_track_det;
-				
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopA*(-WidthMax3/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length3/2 -5) - SlopA*(WidthMax3/2 -(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				
-				//LOG(INFO) << "SlopA= " << SlopA << " Length3= " << Length3 << " WidthMax3= " << WidthMax3 << " WidthMin3= " << WidthMin3 <<FairLogger::endl;
-				//LOG(INFO) << "Proj= " << Proj  << " ProjStrip= " << ProjStrip <<FairLogger::endl;
-				//LOG(INFO) << "StepZ3/2 = " << StepZ3/2  << " ProjStrip - Proj= " << ProjStrip-Proj <<FairLogger::endl;
-				
-				while(strip<NbStrip3)
-				{
-					if( (ProjStrip - Proj)<StepZ3/2 ){
-						// first strip hit is:
-						StripA_Id=strip;
-						//LOG(INFO) << "StripA_Id= " << StripA_Id <<FairLogger::endl;
-						OffsetA= ProjStrip;
-						strip=NbStrip3;  // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopA*(-WidthMax3/2);
-						ProjStrip= (-Length3/2 -5) - SlopA*(WidthMax3/2 -(StepX3/2)*(2*strip+1));
-		
-					}
-				}
-				
-				// find 2nd strip hit:
-				// step 1 : projection parallel to the 2nd longitudinal side of the detector (ie: offset at z=0 of this straight line in plane xz)
-				SlopB= -SlopA;
-				Proj=  Z_track_det - SlopB*X_track_det;
-				// step 2 : compare with projection of middle line of each strips.
-				strip=0;
-				ProjStrip=0.;
-				//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopB*(WidthMax3/2);  // 1st strip proj at z=0
-				ProjStrip= (-Length3/2 -5) - SlopB*(-WidthMax3/2 +(StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-				
-				
-				while(strip<NbStrip3)
-				{
-					if( (ProjStrip-Proj)<StepZ3/2 ){
-						// 2nd strip hit:
-						StripB_Id=strip;
-						//LOG(INFO) << "StripB_Id= " << StripB_Id <<FairLogger::endl;
-						OffsetB= ProjStrip;
-						strip=NbStrip3; // to end the loop
-					}else
-					{
-						strip++;
-						//ProjStrip= (-Length3/2-(StepZ3/2)*(2*strip+1)) - SlopB*(WidthMax3/2);
-						ProjStrip= (-Length3/2 -5) - SlopB*(-WidthMax3/2 + (StepX3/2)*(2*strip+1));  // 1st strip proj at x=0
-						
-					}
-				}
-				
-				// find intersection of the 2 hit strips:
-				X_intersect= (OffsetB-OffsetA)/(SlopA-SlopB);
-				//X_intersect= X_track_det[j];  
-				Y_intersect= Y_track_det;  
-				Z_intersect= SlopA*X_intersect+OffsetA;  
-				//Z_intersect= Z_track_det[j];
-				
-				// then transform back in Lab frame:
-				
-				X_Hit=   X_intersect*M_INV_Out[Detector-19][0][0] 
-				+ Y_intersect*M_INV_Out[Detector-19][0][1]
-				+ Z_intersect*M_INV_Out[Detector-19][0][2]
-				+             M_INV_Out[Detector-19][0][3];
-				Y_Hit=   X_intersect*M_INV_Out[Detector-19][1][0] 
-				+ Y_intersect*M_INV_Out[Detector-19][1][1]
-				+ Z_intersect*M_INV_Out[Detector-19][1][2]
-				+             M_INV_Out[Detector-19][1][3];
-				Z_Hit=   X_intersect*M_INV_Out[Detector-19][2][0] 
-				+ Y_intersect*M_INV_Out[Detector-19][2][1]
-				+ Z_intersect*M_INV_Out[Detector-19][2][2]
-				+             M_INV_Out[Detector-19][2][3];
-				
-				//LOG(INFO) <<  X_Hit << " " <<   Y_Hit << " " <<  Z_Hit << " " <<FairLogger::endl;
-				
-			}
-            
-            Theta = GetThetaScatZero(X_Hit, Y_Hit, Z_Hit);
-            Phi = GetPhiScatZero(X_Hit, Y_Hit, Z_Hit);
-				
-			/*if ((X_track/X_Hit)<0 || (Y_track/Y_Hit)<0) {
-		
-				LOG(INFO) << "Detector" << " " << "Smeared Energy" << " " << "Raw Energy" <<FairLogger::endl;
-				LOG(INFO) << Detector << " " << Energy << " " << traHit[i]->GetEnergyLoss() <<FairLogger::endl;
-				LOG(INFO) << "X_in" << " " << "Y_in" << " " << "Z_in" <<FairLogger::endl;
-				LOG(INFO) << X_track << " " << Y_track << " " << Z_track <<FairLogger::endl;
-				LOG(INFO) << "X_out" << " " << "Y_out" << " " << "Z_out" <<FairLogger::endl;			
-				LOG(INFO) << X_Hit << " " << Y_Hit << " " << Z_Hit <<FairLogger::endl;	
-                LOG(INFO) << "Theta " << "Phi" <<FairLogger::endl;
-                LOG(INFO) << Theta << " " << Phi <<FairLogger::endl;
-				LOG(INFO) << " " <<FairLogger::endl;
-				
-			}*/
-
-			if(Energy >= fThreshold) AddHit(Energy, Detector, X_Hit, Y_Hit, Z_Hit, Px, Py, Pz, Theta, Phi);
-			//AddHit(Energy, Detector);
-
-				
-			}
-		}
+	for(Int_t i=0;i<traHitsPerEvent;i++){
+		R3BTraPoint* traHit = (R3BTraPoint*) fTrackerHitCA->At(i);
+		Energy = ExpResSmearing(traHit->GetEnergyLoss());
+		Detector = traHit->GetDetCopyID();
 		
+		if(Detector<1 || Detector>kNbDet){
+			LOG(WARNING) << "R3BTraHitFinder::Exec: unknown ladder " << Detector << ", point ignored" << FairLogger::endl;
+			continue;
+		}
 		
-		//LOG(INFO) << " " <<FairLogger::endl;
+		X_track = traHit->GetXIn();
+		Y_track = traHit->GetYIn();
+		Z_track = traHit->GetZIn();
+		
+		Px = traHit->GetPxOut();
+		Py = traHit->GetPyOut();
+		Pz = traHit->GetPzOut();
+		
+		if(Detector<=6) Layer=0;        // inner layer
+		else if(Detector<=18) Layer=1;  // middle layer
+		else Layer=2;                   // outer layer
+		
+		// apply Matrix transformation
+		const Double_t (*M)[4]= fTrans[Detector-1];
+		X_track_det=  X_track*M[0][0] 
+		            + Y_track*M[0][1]
+		            + Z_track*M[0][2]
+		            +         M[0][3];
+		Y_track_det=  X_track*M[1][0] 
+		            + Y_track*M[1][1]
+		            + Z_track*M[1][2]
+		            +         M[1][3];
+		Z_track_det=  X_track*M[2][0] 
+		            + Y_track*M[2][1]
+		            + Z_track*M[2][2]
+		            +         M[2][3];
+		
+		// find 1st strip hit: projection parallel to the 1st longitudinal side of the detector
+		// If no strip matches, the strip offset of the previous point is kept.
+		SlopA= fSlopA[Layer];
+		strip= FindStrip(Layer, Z_track_det - SlopA*X_track_det);
+		if(strip>=0) OffsetA= fProjStrip[Layer][strip];
+		
+		// find 2nd strip hit: projection parallel to the 2nd longitudinal side of the detector
+		SlopB= -SlopA;
+		strip= FindStrip(Layer, Z_track_det - SlopB*X_track_det);
+		if(strip>=0) OffsetB= fProjStrip[Layer][strip];
+		
+		// find intersection of the 2 hit strips:
+		X_intersect= (OffsetB-OffsetA)/(SlopA-SlopB);
+		Y_intersect= Y_track_det;  
+		Z_intersect= SlopA*X_intersect+OffsetA;  
+		
+		// then transform back in Lab frame:
+		const Double_t (*M_INV)[4]= fTransInv[Detector-1];
+		X_Hit=   X_intersect*M_INV[0][0] 
+		       + Y_intersect*M_INV[0][1]
+		       + Z_intersect*M_INV[0][2]
+		       +             M_INV[0][3];
+		Y_Hit=   X_intersect*M_INV[1][0] 
+		       + Y_intersect*M_INV[1][1]
+		       + Z_intersect*M_INV[1][2]
+		       +             M_INV[1][3];
+		Z_Hit=   X_intersect*M_INV[2][0] 
+		       + Y_intersect*M_INV[2][1]
+		       + Z_intersect*M_INV[2][2]
+		       +             M_INV[2][3];
+		
+		Theta = GetThetaScatZero(X_Hit, Y_Hit, Z_Hit);
+		Phi = GetPhiScatZero(X_Hit, Y_Hit, Z_Hit);
+		
+		if(Energy >= fThreshold) AddHit(Energy, Detector, X_Hit, Y_Hit, Z_Hit, Px, Py, Pz, Theta, Phi);
 		
 	}
 	
-	
+}
+
+
+
 // ---- Public method Reset   --------------------------------------------------
 void R3BTraHitFinder::Reset(){
 	// Clear the CA structure
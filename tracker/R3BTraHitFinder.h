@@ -13,6 +13,8 @@
 #include "FairTask.h"
 #include "R3BTrackerHit.h"
 
+#include <vector>
+
 class TClonesArray;
 
 class R3BTraHitFinder : public FairTask
@@ -81,6 +83,29 @@ private:
 	//R3BTrackerHit* AddHit(Double_t ene,Int_t det);
 	R3BTrackerHit* AddHit(Double_t ene,Int_t det,Double_t x,Double_t y,Double_t z,Double_t px, Double_t py, Double_t pz, Double_t th,Double_t phi);
 	
+	/** Private method InitGeometry
+	 **
+	 ** Fills the ladder transformations and the strip projections used in Exec
+	 **
+	 **/
+	void InitGeometry();
+	
+	/** Private method FindStrip
+	 **
+	 ** First strip of the layer whose middle line projection at x=0 is below Proj + StepZ/2, -1 if none
+	 **
+	 **/
+	Int_t FindStrip(Int_t layer, Double_t Proj) const;
+	
+	static const Int_t kNbDet = 30;  // 6 inner, 12 middle and 12 outer ladders
+	
+	Double_t fTrans[kNbDet][3][4];        //! lab -> ladder transformation (rows x, y, z)
+	Double_t fTransInv[kNbDet][3][4];     //! ladder -> lab transformation (rows x, y, z)
+	Double_t fSlopA[3];                   //! slope of the 1st longitudinal side, per layer
+	Double_t fHalfStepZ[3];               //! half strip step along z, per layer
+	Double_t fStepProj[3];                //! mean projection step between two strips, per layer
+	std::vector<Double_t> fProjStrip[3];  //! projection at x=0 of the middle line of each strip, per layer
+	
 	
 	ClassDef(R3BTraHitFinder,1);
 	